@@ -25,16 +25,25 @@ i32 main() {
     se_scene_2d_add_object(scene_2d, button_yes);
     se_scene_2d_add_object(scene_2d, button_no);
 
-    se_scene_2d_render(scene_2d, render_handle, window);
-   
     key_combo exit_keys = {0};
     key_combo_add(&exit_keys, GLFW_KEY_ESCAPE);
 
+    // a static screen, frames only run for input and reloads
+    se_window_set_render_on_demand(window, true);
+
     while (!se_window_should_close(window)) {
-        se_window_poll_events();
+        se_window_wait_events(window);
         se_window_check_exit_keys(window, &exit_keys);
+        if (se_render_handle_reload_changed_assets(render_handle)) {
+            se_window_request_redraw(window);
+        }
+        se_render_handle_process_loads(render_handle);
+        if (!se_window_should_render(window)) {
+            continue;
+        }
         se_window_update(window);
-        se_render_handle_reload_changed_shaders(render_handle);
+        // only redraws what changed
+        se_scene_2d_render(scene_2d, render_handle, window);
         se_render_clear();
         se_scene_2d_render_to_screen(scene_2d, render_handle, window);
         se_window_render_screen(window);
@@ -0,0 +1,33 @@
+#version 330 core
+
+layout(location = 0) in vec3 a_Position;
+layout(location = 1) in vec3 a_Normal;
+layout(location = 2) in vec2 a_UV;
+layout(location = 3) in uint a_draw_id;
+
+// Per draw model matrices (4 texels per matrix), indexed by draw id
+uniform samplerBuffer u_transforms;
+uniform mat4 u_view_projection;
+
+out vec2 v_uv;
+out vec3 v_normal;
+out vec3 v_frag_pos;
+
+mat4 fetch_transform(int draw_id) {
+    int base = draw_id * 4;
+    return mat4(
+        texelFetch(u_transforms, base + 0),
+        texelFetch(u_transforms, base + 1),
+        texelFetch(u_transforms, base + 2),
+        texelFetch(u_transforms, base + 3));
+}
+
+void main() {
+    mat4 model = fetch_transform(int(a_draw_id));
+    vec4 world_position = model * vec4(a_Position, 1.0);
+    gl_Position = u_view_projection * world_position;
+
+    v_frag_pos = world_position.xyz;
+    v_normal   = mat3(transpose(inverse(model))) * a_Normal;
+    v_uv       = a_UV;
+}
@@ -11,6 +11,10 @@
 
 typedef struct {
     se_vec3 amps;
+    f32 trigger_threshold;
+    void (*on_trigger)(void* user_data);
+    void* trigger_user_data;
+    b8 triggered; // over the threshold, fires again once it drops below
     
     // internal
     b8 running;
@@ -98,6 +102,13 @@ static int se_audio_input_callback(const void* input_buffer, void* output_buffer
     if (high_percent > 100.0f) high_percent = 100.0f;
     
     data->amps = (se_vec3){low_vol, mid_vol, high_vol};
+    if (data->on_trigger) {
+        const b8 over = low_vol >= data->trigger_threshold || mid_vol >= data->trigger_threshold || high_vol >= data->trigger_threshold;
+        if (over && !data->triggered) {
+            data->on_trigger(data->trigger_user_data);
+        }
+        data->triggered = over;
+    }
     return paContinue;
 }
 
@@ -201,3 +212,11 @@ se_vec3 se_audio_input_get_amplitudes(){
     return se_audio_input_data.amps;
 }
 
+void se_audio_input_set_trigger(const f32 threshold, void (*on_trigger)(void* user_data), void* user_data) {
+    se_audio_input_data.on_trigger = NULL;
+    se_audio_input_data.trigger_threshold = threshold;
+    se_audio_input_data.trigger_user_data = user_data;
+    se_audio_input_data.triggered = false;
+    se_audio_input_data.on_trigger = on_trigger;
+}
+
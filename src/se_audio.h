@@ -8,5 +8,7 @@
 void se_audio_input_init();
 void se_audio_input_cleanup();
 se_vec3 se_audio_input_get_amplitudes();
+// Called from the audio thread when a band rises over threshold, eg. to request a redraw of a window rendering on demand
+void se_audio_input_set_trigger(const f32 threshold, void (*on_trigger)(void* user_data), void* user_data);
 
 #endif // SE_AUDIO_H
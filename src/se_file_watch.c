@@ -0,0 +1,302 @@
+// Syphax-Engine - Ougi Washi
+
+#include "se_file_watch.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#define SE_FILE_WATCH_INOTIFY
+#endif
+
+static void se_file_watch_stat(se_watched_file* file, struct timespec* out_mtime, i64* out_size) {
+    struct stat st;
+    memset(out_mtime, 0, sizeof(*out_mtime));
+    *out_size = -1;
+    if (stat(file->path, &st) == 0) {
+#ifdef __APPLE__
+        *out_mtime = st.st_mtimespec;
+#else
+        *out_mtime = st.st_mtim;
+#endif
+        *out_size = st.st_size;
+    }
+}
+
+static void se_file_watch_mark_changed(se_file_watch* watch, se_watched_file* file) {
+    if (!file->changed) {
+        file->changed = true;
+        watch->change_count++;
+    }
+}
+
+// Sleeps until an event, the timeout (-1 for none) or se_file_watch_destroy. Called with the mutex held, returns the number of ready fds
+static i32 se_file_watch_wait(se_file_watch* watch, const i32 timeout_ms) {
+#ifdef SE_FILE_WATCH_INOTIFY
+    struct epoll_event events[2];
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_mutex_unlock(&watch->mutex);
+    i32 ready = epoll_wait(watch->epoll_fd, events, 2, timeout_ms);
+    // interrupted by a signal, waits again for what is left of the timeout
+    while (ready < 0 && errno == EINTR) {
+        i32 remaining_ms = timeout_ms;
+        if (timeout_ms >= 0) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            const i64 elapsed_ms = (i64)(now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+            remaining_ms = elapsed_ms < timeout_ms ? (i32)(timeout_ms - elapsed_ms) : 0;
+        }
+        ready = epoll_wait(watch->epoll_fd, events, 2, remaining_ms);
+    }
+    pthread_mutex_lock(&watch->mutex);
+    return ready > 0 ? ready : 0;
+#else
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+    pthread_cond_timedwait(&watch->wake, &watch->mutex, &deadline);
+    return 0;
+#endif
+}
+
+// Polling fallback, a change of modification time or size counts
+static void se_file_watch_check_mtimes(se_file_watch* watch) {
+    for (u32 i = 0; i < watch->file_count; i++) {
+        se_watched_file* file = &watch->files[i];
+        struct timespec mtime;
+        i64 size;
+        se_file_watch_stat(file, &mtime, &size);
+        if (mtime.tv_sec != file->mtime.tv_sec || mtime.tv_nsec != file->mtime.tv_nsec || size != file->size) {
+            file->mtime = mtime;
+            file->size = size;
+            se_file_watch_mark_changed(watch, file);
+        }
+    }
+}
+
+#ifdef SE_FILE_WATCH_INOTIFY
+// Drains the inotify fd, returns true if a registered file was written
+static b8 se_file_watch_read_events(se_file_watch* watch) {
+    b8 seen = false;
+    c8 buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t length = 0;
+    while ((length = read(watch->inotify_fd, buffer, sizeof(buffer))) > 0) {
+        for (c8* ptr = buffer; ptr < buffer + length;) {
+            const struct inotify_event* event = (const struct inotify_event*)ptr;
+            ptr += sizeof(struct inotify_event) + event->len;
+            if (event->len == 0) {
+                continue;
+            }
+            for (u32 i = 0; i < watch->file_count; i++) {
+                se_watched_file* file = &watch->files[i];
+                if (watch->dirs[file->dir].wd == event->wd && strcmp(file->path + file->name_offset, event->name) == 0) {
+                    file->pending = true;
+                    seen = true;
+                }
+            }
+        }
+    }
+    return seen;
+}
+#endif
+
+static void se_file_watch_publish(se_file_watch* watch) {
+    for (u32 i = 0; i < watch->file_count; i++) {
+        se_watched_file* file = &watch->files[i];
+        if (file->pending) {
+            file->pending = false;
+            se_file_watch_mark_changed(watch, file);
+        }
+    }
+}
+
+static void* se_file_watch_main(void* data) {
+    se_file_watch* watch = data;
+    b8 pending = false;
+    pthread_mutex_lock(&watch->mutex);
+    while (!watch->stop) {
+        // events of a burst are held until it has been quiet for SE_FILE_WATCH_SETTLE_MS
+        const i32 timeout = watch->inotify_fd < 0 ? SE_FILE_WATCH_POLL_MS : pending ? SE_FILE_WATCH_SETTLE_MS : -1;
+        const i32 ready = se_file_watch_wait(watch, timeout);
+        const u32 changes = watch->change_count;
+        (void)ready; // always 0 without inotify
+        if (watch->stop) {
+            break;
+        }
+        if (watch->inotify_fd < 0) {
+            se_file_watch_check_mtimes(watch);
+        }
+#ifdef SE_FILE_WATCH_INOTIFY
+        else if (ready > 0) {
+            pending |= se_file_watch_read_events(watch);
+        }
+#endif
+        else if (pending) {
+            se_file_watch_publish(watch);
+            pending = false;
+        }
+        if (watch->change_count > changes && watch->on_change) {
+            void (*on_change)(void*) = watch->on_change;
+            void* user_data = watch->user_data;
+            pthread_mutex_unlock(&watch->mutex);
+            on_change(user_data);
+            pthread_mutex_lock(&watch->mutex);
+        }
+    }
+    pthread_mutex_unlock(&watch->mutex);
+    return NULL;
+}
+
+se_file_watch* se_file_watch_create() {
+    se_file_watch* watch = malloc(sizeof(se_file_watch));
+    memset(watch, 0, sizeof(se_file_watch));
+    watch->inotify_fd = -1;
+    watch->epoll_fd = -1;
+    watch->wake_fd = -1;
+    pthread_mutex_init(&watch->mutex, NULL);
+    pthread_cond_init(&watch->wake, NULL);
+
+#ifdef SE_FILE_WATCH_INOTIFY
+    watch->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    watch->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (watch->epoll_fd < 0 || watch->wake_fd < 0) {
+        fprintf(stderr, "se_file_watch_create :: failed to create the epoll or wake fd: %s\n", strerror(errno));
+        se_file_watch_destroy(watch);
+        return NULL;
+    }
+    struct epoll_event event = { .events = EPOLLIN, .data.fd = watch->wake_fd };
+    epoll_ctl(watch->epoll_fd, EPOLL_CTL_ADD, watch->wake_fd, &event);
+    watch->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->inotify_fd >= 0) {
+        event.data.fd = watch->inotify_fd;
+        epoll_ctl(watch->epoll_fd, EPOLL_CTL_ADD, watch->inotify_fd, &event);
+    }
+#endif
+    if (watch->inotify_fd < 0) {
+        printf("File watch - inotify unavailable, polling every %d ms\n", SE_FILE_WATCH_POLL_MS);
+    }
+
+    if (pthread_create(&watch->thread, NULL, se_file_watch_main, watch) != 0) {
+        fprintf(stderr, "se_file_watch_create :: failed to start the watch thread\n");
+        watch->thread = 0;
+        se_file_watch_destroy(watch);
+        return NULL;
+    }
+    return watch;
+}
+
+void se_file_watch_destroy(se_file_watch* watch) {
+    pthread_mutex_lock(&watch->mutex);
+    watch->stop = true;
+    pthread_cond_signal(&watch->wake);
+    pthread_mutex_unlock(&watch->mutex);
+#ifdef SE_FILE_WATCH_INOTIFY
+    if (watch->wake_fd >= 0) {
+        const u64 one = 1;
+        if (write(watch->wake_fd, &one, sizeof(one)) != sizeof(one)) {
+            fprintf(stderr, "se_file_watch_destroy :: failed to wake the watch thread\n");
+        }
+    }
+#endif
+    if (watch->thread) {
+        pthread_join(watch->thread, NULL);
+    }
+    if (watch->inotify_fd >= 0) {
+        close(watch->inotify_fd); // drops every watch descriptor
+    }
+    if (watch->epoll_fd >= 0) {
+        close(watch->epoll_fd);
+    }
+    if (watch->wake_fd >= 0) {
+        close(watch->wake_fd);
+    }
+    pthread_cond_destroy(&watch->wake);
+    pthread_mutex_destroy(&watch->mutex);
+    free(watch);
+}
+
+// Watches the parent directory rather than the file, editors often save by writing a new file and renaming it over
+b8 se_file_watch_add(se_file_watch* watch, const c8* path) {
+    pthread_mutex_lock(&watch->mutex);
+    for (u32 i = 0; i < watch->file_count; i++) {
+        if (strcmp(watch->files[i].path, path) == 0) {
+            pthread_mutex_unlock(&watch->mutex);
+            return true;
+        }
+    }
+    if (watch->file_count == SE_FILE_WATCH_MAX_FILES) {
+        fprintf(stderr, "se_file_watch_add :: too many files, max is %d\n", SE_FILE_WATCH_MAX_FILES);
+        pthread_mutex_unlock(&watch->mutex);
+        return false;
+    }
+
+    se_watched_file* file = &watch->files[watch->file_count];
+    memset(file, 0, sizeof(se_watched_file));
+    strncpy(file->path, path, MAX_PATH_LENGTH - 1);
+    const c8* name = strrchr(file->path, '/');
+    file->name_offset = name ? (u32)(name - file->path) + 1 : 0;
+
+#ifdef SE_FILE_WATCH_INOTIFY
+    if (watch->inotify_fd >= 0) {
+        c8 dir_path[MAX_PATH_LENGTH] = ".";
+        if (file->name_offset > 0) {
+            memcpy(dir_path, file->path, file->name_offset - 1);
+            dir_path[file->name_offset - 1] = '\0';
+        }
+        u32 dir = 0;
+        while (dir < watch->dir_count && strcmp(watch->dirs[dir].path, dir_path) != 0) {
+            dir++;
+        }
+        if (dir == watch->dir_count) {
+            const i32 wd = dir < SE_FILE_WATCH_MAX_DIRS ? inotify_add_watch(watch->inotify_fd, dir_path, IN_CLOSE_WRITE | IN_MOVED_TO) : -1;
+            if (wd < 0) {
+                fprintf(stderr, "se_file_watch_add :: could not watch %s\n", dir_path);
+                pthread_mutex_unlock(&watch->mutex);
+                return false;
+            }
+            strncpy(watch->dirs[dir].path, dir_path, MAX_PATH_LENGTH - 1);
+            watch->dirs[dir].wd = wd;
+            watch->dir_count++;
+        }
+        file->dir = dir;
+    }
+#endif
+    if (watch->inotify_fd < 0) {
+        se_file_watch_stat(file, &file->mtime, &file->size);
+    }
+    watch->file_count++;
+    pthread_mutex_unlock(&watch->mutex);
+    return true;
+}
+
+void se_file_watch_set_callback(se_file_watch* watch, void (*on_change)(void* user_data), void* user_data) {
+    pthread_mutex_lock(&watch->mutex);
+    watch->on_change = on_change;
+    watch->user_data = user_data;
+    pthread_mutex_unlock(&watch->mutex);
+}
+
+u32 se_file_watch_poll(se_file_watch* watch, c8 (*out_paths)[MAX_PATH_LENGTH], const u32 max_paths) {
+    pthread_mutex_lock(&watch->mutex);
+    u32 count = 0;
+    for (u32 i = 0; i < watch->file_count && watch->change_count > 0 && count < max_paths; i++) {
+        se_watched_file* file = &watch->files[i];
+        if (file->changed) {
+            memcpy(out_paths[count++], file->path, MAX_PATH_LENGTH);
+            file->changed = false;
+            watch->change_count--;
+        }
+    }
+    pthread_mutex_unlock(&watch->mutex);
+    return count;
+}
@@ -0,0 +1,57 @@
+// Syphax-Engine - Ougi Washi
+
+// File watch service. A background thread waits on inotify (through epoll) for writes to the registered files,
+// coalesces bursts of events and queues the changed paths, so the thread polling them never touches the file system.
+// Falls back to comparing modification times every SE_FILE_WATCH_POLL_MS when inotify is unavailable.
+
+#ifndef SE_FILE_WATCH_H
+#define SE_FILE_WATCH_H
+
+#include "se_types.h"
+#include <pthread.h>
+#include <time.h>
+
+#define SE_FILE_WATCH_MAX_FILES 512
+#define SE_FILE_WATCH_MAX_DIRS 64
+#define SE_FILE_WATCH_SETTLE_MS 50 // quiet time before a burst of events is handed over, editors write in several steps
+#define SE_FILE_WATCH_POLL_MS 500
+
+typedef struct {
+    c8 path[MAX_PATH_LENGTH];
+    u32 name_offset; // file name inside path
+    u32 dir;
+    struct timespec mtime; // polling only
+    i64 size;
+    b8 pending; // seen, waiting for the burst to settle
+    b8 changed; // queued for se_file_watch_poll
+} se_watched_file;
+
+typedef struct {
+    c8 path[MAX_PATH_LENGTH];
+    i32 wd;
+} se_watched_dir;
+
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t wake; // polling without epoll
+    i32 inotify_fd; // -1 when polling
+    i32 epoll_fd;
+    i32 wake_fd;
+    se_watched_file files[SE_FILE_WATCH_MAX_FILES];
+    u32 file_count;
+    se_watched_dir dirs[SE_FILE_WATCH_MAX_DIRS];
+    u32 dir_count;
+    u32 change_count;
+    b8 stop;
+    void (*on_change)(void* user_data); // watch thread, after changes are queued
+    void* user_data;
+} se_file_watch;
+
+extern se_file_watch* se_file_watch_create();
+extern void se_file_watch_destroy(se_file_watch* watch);
+extern b8 se_file_watch_add(se_file_watch* watch, const c8* path); // registering the same path again is a no-op
+extern void se_file_watch_set_callback(se_file_watch* watch, void (*on_change)(void* user_data), void* user_data); // wakes a thread that would otherwise wait for its next poll
+extern u32 se_file_watch_poll(se_file_watch* watch, c8 (*out_paths)[MAX_PATH_LENGTH], const u32 max_paths); // takes up to max_paths changed paths, each once per burst
+
+#endif // SE_FILE_WATCH_H
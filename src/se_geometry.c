@@ -0,0 +1,549 @@
+// Syphax-Engine - Ougi Washi
+
+#include "se_geometry.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef struct {
+    u32 triangle;
+    u32 code;
+} se_triangle_key;
+
+static u32 se_morton_spread(u32 v) {
+    v &= 0x3ff;
+    v = (v | (v << 16)) & 0x030000FF;
+    v = (v | (v << 8))  & 0x0300F00F;
+    v = (v | (v << 4))  & 0x030C30C3;
+    v = (v | (v << 2))  & 0x09249249;
+    return v;
+}
+
+static i32 se_triangle_key_compare(const void* a, const void* b) {
+    const se_triangle_key* key_a = a;
+    const se_triangle_key* key_b = b;
+    return (key_a->code > key_b->code) - (key_a->code < key_b->code);
+}
+
+static void se_geometry_cluster_bounds(se_mesh_cluster* cluster, const se_vertex* vertices, const u32* indices) {
+    const u32* cluster_indices = &indices[cluster->first_index];
+
+    se_vec3 bounds_min = vertices[cluster_indices[0]].position;
+    se_vec3 bounds_max = bounds_min;
+    for (u32 i = 1; i < cluster->index_count; i++) {
+        const se_vec3* p = &vertices[cluster_indices[i]].position;
+        bounds_min = (se_vec3){ min(bounds_min.x, p->x), min(bounds_min.y, p->y), min(bounds_min.z, p->z) };
+        bounds_max = (se_vec3){ max(bounds_max.x, p->x), max(bounds_max.y, p->y), max(bounds_max.z, p->z) };
+    }
+    cluster->center = vec3_scale(vec3_add(bounds_min, bounds_max), 0.5f);
+    cluster->radius = 0.0f;
+    for (u32 i = 0; i < cluster->index_count; i++) {
+        cluster->radius = max(cluster->radius, vec3_length(vec3_sub(vertices[cluster_indices[i]].position, cluster->center)));
+    }
+
+    // normal cone (counter clockwise front faces)
+    se_vec3 axis = {0};
+    for (u32 i = 0; i + 2 < cluster->index_count; i += 3) {
+        const se_vec3 a = vertices[cluster_indices[i + 0]].position;
+        const se_vec3 b = vertices[cluster_indices[i + 1]].position;
+        const se_vec3 c = vertices[cluster_indices[i + 2]].position;
+        const se_vec3 n = vec3_cross(vec3_sub(b, a), vec3_sub(c, a));
+        const f32 len = vec3_length(n);
+        if (len > 0.0f) {
+            axis = vec3_add(axis, vec3_scale(n, 1.0f / len));
+        }
+    }
+    const f32 axis_length = vec3_length(axis);
+    f32 min_dot = 1.0f;
+    if (axis_length > 0.0f) {
+        axis = vec3_scale(axis, 1.0f / axis_length);
+        for (u32 i = 0; i + 2 < cluster->index_count; i += 3) {
+            const se_vec3 a = vertices[cluster_indices[i + 0]].position;
+            const se_vec3 b = vertices[cluster_indices[i + 1]].position;
+            const se_vec3 c = vertices[cluster_indices[i + 2]].position;
+            const se_vec3 n = vec3_cross(vec3_sub(b, a), vec3_sub(c, a));
+            const f32 len = vec3_length(n);
+            if (len > 0.0f) {
+                min_dot = min(min_dot, vec3_dot(axis, n) / len);
+            }
+        }
+    }
+
+    // cone is widened by 90 degrees on each side and inverted, so cutoff = sin(spread).
+    // A spread close to (or over) 90 degrees can never be fully back facing.
+    if (axis_length <= 0.0f || min_dot <= 0.1f) {
+        cluster->cone_axis = (se_vec3){0};
+        cluster->cone_cutoff = 1.0f;
+    } else {
+        cluster->cone_axis = axis;
+        cluster->cone_cutoff = sqrtf(1.0f - min_dot * min_dot);
+    }
+}
+
+u32 se_geometry_build_clusters(const se_vertex* vertices, const u32 vertex_count, u32* indices, const u32 index_count, se_mesh_cluster** out_clusters) {
+    *out_clusters = NULL;
+    const u32 triangle_count = index_count / 3;
+    if (triangle_count == 0 || vertex_count == 0) {
+        return 0;
+    }
+
+    // order triangles along a morton curve of their centroids so that greedy packing gives compact clusters
+    se_vec3 bounds_min = vertices[0].position;
+    se_vec3 bounds_max = bounds_min;
+    for (u32 i = 1; i < vertex_count; i++) {
+        const se_vec3* p = &vertices[i].position;
+        bounds_min = (se_vec3){ min(bounds_min.x, p->x), min(bounds_min.y, p->y), min(bounds_min.z, p->z) };
+        bounds_max = (se_vec3){ max(bounds_max.x, p->x), max(bounds_max.y, p->y), max(bounds_max.z, p->z) };
+    }
+    const se_vec3 extent = vec3_sub(bounds_max, bounds_min);
+    const f32 scale = 1023.0f / max(max(extent.x, extent.y), max(extent.z, 1e-6f));
+
+    se_triangle_key* keys = malloc(triangle_count * sizeof(se_triangle_key));
+    for (u32 t = 0; t < triangle_count; t++) {
+        const se_vec3 a = vertices[indices[t * 3 + 0]].position;
+        const se_vec3 b = vertices[indices[t * 3 + 1]].position;
+        const se_vec3 c = vertices[indices[t * 3 + 2]].position;
+        const se_vec3 centroid = vec3_sub(vec3_scale(vec3_add(vec3_add(a, b), c), 1.0f / 3.0f), bounds_min);
+        keys[t].triangle = t;
+        keys[t].code = se_morton_spread((u32)(centroid.x * scale)) |
+                       (se_morton_spread((u32)(centroid.y * scale)) << 1) |
+                       (se_morton_spread((u32)(centroid.z * scale)) << 2);
+    }
+    qsort(keys, triangle_count, sizeof(se_triangle_key), se_triangle_key_compare);
+
+    u32* sorted_indices = malloc(triangle_count * 3 * sizeof(u32));
+    for (u32 t = 0; t < triangle_count; t++) {
+        memcpy(&sorted_indices[t * 3], &indices[keys[t].triangle * 3], 3 * sizeof(u32));
+    }
+    free(keys);
+
+    // greedy packing, vertex_stamp marks the vertices already counted in the current cluster
+    u32* vertex_stamp = malloc(vertex_count * sizeof(u32));
+    memset(vertex_stamp, 0xff, vertex_count * sizeof(u32));
+
+    u32 cluster_capacity = triangle_count / (SE_CLUSTER_MAX_TRIANGLES / 2) + 1;
+    se_mesh_cluster* clusters = malloc(cluster_capacity * sizeof(se_mesh_cluster));
+    u32 cluster_count = 0;
+    u32 cluster_first_triangle = 0;
+    u32 cluster_triangles = 0;
+    u32 cluster_vertices = 0;
+
+    for (u32 t = 0; t < triangle_count; t++) {
+        const u32* tri = &sorted_indices[t * 3];
+        u32 new_vertices = 0;
+        for (u32 k = 0; k < 3; k++) {
+            const b8 duplicate = (k > 0 && tri[k] == tri[0]) || (k > 1 && tri[k] == tri[1]);
+            if (vertex_stamp[tri[k]] != cluster_count && !duplicate) {
+                new_vertices++;
+            }
+        }
+
+        if (cluster_triangles > 0 && (cluster_triangles + 1 > SE_CLUSTER_MAX_TRIANGLES || cluster_vertices + new_vertices > SE_CLUSTER_MAX_VERTICES)) {
+            if (cluster_count == cluster_capacity) {
+                cluster_capacity *= 2;
+                clusters = realloc(clusters, cluster_capacity * sizeof(se_mesh_cluster));
+            }
+            clusters[cluster_count].first_index = cluster_first_triangle * 3;
+            clusters[cluster_count].index_count = cluster_triangles * 3;
+            cluster_count++;
+            cluster_first_triangle = t;
+            cluster_triangles = 0;
+            cluster_vertices = 0;
+            // every vertex of the triangle is new for the next cluster
+            new_vertices = 1 + (tri[1] != tri[0]) + (tri[2] != tri[0] && tri[2] != tri[1]);
+        }
+
+        for (u32 k = 0; k < 3; k++) {
+            vertex_stamp[tri[k]] = cluster_count;
+        }
+        cluster_vertices += new_vertices;
+        cluster_triangles++;
+    }
+    if (cluster_count == cluster_capacity) {
+        cluster_capacity++;
+        clusters = realloc(clusters, cluster_capacity * sizeof(se_mesh_cluster));
+    }
+    clusters[cluster_count].first_index = cluster_first_triangle * 3;
+    clusters[cluster_count].index_count = cluster_triangles * 3;
+    cluster_count++;
+    free(vertex_stamp);
+
+    memcpy(indices, sorted_indices, triangle_count * 3 * sizeof(u32));
+    free(sorted_indices);
+
+    for (u32 i = 0; i < cluster_count; i++) {
+        se_geometry_cluster_bounds(&clusters[i], vertices, indices);
+    }
+
+    *out_clusters = clusters;
+    return cluster_count;
+}
+
+// Simplification
+
+typedef struct {
+    f64 a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+    f64 weight;
+} se_quadric;
+
+static void se_quadric_add_plane(se_quadric* q, const f64 a, const f64 b, const f64 c, const f64 d, const f64 weight) {
+    q->a2 += a * a * weight; q->ab += a * b * weight; q->ac += a * c * weight; q->ad += a * d * weight;
+    q->b2 += b * b * weight; q->bc += b * c * weight; q->bd += b * d * weight;
+    q->c2 += c * c * weight; q->cd += c * d * weight;
+    q->d2 += d * d * weight;
+    q->weight += weight;
+}
+
+static void se_quadric_add(se_quadric* q, const se_quadric* other) {
+    q->a2 += other->a2; q->ab += other->ab; q->ac += other->ac; q->ad += other->ad;
+    q->b2 += other->b2; q->bc += other->bc; q->bd += other->bd;
+    q->c2 += other->c2; q->cd += other->cd;
+    q->d2 += other->d2;
+    q->weight += other->weight;
+}
+
+static f64 se_quadric_error(const se_quadric* q, const se_vec3* p) {
+    const f64 x = p->x, y = p->y, z = p->z;
+    const f64 error = q->a2 * x * x + 2 * q->ab * x * y + 2 * q->ac * x * z + 2 * q->ad * x
+                    + q->b2 * y * y + 2 * q->bc * y * z + 2 * q->bd * y
+                    + q->c2 * z * z + 2 * q->cd * z
+                    + q->d2;
+    if (error <= 0 || q->weight <= 0) {
+        return 0;
+    }
+    // weighted mean of squared plane distances, so errors stay in squared object space units
+    return error / q->weight;
+}
+
+typedef struct {
+    u32 from;
+    u32 to;
+    f64 error;
+} se_collapse;
+
+static i32 se_collapse_compare(const void* a, const void* b) {
+    const se_collapse* collapse_a = a;
+    const se_collapse* collapse_b = b;
+    return (collapse_a->error > collapse_b->error) - (collapse_a->error < collapse_b->error);
+}
+
+typedef struct {
+    u32 a;
+    u32 b;
+    u32 count;
+} se_edge_entry;
+
+// open addressing set of undirected edges with the number of triangles using them
+typedef struct {
+    se_edge_entry* entries;
+    u32 capacity;
+} se_edge_map;
+
+static se_edge_entry* se_edge_map_get(se_edge_map* map, u32 a, u32 b, const b8 insert) {
+    if (a > b) {
+        const u32 tmp = a; a = b; b = tmp;
+    }
+    u32 slot = ((a * 73856093u) ^ (b * 19349663u)) & (map->capacity - 1);
+    while (map->entries[slot].count != 0) {
+        if (map->entries[slot].a == a && map->entries[slot].b == b) {
+            return &map->entries[slot];
+        }
+        slot = (slot + 1) & (map->capacity - 1);
+    }
+    if (!insert) {
+        return NULL;
+    }
+    map->entries[slot] = (se_edge_entry){ a, b, 0 };
+    return &map->entries[slot];
+}
+
+// maps every vertex to the first vertex with the same position, so attribute seams collapse together
+static u32* se_geometry_weld_positions(const se_vertex* vertices, const u32 vertex_count) {
+    u32* remap = malloc(vertex_count * sizeof(u32));
+    u32 capacity = 1;
+    while (capacity < vertex_count * 2) {
+        capacity <<= 1;
+    }
+    u32* table = malloc(capacity * sizeof(u32));
+    memset(table, 0xff, capacity * sizeof(u32));
+    for (u32 i = 0; i < vertex_count; i++) {
+        u32 bits[3];
+        memcpy(bits, &vertices[i].position, sizeof(bits));
+        u32 slot = ((bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u)) & (capacity - 1);
+        while (table[slot] != UINT32_MAX && memcmp(&vertices[table[slot]].position, &vertices[i].position, sizeof(se_vec3)) != 0) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (table[slot] == UINT32_MAX) {
+            table[slot] = i;
+        }
+        remap[i] = table[slot];
+    }
+    free(table);
+    return remap;
+}
+
+static b8 se_geometry_collapse_flips(const se_vertex* vertices, const u32* indices, const u32* triangles, const u32 triangle_count, const u32 from, const u32 to) {
+    const se_vec3 target = vertices[to].position;
+    for (u32 i = 0; i < triangle_count; i++) {
+        const u32* tri = &indices[triangles[i] * 3];
+        if (tri[0] == to || tri[1] == to || tri[2] == to) {
+            continue; // removed by the collapse
+        }
+        se_vec3 p[3];
+        se_vec3 moved[3];
+        for (u32 k = 0; k < 3; k++) {
+            p[k] = vertices[tri[k]].position;
+            moved[k] = tri[k] == from ? target : p[k];
+        }
+        const se_vec3 n0 = vec3_cross(vec3_sub(p[1], p[0]), vec3_sub(p[2], p[0]));
+        const se_vec3 n1 = vec3_cross(vec3_sub(moved[1], moved[0]), vec3_sub(moved[2], moved[0]));
+        if (vec3_dot(n0, n1) <= 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+u32 se_geometry_simplify(const se_vertex* vertices, const u32 vertex_count, const u32* indices, const u32 index_count,
+                         const u32 target_index_count, const f32 target_error, u32* out_indices, f32* out_error) {
+    *out_error = 0.0f;
+    const u32* remap = se_geometry_weld_positions(vertices, vertex_count);
+
+    // work on welded indices, original corners are restored at the end
+    u32* work = malloc(index_count * sizeof(u32));
+    u32* corners = malloc(index_count * sizeof(u32));
+    u32 work_count = index_count - index_count % 3;
+    for (u32 i = 0; i < work_count; i++) {
+        work[i] = remap[indices[i]];
+        corners[i] = indices[i];
+    }
+
+    se_quadric* quadrics = calloc(vertex_count, sizeof(se_quadric));
+    u32* collapse_target = malloc(vertex_count * sizeof(u32));
+    u8* vertex_flags = malloc(vertex_count);     // 1 = border, 2 = locked for the current pass
+    u32* adjacency_offsets = malloc((vertex_count + 1) * sizeof(u32));
+    u32* adjacency = malloc(work_count * sizeof(u32));
+    se_collapse* collapses = malloc(work_count * sizeof(se_collapse));
+    se_edge_map edges = {0};
+    edges.capacity = 1;
+    while (edges.capacity < work_count * 2) {
+        edges.capacity <<= 1;
+    }
+    edges.entries = malloc(edges.capacity * sizeof(se_edge_entry));
+
+    // face quadrics, weighted by area
+    for (u32 t = 0; t < work_count; t += 3) {
+        const se_vec3 a = vertices[work[t + 0]].position;
+        const se_vec3 b = vertices[work[t + 1]].position;
+        const se_vec3 c = vertices[work[t + 2]].position;
+        const se_vec3 n = vec3_cross(vec3_sub(b, a), vec3_sub(c, a));
+        const f32 area = vec3_length(n);
+        if (area <= 0.0f) {
+            continue;
+        }
+        const se_vec3 normal = vec3_scale(n, 1.0f / area);
+        const f64 d = -vec3_dot(normal, a);
+        for (u32 k = 0; k < 3; k++) {
+            se_quadric_add_plane(&quadrics[work[t + k]], normal.x, normal.y, normal.z, d, area * 0.5);
+        }
+    }
+
+    f64 max_error = (f64)target_error * (f64)target_error;
+    f64 reached_error = 0;
+    b8 border_quadrics_added = false;
+
+    while (work_count > target_index_count) {
+        // edge usage, border edges have a single triangle
+        memset(edges.entries, 0, edges.capacity * sizeof(se_edge_entry));
+        for (u32 t = 0; t < work_count; t += 3) {
+            for (u32 k = 0; k < 3; k++) {
+                se_edge_map_get(&edges, work[t + k], work[t + (k + 1) % 3], true)->count++;
+            }
+        }
+        memset(vertex_flags, 0, vertex_count);
+        for (u32 t = 0; t < work_count; t += 3) {
+            for (u32 k = 0; k < 3; k++) {
+                const u32 a = work[t + k];
+                const u32 b = work[t + (k + 1) % 3];
+                if (se_edge_map_get(&edges, a, b, false)->count != 1) {
+                    continue;
+                }
+                vertex_flags[a] |= 1;
+                vertex_flags[b] |= 1;
+                if (!border_quadrics_added) {
+                    // plane through the border edge, perpendicular to the face, keeps the silhouette of open meshes
+                    const se_vec3 pa = vertices[a].position;
+                    const se_vec3 pb = vertices[b].position;
+                    const se_vec3 pc = vertices[work[t + (k + 2) % 3]].position;
+                    const se_vec3 face = vec3_cross(vec3_sub(pb, pa), vec3_sub(pc, pa));
+                    const se_vec3 edge = vec3_sub(pb, pa);
+                    se_vec3 n = vec3_cross(edge, face);
+                    const f32 len = vec3_length(n);
+                    if (len > 0.0f) {
+                        n = vec3_scale(n, 1.0f / len);
+                        const f64 weight = vec3_length(edge) * vec3_length(edge) * 10.0;
+                        const f64 d = -vec3_dot(n, pa);
+                        se_quadric_add_plane(&quadrics[a], n.x, n.y, n.z, d, weight);
+                        se_quadric_add_plane(&quadrics[b], n.x, n.y, n.z, d, weight);
+                    }
+                }
+            }
+        }
+        border_quadrics_added = true;
+
+        // vertex to triangle adjacency
+        memset(adjacency_offsets, 0, (vertex_count + 1) * sizeof(u32));
+        for (u32 i = 0; i < work_count; i++) {
+            adjacency_offsets[work[i] + 1]++;
+        }
+        for (u32 v = 0; v < vertex_count; v++) {
+            adjacency_offsets[v + 1] += adjacency_offsets[v];
+        }
+        for (u32 i = 0; i < work_count; i++) {
+            adjacency[adjacency_offsets[work[i]]++] = i / 3;
+        }
+        for (u32 v = vertex_count; v > 0; v--) {
+            adjacency_offsets[v] = adjacency_offsets[v - 1];
+        }
+        adjacency_offsets[0] = 0;
+
+        // candidate collapses, cheaper direction of every edge
+        u32 collapse_count = 0;
+        for (u32 i = 0; i < edges.capacity; i++) {
+            const se_edge_entry* edge = &edges.entries[i];
+            if (edge->count == 0) {
+                continue;
+            }
+            const b8 border_edge = edge->count == 1;
+            se_quadric q = quadrics[edge->a];
+            se_quadric_add(&q, &quadrics[edge->b]);
+            // border vertices may only slide along the border
+            const b8 a_can_move = !(vertex_flags[edge->a] & 1) || border_edge;
+            const b8 b_can_move = !(vertex_flags[edge->b] & 1) || border_edge;
+            const f64 error_a_to_b = a_can_move ? se_quadric_error(&q, &vertices[edge->b].position) : INFINITY;
+            const f64 error_b_to_a = b_can_move ? se_quadric_error(&q, &vertices[edge->a].position) : INFINITY;
+            if (error_a_to_b == INFINITY && error_b_to_a == INFINITY) {
+                continue;
+            }
+            collapses[collapse_count++] = error_a_to_b <= error_b_to_a ?
+                (se_collapse){ edge->a, edge->b, error_a_to_b } : (se_collapse){ edge->b, edge->a, error_b_to_a };
+        }
+        if (collapse_count == 0) {
+            break;
+        }
+        qsort(collapses, collapse_count, sizeof(se_collapse), se_collapse_compare);
+
+        // apply as many independent collapses as needed this pass
+        for (u32 v = 0; v < vertex_count; v++) {
+            collapse_target[v] = v;
+        }
+        const u32 triangles_to_remove = (work_count - target_index_count) / 3;
+        u32 removed_triangles = 0;
+        u32 applied = 0;
+        for (u32 i = 0; i < collapse_count && removed_triangles < triangles_to_remove; i++) {
+            const se_collapse* collapse = &collapses[i];
+            if (collapse->error > max_error) {
+                break;
+            }
+            if ((vertex_flags[collapse->from] & 2) || (vertex_flags[collapse->to] & 2)) {
+                continue;
+            }
+            const u32* from_triangles = &adjacency[adjacency_offsets[collapse->from]];
+            const u32 from_triangle_count = adjacency_offsets[collapse->from + 1] - adjacency_offsets[collapse->from];
+            if (se_geometry_collapse_flips(vertices, work, from_triangles, from_triangle_count, collapse->from, collapse->to)) {
+                continue;
+            }
+
+            // lock the one ring so that flip checks of later collapses in this pass stay valid
+            for (u32 t = 0; t < from_triangle_count; t++) {
+                const u32* tri = &work[from_triangles[t] * 3];
+                vertex_flags[tri[0]] |= 2;
+                vertex_flags[tri[1]] |= 2;
+                vertex_flags[tri[2]] |= 2;
+                if (tri[0] == collapse->to || tri[1] == collapse->to || tri[2] == collapse->to) {
+                    removed_triangles++;
+                }
+            }
+            collapse_target[collapse->from] = collapse->to;
+            se_quadric_add(&quadrics[collapse->to], &quadrics[collapse->from]);
+            reached_error = max(reached_error, collapse->error);
+            applied++;
+        }
+        if (applied == 0) {
+            break;
+        }
+
+        // rewrite triangles and drop the degenerate ones, moved corners take the attributes of the welded target
+        u32 write = 0;
+        for (u32 t = 0; t < work_count; t += 3) {
+            const u32 a = collapse_target[work[t + 0]];
+            const u32 b = collapse_target[work[t + 1]];
+            const u32 c = collapse_target[work[t + 2]];
+            if (a == b || b == c || a == c) {
+                continue;
+            }
+            for (u32 k = 0; k < 3; k++) {
+                const u32 target = collapse_target[work[t + k]];
+                corners[write] = target == work[t + k] ? corners[t + k] : target;
+                work[write++] = target;
+            }
+        }
+        work_count = write;
+    }
+
+    // corners that were never moved keep their original vertex (and attributes)
+    memcpy(out_indices, corners, work_count * sizeof(u32));
+    const u32 out_count = work_count;
+
+    free(edges.entries);
+    free(collapses);
+    free(adjacency);
+    free(adjacency_offsets);
+    free(vertex_flags);
+    free(collapse_target);
+    free(quadrics);
+    free(work);
+    free(corners);
+    free((void*)remap);
+
+    *out_error = (f32)sqrt(reached_error);
+    return out_count;
+}
+
+u32 se_geometry_build_lods(const se_vertex* vertices, const u32 vertex_count, u32** indices, u32* index_count, const f32 radius, se_mesh_lod* out_lods) {
+    out_lods[0] = (se_mesh_lod){ 0, *index_count, 0.0f };
+    u32 lod_count = 1;
+    if (*index_count / 3 < SE_LOD_MIN_TRIANGLES) {
+        return lod_count;
+    }
+
+    f32 error_limit = radius * SE_LOD_BASE_ERROR;
+    while (lod_count < SE_MAX_MESH_LODS) {
+        const se_mesh_lod* previous = &out_lods[lod_count - 1];
+        const u32 target = (previous->index_count / 6) * 3;
+        if (target / 3 < SE_CLUSTER_MAX_TRIANGLES) {
+            break;
+        }
+
+        u32* lod_indices = malloc(previous->index_count * sizeof(u32));
+        f32 error = 0.0f;
+        const u32 lod_index_count = se_geometry_simplify(vertices, vertex_count, &(*indices)[previous->first_index], previous->index_count,
+                                                         target, error_limit, lod_indices, &error);
+        // not worth a level when the error bound stops the simplification early
+        if (lod_index_count == 0 || lod_index_count > previous->index_count * 3 / 4) {
+            free(lod_indices);
+            break;
+        }
+
+        *indices = realloc(*indices, (*index_count + lod_index_count) * sizeof(u32));
+        memcpy(&(*indices)[*index_count], lod_indices, lod_index_count * sizeof(u32));
+        free(lod_indices);
+
+        // each level is simplified from the previous one, so errors add up
+        out_lods[lod_count] = (se_mesh_lod){ *index_count, lod_index_count, previous->error + error };
+        *index_count += lod_index_count;
+        lod_count++;
+        error_limit *= 2.0f;
+    }
+    return lod_count;
+}
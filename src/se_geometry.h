@@ -0,0 +1,31 @@
+// Syphax-Engine - Ougi Washi
+
+// CPU side mesh processing used by the import pipeline, no GL calls in here
+
+#ifndef SE_GEOMETRY_H
+#define SE_GEOMETRY_H
+
+#include "se_render.h"
+
+#define SE_CLUSTER_MAX_VERTICES 64
+#define SE_CLUSTER_MAX_TRIANGLES 124
+#define SE_CLUSTER_MIN_MESH_TRIANGLES 4096 // smaller meshes are drawn as a whole
+
+#define SE_LOD_MIN_TRIANGLES 512       // smaller meshes only have the full detail level
+#define SE_LOD_BASE_ERROR 0.005f       // allowed error of the first simplified level, relative to the mesh radius
+
+// Splits a mesh into clusters of at most SE_CLUSTER_MAX_VERTICES / SE_CLUSTER_MAX_TRIANGLES.
+// Indices are reordered in place so each cluster is a contiguous range, clusters are allocated with malloc.
+extern u32 se_geometry_build_clusters(const se_vertex* vertices, const u32 vertex_count, u32* indices, const u32 index_count, se_mesh_cluster** out_clusters);
+
+// Quadric error metric edge collapse. Vertices are never moved or created, so the result indexes the same vertex buffer.
+// Stops at target_index_count or when the next collapse would exceed target_error (object space distance).
+// Returns the new index count written to out_indices and the reached error in out_error.
+extern u32 se_geometry_simplify(const se_vertex* vertices, const u32 vertex_count, const u32* indices, const u32 index_count,
+                                const u32 target_index_count, const f32 target_error, u32* out_indices, f32* out_error);
+
+// Appends simplified levels after the full detail indices, *indices is reallocated.
+// Level i is built from level i-1 with half the triangles and twice the allowed error.
+extern u32 se_geometry_build_lods(const se_vertex* vertices, const u32 vertex_count, u32** indices, u32* index_count, const f32 radius, se_mesh_lod* out_lods);
+
+#endif // SE_GEOMETRY_H
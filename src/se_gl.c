@@ -3,6 +3,7 @@
 #include "se_gl.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 PFNGLDELETEBUFFERS glDeleteBuffers = NULL;
 PFNGLGENBUFFERS glGenBuffers = NULL;
@@ -56,15 +57,56 @@ PFNGLRENDERBUFFERSTORAGE glRenderbufferStorage = NULL;
 PFNGLCHECKFRAMEBUFFERSTATUS glCheckFramebufferStatus = NULL;
 PFNGLGENERATEMIPMAP glGenerateMipmap = NULL;
 PFNGLBLITFRAMEBUFFER glBlitFramebuffer = NULL;
+PFNGLDRAWBUFFERS glDrawBuffers = NULL;
+PFNGLBUFFERSUBDATA glBufferSubData = NULL;
+PFNGLGETBUFFERSUBDATA glGetBufferSubData = NULL;
+PFNGLCOPYBUFFERSUBDATA glCopyBufferSubData = NULL;
+PFNGLDRAWELEMENTSBASEVERTEX glDrawElementsBaseVertex = NULL;
+PFNGLTEXBUFFER glTexBuffer = NULL;
+PFNGLVERTEXATTRIBIPOINTER glVertexAttribIPointer = NULL;
+PFNGLVERTEXATTRIBI1UI glVertexAttribI1ui = NULL;
+PFNGLMAPBUFFERRANGE glMapBufferRange = NULL;
+PFNGLFENCESYNC glFenceSync = NULL;
+PFNGLCLIENTWAITSYNC glClientWaitSync = NULL;
+PFNGLDELETESYNC glDeleteSync = NULL;
+PFNGLGENSAMPLERS glGenSamplers = NULL;
+PFNGLDELETESAMPLERS glDeleteSamplers = NULL;
+PFNGLBINDSAMPLER glBindSampler = NULL;
+PFNGLSAMPLERPARAMETERI glSamplerParameteri = NULL;
+PFNGLSAMPLERPARAMETERF glSamplerParameterf = NULL;
+PFNGLBINDBUFFERRANGE glBindBufferRange = NULL;
+PFNGLGETUNIFORMBLOCKINDEX glGetUniformBlockIndex = NULL;
+PFNGLUNIFORMBLOCKBINDING glUniformBlockBinding = NULL;
+PFNGLMULTIDRAWELEMENTSINDIRECT glMultiDrawElementsIndirect = NULL;
+PFNGLBUFFERSTORAGE glBufferStorage = NULL;
+PFNGLNAMEDBUFFERSUBDATA glNamedBufferSubData = NULL;
+PFNGLCOPYNAMEDBUFFERSUBDATA glCopyNamedBufferSubData = NULL;
+PFNGLTEXTURESUBIMAGE2D glTextureSubImage2D = NULL;
+PFNGLCOMPRESSEDTEXTURESUBIMAGE2D glCompressedTextureSubImage2D = NULL;
+PFNGLGENERATETEXTUREMIPMAP glGenerateTextureMipmap = NULL;
+PFNGLMAXSHADERCOMPILERTHREADSKHR glMaxShaderCompilerThreadsKHR = NULL;
+PFNGLGETPROGRAMBINARY glGetProgramBinary = NULL;
+PFNGLPROGRAMBINARY glProgramBinary = NULL;
+PFNGLPROGRAMPARAMETERI glProgramParameteri = NULL;
+
+se_gl_capabilities se_gl_caps = { 0 };
 
 #define INIT_OPENGL_FUNCTION(func, func_type) \
     func = (func_type)glfwGetProcAddress(#func); \
     if (!func) { \
         fprintf(stderr, "Failed to load OpenGL function: %s\n", #func); \
-        exit(1); \
+        loaded = false; \
     }
 
-void se_init_opengl() {
+#define INIT_OPENGL_FUNCTION_OPTIONAL(func, func_type) \
+    func = (func_type)glfwGetProcAddress(#func);
+
+static GLboolean se_gl_has_version(const GLint major, const GLint minor) {
+    return se_gl_caps.major_version > major || (se_gl_caps.major_version == major && se_gl_caps.minor_version >= minor);
+}
+
+b8 se_init_opengl() {
+    b8 loaded = true;
     INIT_OPENGL_FUNCTION(glDeleteBuffers, PFNGLDELETEBUFFERS);
     INIT_OPENGL_FUNCTION(glGenBuffers, PFNGLGENBUFFERS);
     INIT_OPENGL_FUNCTION(glBindBuffer, PFNGLBINDBUFFER);
@@ -117,4 +159,92 @@ void se_init_opengl() {
     INIT_OPENGL_FUNCTION(glCheckFramebufferStatus, PFNGLCHECKFRAMEBUFFERSTATUS);
     INIT_OPENGL_FUNCTION(glGenerateMipmap, PFNGLGENERATEMIPMAP);
     INIT_OPENGL_FUNCTION(glBlitFramebuffer, PFNGLBLITFRAMEBUFFER);
+    INIT_OPENGL_FUNCTION(glDrawBuffers, PFNGLDRAWBUFFERS);
+    INIT_OPENGL_FUNCTION(glBufferSubData, PFNGLBUFFERSUBDATA);
+    INIT_OPENGL_FUNCTION(glGetBufferSubData, PFNGLGETBUFFERSUBDATA);
+    INIT_OPENGL_FUNCTION(glCopyBufferSubData, PFNGLCOPYBUFFERSUBDATA);
+    INIT_OPENGL_FUNCTION(glDrawElementsBaseVertex, PFNGLDRAWELEMENTSBASEVERTEX);
+    INIT_OPENGL_FUNCTION(glTexBuffer, PFNGLTEXBUFFER);
+    INIT_OPENGL_FUNCTION(glVertexAttribIPointer, PFNGLVERTEXATTRIBIPOINTER);
+    INIT_OPENGL_FUNCTION(glVertexAttribI1ui, PFNGLVERTEXATTRIBI1UI);
+    INIT_OPENGL_FUNCTION(glMapBufferRange, PFNGLMAPBUFFERRANGE);
+    INIT_OPENGL_FUNCTION(glFenceSync, PFNGLFENCESYNC);
+    INIT_OPENGL_FUNCTION(glClientWaitSync, PFNGLCLIENTWAITSYNC);
+    INIT_OPENGL_FUNCTION(glDeleteSync, PFNGLDELETESYNC);
+    INIT_OPENGL_FUNCTION(glGenSamplers, PFNGLGENSAMPLERS);
+    INIT_OPENGL_FUNCTION(glDeleteSamplers, PFNGLDELETESAMPLERS);
+    INIT_OPENGL_FUNCTION(glBindSampler, PFNGLBINDSAMPLER);
+    INIT_OPENGL_FUNCTION(glSamplerParameteri, PFNGLSAMPLERPARAMETERI);
+    INIT_OPENGL_FUNCTION(glSamplerParameterf, PFNGLSAMPLERPARAMETERF);
+    INIT_OPENGL_FUNCTION(glBindBufferRange, PFNGLBINDBUFFERRANGE);
+    INIT_OPENGL_FUNCTION(glGetUniformBlockIndex, PFNGLGETUNIFORMBLOCKINDEX);
+    INIT_OPENGL_FUNCTION(glUniformBlockBinding, PFNGLUNIFORMBLOCKBINDING);
+    if (!loaded) {
+        return false;
+    }
+
+    // capabilities, every optional path below falls back to the 3.3 core one when missing
+    memset(&se_gl_caps, 0, sizeof(se_gl_caps));
+    glGetIntegerv(GL_MAJOR_VERSION, &se_gl_caps.major_version);
+    glGetIntegerv(GL_MINOR_VERSION, &se_gl_caps.minor_version);
+
+    // multi draw indirect needs base instance too, since the draw id is fed through it
+    INIT_OPENGL_FUNCTION_OPTIONAL(glMultiDrawElementsIndirect, PFNGLMULTIDRAWELEMENTSINDIRECT);
+    se_gl_caps.multi_draw_indirect = glMultiDrawElementsIndirect != NULL &&
+        (se_gl_has_version(4, 3) ||
+        (glfwExtensionSupported("GL_ARB_multi_draw_indirect") && glfwExtensionSupported("GL_ARB_base_instance")));
+    se_gl_caps.texture_compression_s3tc = glfwExtensionSupported("GL_EXT_texture_compression_s3tc");
+    INIT_OPENGL_FUNCTION_OPTIONAL(glBufferStorage, PFNGLBUFFERSTORAGE);
+    se_gl_caps.buffer_storage = glBufferStorage != NULL && (se_gl_has_version(4, 4) || glfwExtensionSupported("GL_ARB_buffer_storage"));
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &se_gl_caps.uniform_buffer_alignment);
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &se_gl_caps.max_texture_buffer_size);
+    se_gl_caps.max_anisotropy = 1.0f;
+    if (glfwExtensionSupported("GL_EXT_texture_filter_anisotropic")) {
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &se_gl_caps.max_anisotropy);
+    }
+
+    INIT_OPENGL_FUNCTION_OPTIONAL(glNamedBufferSubData, PFNGLNAMEDBUFFERSUBDATA);
+    INIT_OPENGL_FUNCTION_OPTIONAL(glCopyNamedBufferSubData, PFNGLCOPYNAMEDBUFFERSUBDATA);
+    INIT_OPENGL_FUNCTION_OPTIONAL(glTextureSubImage2D, PFNGLTEXTURESUBIMAGE2D);
+    INIT_OPENGL_FUNCTION_OPTIONAL(glCompressedTextureSubImage2D, PFNGLCOMPRESSEDTEXTURESUBIMAGE2D);
+    INIT_OPENGL_FUNCTION_OPTIONAL(glGenerateTextureMipmap, PFNGLGENERATETEXTUREMIPMAP);
+    se_gl_caps.direct_state_access = glNamedBufferSubData != NULL && glCopyNamedBufferSubData != NULL && glTextureSubImage2D != NULL &&
+        glCompressedTextureSubImage2D != NULL && glGenerateTextureMipmap != NULL &&
+        (se_gl_has_version(4, 5) || glfwExtensionSupported("GL_ARB_direct_state_access"));
+
+    // the ARB variant shares the entry point under a different suffix
+    INIT_OPENGL_FUNCTION_OPTIONAL(glMaxShaderCompilerThreadsKHR, PFNGLMAXSHADERCOMPILERTHREADSKHR);
+    if (glMaxShaderCompilerThreadsKHR == NULL) {
+        glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHR)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+    }
+    se_gl_caps.parallel_shader_compile = glMaxShaderCompilerThreadsKHR != NULL &&
+        (glfwExtensionSupported("GL_KHR_parallel_shader_compile") || glfwExtensionSupported("GL_ARB_parallel_shader_compile"));
+    if (se_gl_caps.parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF); // let the driver pick
+    }
+
+    INIT_OPENGL_FUNCTION_OPTIONAL(glGetProgramBinary, PFNGLGETPROGRAMBINARY);
+    INIT_OPENGL_FUNCTION_OPTIONAL(glProgramBinary, PFNGLPROGRAMBINARY);
+    INIT_OPENGL_FUNCTION_OPTIONAL(glProgramParameteri, PFNGLPROGRAMPARAMETERI);
+    if (glGetProgramBinary != NULL && glProgramBinary != NULL && glProgramParameteri != NULL &&
+        (se_gl_has_version(4, 1) || glfwExtensionSupported("GL_ARB_get_program_binary"))) {
+        // some drivers expose the entry points with no formats, which makes the cache useless
+        GLint binary_formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binary_formats);
+        se_gl_caps.program_binary = binary_formats > 0;
+    }
+
+    se_gl_print_capabilities();
+    return true;
+}
+
+void se_gl_print_capabilities() {
+    printf("OpenGL %d.%d (%s)\n", se_gl_caps.major_version, se_gl_caps.minor_version, (const char*)glGetString(GL_RENDERER));
+    printf("  draw submission: %s\n", se_gl_caps.multi_draw_indirect ? "multi draw indirect" : "draw loop");
+    printf("  dynamic data: %s\n", se_gl_caps.buffer_storage ? "persistent mapped ring" : "orphaned ring");
+    printf("  uploads: %s\n", se_gl_caps.direct_state_access ? "direct state access" : "bind to edit");
+    printf("  parallel shader compile: %s\n", se_gl_caps.parallel_shader_compile ? "yes" : "no");
+    printf("  program binaries: %s\n", se_gl_caps.program_binary ? "yes" : "no");
+    printf("  texture compression: %s\n", se_gl_caps.texture_compression_s3tc ? "s3tc" : "none");
+    printf("  anisotropy: %.0fx\n", se_gl_caps.max_anisotropy);
 }
@@ -6,6 +6,7 @@
 #include <GL/gl.h>
 #include <GLFW/glfw3.h>
 #include <stddef.h>
+#include "se_types.h"
 
 typedef void (APIENTRY * PFNGLDELETEBUFFERS)(GLsizei n, const GLuint *buffers);
 typedef void (APIENTRY * PFNGLGENBUFFERS)(GLsizei n, GLuint *buffers);
@@ -66,6 +67,37 @@ typedef void (APIENTRY * PFNGLRENDERBUFFERSTORAGE)(GLenum target, GLenum interna
 typedef GLenum (APIENTRY * PFNGLCHECKFRAMEBUFFERSTATUS)(GLenum target);
 typedef void (APIENTRY * PFNGLGENERATEMIPMAP)(GLenum target);
 typedef void (APIENTRY * PFNGLBLITFRAMEBUFFER)(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter);
+typedef void (APIENTRY * PFNGLDRAWBUFFERS)(GLsizei n, const GLenum *bufs);
+typedef void (APIENTRY * PFNGLBUFFERSUBDATA)(GLenum target, GLintptr offset, GLsizeiptr size, const void *data);
+typedef void (APIENTRY * PFNGLGETBUFFERSUBDATA)(GLenum target, GLintptr offset, GLsizeiptr size, void *data);
+typedef void (APIENTRY * PFNGLCOPYBUFFERSUBDATA)(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
+typedef void (APIENTRY * PFNGLDRAWELEMENTSBASEVERTEX)(GLenum mode, GLsizei count, GLenum type, const void *indices, GLint basevertex);
+typedef void (APIENTRY * PFNGLTEXBUFFER)(GLenum target, GLenum internalformat, GLuint buffer);
+typedef void (APIENTRY * PFNGLVERTEXATTRIBIPOINTER)(GLuint index, GLint size, GLenum type, GLsizei stride, const void *pointer);
+typedef void (APIENTRY * PFNGLVERTEXATTRIBI1UI)(GLuint index, GLuint x);
+typedef void* (APIENTRY * PFNGLMAPBUFFERRANGE)(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+typedef GLsync (APIENTRY * PFNGLFENCESYNC)(GLenum condition, GLbitfield flags);
+typedef GLenum (APIENTRY * PFNGLCLIENTWAITSYNC)(GLsync sync, GLbitfield flags, GLuint64 timeout);
+typedef void (APIENTRY * PFNGLDELETESYNC)(GLsync sync);
+typedef void (APIENTRY * PFNGLGENSAMPLERS)(GLsizei count, GLuint *samplers);
+typedef void (APIENTRY * PFNGLDELETESAMPLERS)(GLsizei count, const GLuint *samplers);
+typedef void (APIENTRY * PFNGLBINDSAMPLER)(GLuint unit, GLuint sampler);
+typedef void (APIENTRY * PFNGLSAMPLERPARAMETERI)(GLuint sampler, GLenum pname, GLint param);
+typedef void (APIENTRY * PFNGLSAMPLERPARAMETERF)(GLuint sampler, GLenum pname, GLfloat param);
+typedef void (APIENTRY * PFNGLBINDBUFFERRANGE)(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+typedef GLuint (APIENTRY * PFNGLGETUNIFORMBLOCKINDEX)(GLuint program, const GLchar *uniformBlockName);
+typedef void (APIENTRY * PFNGLUNIFORMBLOCKBINDING)(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+typedef void (APIENTRY * PFNGLBUFFERSTORAGE)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+typedef void (APIENTRY * PFNGLMULTIDRAWELEMENTSINDIRECT)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRY * PFNGLNAMEDBUFFERSUBDATA)(GLuint buffer, GLintptr offset, GLsizeiptr size, const void *data);
+typedef void (APIENTRY * PFNGLCOPYNAMEDBUFFERSUBDATA)(GLuint readBuffer, GLuint writeBuffer, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
+typedef void (APIENTRY * PFNGLTEXTURESUBIMAGE2D)(GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels);
+typedef void (APIENTRY * PFNGLCOMPRESSEDTEXTURESUBIMAGE2D)(GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const void *data);
+typedef void (APIENTRY * PFNGLGENERATETEXTUREMIPMAP)(GLuint texture);
+typedef void (APIENTRY * PFNGLMAXSHADERCOMPILERTHREADSKHR)(GLuint count);
+typedef void (APIENTRY * PFNGLGETPROGRAMBINARY)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (APIENTRY * PFNGLPROGRAMBINARY)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void (APIENTRY * PFNGLPROGRAMPARAMETERI)(GLuint program, GLenum pname, GLint value);
 
 extern PFNGLDELETEBUFFERS glDeleteBuffers;
 extern PFNGLGENBUFFERS glGenBuffers;
@@ -119,7 +151,58 @@ extern PFNGLRENDERBUFFERSTORAGE glRenderbufferStorage;
 extern PFNGLCHECKFRAMEBUFFERSTATUS glCheckFramebufferStatus;
 extern PFNGLGENERATEMIPMAP glGenerateMipmap;
 extern PFNGLBLITFRAMEBUFFER glBlitFramebuffer;
+extern PFNGLDRAWBUFFERS glDrawBuffers;
+extern PFNGLBUFFERSUBDATA glBufferSubData;
+extern PFNGLGETBUFFERSUBDATA glGetBufferSubData;
+extern PFNGLCOPYBUFFERSUBDATA glCopyBufferSubData;
+extern PFNGLDRAWELEMENTSBASEVERTEX glDrawElementsBaseVertex;
+extern PFNGLTEXBUFFER glTexBuffer;
+extern PFNGLVERTEXATTRIBIPOINTER glVertexAttribIPointer;
+extern PFNGLVERTEXATTRIBI1UI glVertexAttribI1ui;
+extern PFNGLMAPBUFFERRANGE glMapBufferRange;
+extern PFNGLFENCESYNC glFenceSync;
+extern PFNGLCLIENTWAITSYNC glClientWaitSync;
+extern PFNGLDELETESYNC glDeleteSync;
+extern PFNGLGENSAMPLERS glGenSamplers;
+extern PFNGLDELETESAMPLERS glDeleteSamplers;
+extern PFNGLBINDSAMPLER glBindSampler;
+extern PFNGLSAMPLERPARAMETERI glSamplerParameteri;
+extern PFNGLSAMPLERPARAMETERF glSamplerParameterf;
+extern PFNGLBINDBUFFERRANGE glBindBufferRange;
+extern PFNGLGETUNIFORMBLOCKINDEX glGetUniformBlockIndex;
+extern PFNGLUNIFORMBLOCKBINDING glUniformBlockBinding;
 
-extern void se_init_opengl();
+// optional, NULL when the context does not expose them (check se_gl_caps)
+extern PFNGLMULTIDRAWELEMENTSINDIRECT glMultiDrawElementsIndirect;
+extern PFNGLBUFFERSTORAGE glBufferStorage;
+extern PFNGLNAMEDBUFFERSUBDATA glNamedBufferSubData;
+extern PFNGLCOPYNAMEDBUFFERSUBDATA glCopyNamedBufferSubData;
+extern PFNGLTEXTURESUBIMAGE2D glTextureSubImage2D;
+extern PFNGLCOMPRESSEDTEXTURESUBIMAGE2D glCompressedTextureSubImage2D;
+extern PFNGLGENERATETEXTUREMIPMAP glGenerateTextureMipmap;
+extern PFNGLMAXSHADERCOMPILERTHREADSKHR glMaxShaderCompilerThreadsKHR;
+extern PFNGLGETPROGRAMBINARY glGetProgramBinary;
+extern PFNGLPROGRAMBINARY glProgramBinary;
+extern PFNGLPROGRAMPARAMETERI glProgramParameteri;
+
+typedef struct {
+    GLint major_version;
+    GLint minor_version;
+    GLboolean multi_draw_indirect;
+    GLboolean texture_compression_s3tc;
+    GLfloat max_anisotropy; // 1 without EXT_texture_filter_anisotropic
+    GLboolean buffer_storage; // immutable storage, persistent mapping
+    GLint uniform_buffer_alignment;
+    GLint max_texture_buffer_size; // texels
+    GLboolean direct_state_access; // edit objects without binding them
+    GLboolean parallel_shader_compile; // compile and link without blocking, poll GL_COMPLETION_STATUS
+    GLboolean program_binary; // at least one binary format to save linked programs in
+} se_gl_capabilities;
+
+extern se_gl_capabilities se_gl_caps;
+
+// false when the context is missing part of the 3.3 core baseline
+extern b8 se_init_opengl();
+extern void se_gl_print_capabilities();
 
 #endif // SE_GL_H
@@ -0,0 +1,288 @@
+// Syphax-Engine - Ougi Washi
+
+#include "se_glsl.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <limits.h>
+
+typedef struct {
+    c8* data;
+    sz size;
+    sz capacity;
+} se_glsl_text;
+
+static void se_glsl_append(se_glsl_text* text, const c8* data, const sz size) {
+    if (text->size + size + 1 > text->capacity) {
+        text->capacity = text->capacity * 2 > text->size + size + 1 ? text->capacity * 2 : text->size + size + 1;
+        text->data = realloc(text->data, text->capacity);
+    }
+    memcpy(text->data + text->size, data, size);
+    text->size += size;
+    text->data[text->size] = '\0';
+}
+
+static void se_glsl_appendf(se_glsl_text* text, const c8* format, ...) {
+    c8 line[64];
+    va_list args;
+    va_start(args, format);
+    const i32 length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    se_glsl_append(text, line, length > 0 ? (sz)length : 0);
+}
+
+// Directives have to start on a line of their own
+static void se_glsl_end_line(se_glsl_text* text) {
+    if (text->size > 0 && text->data[text->size - 1] != '\n') {
+        se_glsl_append(text, "\n", 1);
+    }
+}
+
+static c8* se_glsl_read_file(const c8* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    c8* data = malloc(size + 1);
+    const sz read = fread(data, 1, size, file);
+    data[read] = '\0';
+    fclose(file);
+    return data;
+}
+
+// Returns the first character after "#<name>" on the line, NULL if the line is another directive or not one
+static const c8* se_glsl_directive(const c8* line, const c8* end, const c8* name) {
+    while (line < end && (*line == ' ' || *line == '\t')) line++;
+    if (line == end || *line != '#') {
+        return NULL;
+    }
+    line++;
+    while (line < end && (*line == ' ' || *line == '\t')) line++;
+    const sz length = strlen(name);
+    if ((sz)(end - line) < length || strncmp(line, name, length) != 0) {
+        return NULL;
+    }
+    line += length;
+    return line == end || *line == ' ' || *line == '\t' || *line == '\r' ? line : NULL;
+}
+
+static b8 se_glsl_is_pointwise_line(const c8* line, const c8* end) {
+    const c8* ptr = se_glsl_directive(line, end, "pragma");
+    if (ptr == NULL) {
+        return false;
+    }
+    while (ptr < end && (*ptr == ' ' || *ptr == '\t')) ptr++;
+    return (sz)(end - ptr) >= 12 && strncmp(ptr, "se_pointwise", 12) == 0;
+}
+
+// #include "name"
+static b8 se_glsl_parse_include(const c8* line, const c8* end, c8* out_name) {
+    const c8* ptr = se_glsl_directive(line, end, "include");
+    if (ptr == NULL) {
+        return false;
+    }
+    while (ptr < end && (*ptr == ' ' || *ptr == '\t')) ptr++;
+    if (ptr == end || *ptr != '"') {
+        return false;
+    }
+    const c8* name = ++ptr;
+    while (ptr < end && *ptr != '"') ptr++;
+    if (ptr == end || ptr == name || (sz)(ptr - name) >= MAX_PATH_LENGTH) {
+        return false;
+    }
+    memcpy(out_name, name, ptr - name);
+    out_name[ptr - name] = '\0';
+    return true;
+}
+
+static void se_glsl_append_defines(se_glsl_text* text, const c8* defines) {
+    const c8* ptr = defines;
+    while (*ptr) {
+        while (*ptr && isspace((u8)*ptr)) ptr++;
+        const c8* start = ptr;
+        while (*ptr && !isspace((u8)*ptr)) ptr++;
+        if (ptr == start) {
+            break;
+        }
+        const c8* equals = memchr(start, '=', ptr - start);
+        se_glsl_append(text, "#define ", 8);
+        if (equals) {
+            se_glsl_append(text, start, equals - start);
+            se_glsl_append(text, " ", 1);
+            se_glsl_append(text, equals + 1, ptr - equals - 1);
+        } else {
+            se_glsl_append(text, start, ptr - start);
+        }
+        se_glsl_append(text, "\n", 1);
+    }
+}
+
+#define SE_GLSL_POINTWISE_INPUTS \
+    "in vec2 tex_coord;\n" \
+    "out vec4 frag_color;\n" \
+    "uniform sampler2D u_texture;\n"
+
+#define SE_GLSL_POINTWISE_MAIN \
+    SE_GLSL_POINTWISE_INPUTS \
+    "void main() {\n" \
+    "    frag_color = se_pointwise(texture(u_texture, tex_coord), tex_coord);\n" \
+    "}\n"
+
+static b8 se_glsl_expand(se_glsl_text* text, const c8* path, const c8* defines, se_glsl_dependencies* dependencies, const u32 depth, const u32 source) {
+    c8* file = se_glsl_read_file(path);
+    if (file == NULL) {
+        fprintf(stderr, "se_glsl_preprocess :: could not read %s\n", path);
+        return false;
+    }
+    // defines go right after #version, or first when there is none
+    b8 defines_pending = depth == 0 && defines && defines[0] != '\0';
+    if (defines_pending && strstr(file, "#version") == NULL) {
+        se_glsl_append_defines(text, defines);
+        se_glsl_appendf(text, "#line 1\n");
+        defines_pending = false;
+    }
+
+    const c8* directory_end = strrchr(path, '/');
+    const sz directory_length = directory_end ? (sz)(directory_end - path) + 1 : 0;
+    b8 success = true;
+    b8 pointwise = false;
+    u32 line_number = 1;
+    const c8* line = file;
+    while (*line && success) {
+        const c8* end = strchr(line, '\n');
+        end = end ? end : line + strlen(line);
+        const c8* next = *end ? end + 1 : end;
+        c8 name[MAX_PATH_LENGTH];
+        if (se_glsl_directive(line, end, "version")) {
+            // only the stage source declares the version
+            if (depth == 0) {
+                se_glsl_append(text, line, next - line);
+                se_glsl_end_line(text);
+            } else {
+                se_glsl_append(text, "\n", 1);
+            }
+            if (defines_pending) {
+                se_glsl_append_defines(text, defines);
+                se_glsl_appendf(text, "#line %u\n", line_number + 1);
+                defines_pending = false;
+            }
+        } else if (se_glsl_parse_include(line, end, name)) {
+            c8 include_path[MAX_PATH_LENGTH] = {0};
+            if (name[0] == '/') {
+                memcpy(include_path, name, MAX_PATH_LENGTH);
+            } else {
+                snprintf(include_path, MAX_PATH_LENGTH, "%.*s%s", (i32)directory_length, path, name);
+            }
+            u32 index = 0;
+            while (index < dependencies->count && strcmp(dependencies->paths[index], include_path) != 0) {
+                index++;
+            }
+            if (index < dependencies->count) {
+                se_glsl_append(text, "\n", 1); // included once
+            } else if (depth + 1 >= SE_GLSL_MAX_INCLUDE_DEPTH || dependencies->count == SE_GLSL_MAX_DEPENDENCIES) {
+                fprintf(stderr, "se_glsl_preprocess :: too many includes in %s, max depth is %d and max files %d\n", path, SE_GLSL_MAX_INCLUDE_DEPTH, SE_GLSL_MAX_DEPENDENCIES);
+                success = false;
+            } else {
+                // source string numbers tell included files apart in compiler errors, 0 is the stage source
+                memcpy(dependencies->paths[dependencies->count++], include_path, MAX_PATH_LENGTH);
+                se_glsl_appendf(text, "#line 1 %u\n", dependencies->count);
+                success = se_glsl_expand(text, include_path, NULL, dependencies, depth + 1, dependencies->count);
+                se_glsl_end_line(text);
+                se_glsl_appendf(text, "#line %u %u\n", line_number + 1, source);
+            }
+        } else {
+            pointwise |= depth == 0 && se_glsl_is_pointwise_line(line, end);
+            se_glsl_append(text, line, next - line);
+        }
+        line = next;
+        line_number++;
+    }
+    free(file);
+    if (success && pointwise) {
+        se_glsl_end_line(text);
+        se_glsl_append(text, SE_GLSL_POINTWISE_MAIN, strlen(SE_GLSL_POINTWISE_MAIN));
+    }
+    return success;
+}
+
+c8* se_glsl_preprocess(const c8* path, const c8* defines, se_glsl_dependencies* dependencies) {
+    se_glsl_text text = {0};
+    se_glsl_append(&text, "", 0);
+    if (!se_glsl_expand(&text, path, defines, dependencies, 0, 0)) {
+        free(text.data);
+        return NULL;
+    }
+    return text.data;
+}
+
+b8 se_glsl_is_pointwise(const c8* path) {
+    c8* file = se_glsl_read_file(path);
+    if (file == NULL) {
+        return false;
+    }
+    b8 pointwise = false;
+    for (const c8* line = file; *line && !pointwise;) {
+        const c8* end = strchr(line, '\n');
+        end = end ? end : line + strlen(line);
+        pointwise = se_glsl_is_pointwise_line(line, end);
+        line = *end ? end + 1 : end;
+    }
+    free(file);
+    return pointwise;
+}
+
+// Each stage is included with se_pointwise renamed, the version of the first one is used for all
+c8* se_glsl_fuse_pointwise(const c8** paths, const u32 count) {
+    if (count == 0 || count > SE_GLSL_MAX_FUSED_STAGES) {
+        fprintf(stderr, "se_glsl_fuse_pointwise :: %u stages, max is %d\n", count, SE_GLSL_MAX_FUSED_STAGES);
+        return NULL;
+    }
+    c8* first = se_glsl_read_file(paths[0]);
+    if (first == NULL) {
+        fprintf(stderr, "se_glsl_fuse_pointwise :: could not read %s\n", paths[0]);
+        return NULL;
+    }
+    se_glsl_text text = {0};
+    se_glsl_append(&text, "", 0);
+    for (const c8* line = first; *line;) {
+        const c8* end = strchr(line, '\n');
+        end = end ? end : line + strlen(line);
+        if (se_glsl_directive(line, end, "version")) {
+            se_glsl_append(&text, line, end - line);
+            break;
+        }
+        line = *end ? end + 1 : end;
+    }
+    free(first);
+    if (text.size == 0) {
+        se_glsl_append(&text, "#version 330 core", 17);
+    }
+    se_glsl_append(&text, "\n", 1);
+
+    // absolute, the generated file lives in the cache
+    for (u32 i = 0; i < count; i++) {
+        c8 resolved[PATH_MAX];
+        if (realpath(paths[i], resolved) == NULL || strlen(resolved) >= MAX_PATH_LENGTH) {
+            fprintf(stderr, "se_glsl_fuse_pointwise :: could not resolve %s\n", paths[i]);
+            free(text.data);
+            return NULL;
+        }
+        se_glsl_appendf(&text, "#define se_pointwise se_pointwise_%u\n", i);
+        se_glsl_append(&text, "#include \"", 10);
+        se_glsl_append(&text, resolved, strlen(resolved));
+        se_glsl_append(&text, "\"\n#undef se_pointwise\n", 22);
+    }
+
+    se_glsl_append(&text, SE_GLSL_POINTWISE_INPUTS, strlen(SE_GLSL_POINTWISE_INPUTS));
+    const c8* main_begin = "void main() {\n    vec4 color = texture(u_texture, tex_coord);\n";
+    se_glsl_append(&text, main_begin, strlen(main_begin));
+    for (u32 i = 0; i < count; i++) {
+        se_glsl_appendf(&text, "    color = se_pointwise_%u(color, tex_coord);\n", i);
+    }
+    se_glsl_appendf(&text, "    frag_color = color;\n}\n");
+    return text.data;
+}
@@ -0,0 +1,32 @@
+// Syphax-Engine - Ougi Washi
+
+// GLSL preprocessing in front of the compiler. Expands #include "file" (relative to the including file, each file
+// once) and inserts a list of #defines after #version, so feature toggles become specialised programs.
+//
+// A fragment stage with "#pragma se_pointwise" is a per-pixel colour operation. It only defines its uniforms and
+// vec4 se_pointwise(vec4 color, vec2 uv), the preprocessor adds a main applying it to u_texture at tex_coord.
+// Consecutive pointwise stages can be fused into one program, their uniforms and helpers need distinct names.
+
+#ifndef SE_GLSL_H
+#define SE_GLSL_H
+
+#include "se_types.h"
+
+#define SE_GLSL_MAX_INCLUDE_DEPTH 8
+#define SE_GLSL_MAX_DEPENDENCIES 16
+#define SE_GLSL_MAX_FUSED_STAGES 8
+
+// Included files, reloads watch them along with the stage sources
+typedef struct {
+    c8 paths[SE_GLSL_MAX_DEPENDENCIES][MAX_PATH_LENGTH];
+    u32 count;
+} se_glsl_dependencies;
+
+// defines is a space separated list of NAME or NAME=VALUE, may be NULL. Included files are appended to dependencies.
+// Returns the expanded source to free, NULL if the file or one of its includes can't be read
+extern c8* se_glsl_preprocess(const c8* path, const c8* defines, se_glsl_dependencies* dependencies);
+extern b8 se_glsl_is_pointwise(const c8* path);
+// Source of one fragment stage including every pointwise stage in order, NULL if one can't be resolved
+extern c8* se_glsl_fuse_pointwise(const c8** paths, const u32 count);
+
+#endif // SE_GLSL_H
@@ -0,0 +1,195 @@
+// Syphax-Engine - Ougi Washi
+
+#include "se_image.h"
+#include "se_math.h"
+#include <stdlib.h>
+#include <string.h>
+
+u8* se_image_expand_channels(const u8* pixels, const i32 width, const i32 height, const i32 channels, i32* out_channels) {
+    const i32 new_channels = channels == 2 ? 4 : 3;
+    const sz pixel_count = (sz)width * height;
+    u8* out = malloc(pixel_count * new_channels);
+    for (sz i = 0; i < pixel_count; i++) {
+        const u8 gray = pixels[i * channels];
+        out[i * new_channels + 0] = gray;
+        out[i * new_channels + 1] = gray;
+        out[i * new_channels + 2] = gray;
+        if (new_channels == 4) {
+            out[i * new_channels + 3] = pixels[i * channels + 1];
+        }
+    }
+    *out_channels = new_channels;
+    return out;
+}
+
+u8* se_image_downsample(const u8* pixels, const i32 width, const i32 height, const i32 channels, i32* out_width, i32* out_height) {
+    const i32 new_width = width > 1 ? width / 2 : 1;
+    const i32 new_height = height > 1 ? height / 2 : 1;
+    u8* out = malloc((sz)new_width * new_height * channels);
+    for (i32 y = 0; y < new_height; y++) {
+        // odd sizes clamp, the last row/column is averaged with itself
+        const i32 y0 = min(y * 2, height - 1);
+        const i32 y1 = min(y * 2 + 1, height - 1);
+        for (i32 x = 0; x < new_width; x++) {
+            const i32 x0 = min(x * 2, width - 1);
+            const i32 x1 = min(x * 2 + 1, width - 1);
+            for (i32 c = 0; c < channels; c++) {
+                const u32 sum = pixels[((sz)y0 * width + x0) * channels + c] + pixels[((sz)y0 * width + x1) * channels + c] +
+                                pixels[((sz)y1 * width + x0) * channels + c] + pixels[((sz)y1 * width + x1) * channels + c];
+                out[((sz)y * new_width + x) * channels + c] = (u8)((sum + 2) / 4);
+            }
+        }
+    }
+    *out_width = new_width;
+    *out_height = new_height;
+    return out;
+}
+
+sz se_image_bc_size(const i32 width, const i32 height, const sz block_size) {
+    return (sz)((width + 3) / 4) * ((height + 3) / 4) * block_size;
+}
+
+// 4x4 block with edge pixels repeated for partial blocks
+static void se_image_fetch_block(const u8* pixels, const i32 width, const i32 height, const i32 channels, const i32 block_x, const i32 block_y, u8 block[16][4]) {
+    for (i32 y = 0; y < 4; y++) {
+        for (i32 x = 0; x < 4; x++) {
+            const i32 px = min(block_x * 4 + x, width - 1);
+            const i32 py = min(block_y * 4 + y, height - 1);
+            const u8* pixel = pixels + ((sz)py * width + px) * channels;
+            block[y * 4 + x][0] = pixel[0];
+            block[y * 4 + x][1] = pixel[1];
+            block[y * 4 + x][2] = pixel[2];
+            block[y * 4 + x][3] = channels == 4 ? pixel[3] : 255;
+        }
+    }
+}
+
+static u16 se_image_to_565(const i32 r, const i32 g, const i32 b) {
+    return (u16)(((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255));
+}
+
+static void se_image_from_565(const u16 color, i32 out[3]) {
+    const i32 r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+}
+
+// Bounding box endpoints, with the diagonal flipped to follow the color correlation, then nearest palette entry
+static void se_image_encode_color_block(u8 block[16][4], u8* out) {
+    i32 low[3] = { 255, 255, 255 }, high[3] = { 0, 0, 0 };
+    i32 mean[3] = { 0, 0, 0 };
+    for (i32 i = 0; i < 16; i++) {
+        for (i32 c = 0; c < 3; c++) {
+            low[c] = min(low[c], block[i][c]);
+            high[c] = max(high[c], block[i][c]);
+            mean[c] += block[i][c];
+        }
+    }
+    i32 covariance_rg = 0, covariance_rb = 0;
+    for (i32 i = 0; i < 16; i++) {
+        const i32 r = block[i][0] * 16 - mean[0];
+        covariance_rg += r * (block[i][1] * 16 - mean[1]) / 256;
+        covariance_rb += r * (block[i][2] * 16 - mean[2]) / 256;
+    }
+    i32 end0[3] = { high[0], high[1], high[2] };
+    i32 end1[3] = { low[0], low[1], low[2] };
+    if (covariance_rg < 0) { end0[1] = low[1]; end1[1] = high[1]; }
+    if (covariance_rb < 0) { end0[2] = low[2]; end1[2] = high[2]; }
+    // inset a bit, the extremes are rarely the best endpoints
+    for (i32 c = 0; c < 3; c++) {
+        const i32 inset = (end0[c] - end1[c]) / 16;
+        end0[c] -= inset;
+        end1[c] += inset;
+    }
+
+    u16 color0 = se_image_to_565(end0[0], end0[1], end0[2]);
+    u16 color1 = se_image_to_565(end1[0], end1[1], end1[2]);
+    if (color0 < color1) {
+        const u16 swap = color0;
+        color0 = color1;
+        color1 = swap;
+    }
+    u32 indices = 0;
+    if (color0 != color1) {
+        i32 palette[4][3];
+        se_image_from_565(color0, palette[0]);
+        se_image_from_565(color1, palette[1]);
+        for (i32 c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (i32 i = 0; i < 16; i++) {
+            i32 best = 0, best_distance = INT32_MAX;
+            for (i32 p = 0; p < 4; p++) {
+                const i32 dr = block[i][0] - palette[p][0], dg = block[i][1] - palette[p][1], db = block[i][2] - palette[p][2];
+                const i32 distance = dr * dr + dg * dg + db * db;
+                if (distance < best_distance) {
+                    best_distance = distance;
+                    best = p;
+                }
+            }
+            indices |= (u32)best << (i * 2);
+        }
+    }
+    out[0] = color0 & 0xff;
+    out[1] = color0 >> 8;
+    out[2] = color1 & 0xff;
+    out[3] = color1 >> 8;
+    memcpy(out + 4, &indices, 4); // little endian
+}
+
+static void se_image_encode_alpha_block(u8 block[16][4], u8* out) {
+    i32 alpha0 = 0, alpha1 = 255;
+    for (i32 i = 0; i < 16; i++) {
+        alpha0 = max(alpha0, block[i][3]);
+        alpha1 = min(alpha1, block[i][3]);
+    }
+    u64 indices = 0;
+    if (alpha0 != alpha1) {
+        // alpha0 > alpha1, 6 interpolated values
+        i32 palette[8] = { alpha0, alpha1 };
+        for (i32 p = 1; p < 7; p++) {
+            palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7;
+        }
+        for (i32 i = 0; i < 16; i++) {
+            i32 best = 0, best_distance = INT32_MAX;
+            for (i32 p = 0; p < 8; p++) {
+                const i32 distance = abs(block[i][3] - palette[p]);
+                if (distance < best_distance) {
+                    best_distance = distance;
+                    best = p;
+                }
+            }
+            indices |= (u64)best << (i * 3);
+        }
+    }
+    out[0] = (u8)alpha0;
+    out[1] = (u8)alpha1;
+    for (i32 i = 0; i < 6; i++) {
+        out[2 + i] = (u8)(indices >> (i * 8));
+    }
+}
+
+void se_image_encode_bc1(const u8* pixels, const i32 width, const i32 height, const i32 channels, u8* out) {
+    u8 block[16][4];
+    for (i32 by = 0; by < (height + 3) / 4; by++) {
+        for (i32 bx = 0; bx < (width + 3) / 4; bx++) {
+            se_image_fetch_block(pixels, width, height, channels, bx, by, block);
+            se_image_encode_color_block(block, out);
+            out += SE_IMAGE_BC1_BLOCK_SIZE;
+        }
+    }
+}
+
+void se_image_encode_bc3(const u8* pixels, const i32 width, const i32 height, u8* out) {
+    u8 block[16][4];
+    for (i32 by = 0; by < (height + 3) / 4; by++) {
+        for (i32 bx = 0; bx < (width + 3) / 4; bx++) {
+            se_image_fetch_block(pixels, width, height, 4, bx, by, block);
+            se_image_encode_alpha_block(block, out);
+            se_image_encode_color_block(block, out + 8);
+            out += SE_IMAGE_BC3_BLOCK_SIZE;
+        }
+    }
+}
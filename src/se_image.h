@@ -0,0 +1,19 @@
+// Syphax-Engine - Ougi Washi
+
+// CPU image processing used by the texture cooker (no GL calls). Pixels are 8 bit, 3 (RGB) or 4 (RGBA) channels.
+
+#ifndef SE_IMAGE_H
+#define SE_IMAGE_H
+
+#include "se_types.h"
+
+#define SE_IMAGE_BC1_BLOCK_SIZE 8
+#define SE_IMAGE_BC3_BLOCK_SIZE 16
+
+extern u8* se_image_expand_channels(const u8* pixels, const i32 width, const i32 height, const i32 channels, i32* out_channels); // 1/2 channels to RGB/RGBA
+extern u8* se_image_downsample(const u8* pixels, const i32 width, const i32 height, const i32 channels, i32* out_width, i32* out_height); // half size, box filter
+extern sz se_image_bc_size(const i32 width, const i32 height, const sz block_size);
+extern void se_image_encode_bc1(const u8* pixels, const i32 width, const i32 height, const i32 channels, u8* out);
+extern void se_image_encode_bc3(const u8* pixels, const i32 width, const i32 height, u8* out);
+
+#endif // SE_IMAGE_H
@@ -0,0 +1,237 @@
+// Syphax-Engine - Ougi Washi
+
+#include "se_json.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SE_JSON_BLOCK_SIZE 1024
+#define SE_JSON_MAX_DEPTH 256
+
+// nodes are allocated in blocks so pointers stay valid while parsing
+struct se_json_block {
+    se_json nodes[SE_JSON_BLOCK_SIZE];
+    u32 used;
+    se_json_block* next;
+};
+
+typedef struct {
+    const c8* text;
+    const c8* end;
+    se_json_document* document;
+    u32 depth;
+} se_json_parser;
+
+static se_json* se_json_alloc(se_json_parser* parser) {
+    se_json_block* block = parser->document->blocks;
+    if (block == NULL || block->used == SE_JSON_BLOCK_SIZE) {
+        block = malloc(sizeof(se_json_block));
+        if (block == NULL) {
+            return NULL;
+        }
+        block->used = 0;
+        block->next = parser->document->blocks;
+        parser->document->blocks = block;
+    }
+    se_json* node = &block->nodes[block->used++];
+    memset(node, 0, sizeof(se_json));
+    return node;
+}
+
+static void se_json_skip_whitespace(se_json_parser* parser) {
+    while (parser->text < parser->end && (*parser->text == ' ' || *parser->text == '\n' || *parser->text == '\r' || *parser->text == '\t')) {
+        parser->text++;
+    }
+}
+
+static b8 se_json_parse_string(se_json_parser* parser, const c8** out_data, u32* out_length) {
+    if (parser->text >= parser->end || *parser->text != '"') {
+        return false;
+    }
+    const c8* start = ++parser->text;
+    while (parser->text < parser->end && *parser->text != '"') {
+        if (*parser->text == '\\') {
+            parser->text++;
+        }
+        parser->text++;
+    }
+    if (parser->text >= parser->end) {
+        return false;
+    }
+    *out_data = start;
+    *out_length = (u32)(parser->text - start);
+    parser->text++;
+    return true;
+}
+
+static b8 se_json_match(se_json_parser* parser, const c8* word) {
+    const sz length = strlen(word);
+    if ((sz)(parser->end - parser->text) < length || strncmp(parser->text, word, length) != 0) {
+        return false;
+    }
+    parser->text += length;
+    return true;
+}
+
+static se_json* se_json_parse_value(se_json_parser* parser) {
+    se_json_skip_whitespace(parser);
+    if (parser->text >= parser->end || parser->depth > SE_JSON_MAX_DEPTH) {
+        return NULL;
+    }
+    se_json* node = se_json_alloc(parser);
+    if (node == NULL) {
+        return NULL;
+    }
+
+    const c8 c = *parser->text;
+    if (c == '{' || c == '[') {
+        const b8 is_object = c == '{';
+        const c8 close = is_object ? '}' : ']';
+        node->type = is_object ? SE_JSON_OBJECT : SE_JSON_ARRAY;
+        parser->text++;
+        parser->depth++;
+        se_json* last = NULL;
+        se_json_skip_whitespace(parser);
+        if (parser->text < parser->end && *parser->text == close) {
+            parser->text++;
+            parser->depth--;
+            return node;
+        }
+        while (true) {
+            const c8* key = NULL;
+            u32 key_length = 0;
+            if (is_object) {
+                se_json_skip_whitespace(parser);
+                if (!se_json_parse_string(parser, &key, &key_length)) {
+                    return NULL;
+                }
+                se_json_skip_whitespace(parser);
+                if (parser->text >= parser->end || *parser->text != ':') {
+                    return NULL;
+                }
+                parser->text++;
+            }
+            se_json* child = se_json_parse_value(parser);
+            if (child == NULL) {
+                return NULL;
+            }
+            child->key = key;
+            child->key_length = key_length;
+            if (last) {
+                last->next = child;
+            } else {
+                node->first_child = child;
+            }
+            last = child;
+            node->child_count++;
+
+            se_json_skip_whitespace(parser);
+            if (parser->text >= parser->end) {
+                return NULL;
+            }
+            if (*parser->text == ',') {
+                parser->text++;
+                continue;
+            }
+            if (*parser->text == close) {
+                parser->text++;
+                parser->depth--;
+                return node;
+            }
+            return NULL;
+        }
+    }
+    if (c == '"') {
+        node->type = SE_JSON_STRING;
+        return se_json_parse_string(parser, &node->value.string.data, &node->value.string.length) ? node : NULL;
+    }
+    if (se_json_match(parser, "true")) {
+        node->type = SE_JSON_BOOL;
+        node->value.boolean = true;
+        return node;
+    }
+    if (se_json_match(parser, "false")) {
+        node->type = SE_JSON_BOOL;
+        node->value.boolean = false;
+        return node;
+    }
+    if (se_json_match(parser, "null")) {
+        node->type = SE_JSON_NULL;
+        return node;
+    }
+
+    // number, strtod needs a terminated buffer
+    c8 number[64];
+    sz length = 0;
+    while (parser->text + length < parser->end && length < sizeof(number) - 1 && strchr("+-0123456789.eE", parser->text[length])) {
+        length++;
+    }
+    if (length == 0) {
+        return NULL;
+    }
+    memcpy(number, parser->text, length);
+    number[length] = '\0';
+    node->type = SE_JSON_NUMBER;
+    node->value.number = strtod(number, NULL);
+    parser->text += length;
+    return node;
+}
+
+b8 se_json_parse(se_json_document* document, const c8* text, const sz length) {
+    memset(document, 0, sizeof(se_json_document));
+    se_json_parser parser = { text, text + length, document, 0 };
+    document->root = se_json_parse_value(&parser);
+    if (document->root == NULL) {
+        fprintf(stderr, "se_json_parse :: invalid JSON near offset %zu\n", (sz)(parser.text - text));
+        se_json_free(document);
+        return false;
+    }
+    return true;
+}
+
+void se_json_free(se_json_document* document) {
+    se_json_block* block = document->blocks;
+    while (block) {
+        se_json_block* next = block->next;
+        free(block);
+        block = next;
+    }
+    document->blocks = NULL;
+    document->root = NULL;
+}
+
+se_json* se_json_get(const se_json* object, const c8* key) {
+    if (object == NULL || object->type != SE_JSON_OBJECT) {
+        return NULL;
+    }
+    const sz key_length = strlen(key);
+    for (se_json* child = object->first_child; child; child = child->next) {
+        if (child->key_length == key_length && strncmp(child->key, key, key_length) == 0) {
+            return child;
+        }
+    }
+    return NULL;
+}
+
+se_json* se_json_at(const se_json* array, const u32 index) {
+    if (array == NULL || array->type != SE_JSON_ARRAY || index >= array->child_count) {
+        return NULL;
+    }
+    se_json* child = array->first_child;
+    for (u32 i = 0; i < index; i++) {
+        child = child->next;
+    }
+    return child;
+}
+
+f64 se_json_get_number(const se_json* object, const c8* key, const f64 fallback) {
+    const se_json* value = se_json_get(object, key);
+    return value && value->type == SE_JSON_NUMBER ? value->value.number : fallback;
+}
+
+b8 se_json_equals(const se_json* string, const c8* text) {
+    if (string == NULL || string->type != SE_JSON_STRING) {
+        return false;
+    }
+    const sz length = strlen(text);
+    return string->value.string.length == length && strncmp(string->value.string.data, text, length) == 0;
+}
@@ -0,0 +1,51 @@
+// Syphax-Engine - Ougi Washi
+
+// Minimal read-only JSON parser. Strings are not unescaped, they point into the source text,
+// so the source has to outlive the parsed document.
+
+#ifndef SE_JSON_H
+#define SE_JSON_H
+
+#include "se_types.h"
+
+typedef enum {
+    SE_JSON_NULL,
+    SE_JSON_BOOL,
+    SE_JSON_NUMBER,
+    SE_JSON_STRING,
+    SE_JSON_ARRAY,
+    SE_JSON_OBJECT
+} se_json_type;
+
+typedef struct se_json {
+    se_json_type type;
+    const c8* key; // set for object members
+    u32 key_length;
+    union {
+        b8 boolean;
+        f64 number;
+        struct {
+            const c8* data;
+            u32 length;
+        } string;
+    } value;
+    struct se_json* first_child;
+    struct se_json* next;
+    u32 child_count;
+} se_json;
+
+typedef struct se_json_block se_json_block;
+
+typedef struct {
+    se_json* root;
+    se_json_block* blocks;
+} se_json_document;
+
+extern b8 se_json_parse(se_json_document* document, const c8* text, const sz length);
+extern void se_json_free(se_json_document* document);
+extern se_json* se_json_get(const se_json* object, const c8* key);
+extern se_json* se_json_at(const se_json* array, const u32 index);
+extern f64 se_json_get_number(const se_json* object, const c8* key, const f64 fallback);
+extern b8 se_json_equals(const se_json* string, const c8* text);
+
+#endif // SE_JSON_H
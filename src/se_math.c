@@ -110,3 +110,94 @@ se_mat4 mat4_scale(const se_vec3* v) {
     return S;
 }
 
+se_mat4 mat4_from_quat(const se_vec4* q) {
+    const f32 x = q->x, y = q->y, z = q->z, w = q->w;
+    se_mat4 R = mat4_identity();
+    R.m[0] = 1.0f - 2.0f * (y*y + z*z);
+    R.m[1] = 2.0f * (x*y + z*w);
+    R.m[2] = 2.0f * (x*z - y*w);
+    R.m[4] = 2.0f * (x*y - z*w);
+    R.m[5] = 1.0f - 2.0f * (x*x + z*z);
+    R.m[6] = 2.0f * (y*z + x*w);
+    R.m[8] = 2.0f * (x*z + y*w);
+    R.m[9] = 2.0f * (y*z - x*w);
+    R.m[10] = 1.0f - 2.0f * (x*x + y*y);
+    return R;
+}
+
+se_vec3 vec3_add(se_vec3 a, se_vec3 b) {
+    return (se_vec3){ a.x+b.x, a.y+b.y, a.z+b.z };
+}
+
+se_vec3 vec3_scale(se_vec3 v, f32 s) {
+    return (se_vec3){ v.x*s, v.y*s, v.z*s };
+}
+
+f32 vec3_dot(se_vec3 a, se_vec3 b) {
+    return a.x*b.x + a.y*b.y + a.z*b.z;
+}
+
+se_vec3 mat4_transform_point(const se_mat4* m, se_vec3 p) {
+    return (se_vec3){
+        m->m[0]*p.x + m->m[4]*p.y + m->m[8]*p.z  + m->m[12],
+        m->m[1]*p.x + m->m[5]*p.y + m->m[9]*p.z  + m->m[13],
+        m->m[2]*p.x + m->m[6]*p.y + m->m[10]*p.z + m->m[14]
+    };
+}
+
+se_vec3 mat4_transform_direction(const se_mat4* m, se_vec3 d) {
+    return (se_vec3){
+        m->m[0]*d.x + m->m[4]*d.y + m->m[8]*d.z,
+        m->m[1]*d.x + m->m[5]*d.y + m->m[9]*d.z,
+        m->m[2]*d.x + m->m[6]*d.y + m->m[10]*d.z
+    };
+}
+
+// Columns of the inverse transpose are the cross products of the other two columns over the determinant,
+// only its sign matters once the result is normalized
+se_vec3 mat4_transform_normal(const se_mat4* m, se_vec3 n) {
+    const se_vec3 a = { m->m[0], m->m[1], m->m[2] };
+    const se_vec3 b = { m->m[4], m->m[5], m->m[6] };
+    const se_vec3 c = { m->m[8], m->m[9], m->m[10] };
+    const se_vec3 bc = vec3_cross(b, c);
+    const se_vec3 ca = vec3_cross(c, a);
+    const se_vec3 ab = vec3_cross(a, b);
+    const f32 sign = vec3_dot(a, bc) < 0.0f ? -1.0f : 1.0f;
+    return vec3_scale(vec3_add(vec3_add(vec3_scale(bc, n.x), vec3_scale(ca, n.y)), vec3_scale(ab, n.z)), sign);
+}
+
+// largest axis scale, used to grow bounding spheres with the transform
+f32 mat4_max_scale(const se_mat4* m) {
+    const f32 sx = m->m[0]*m->m[0] + m->m[1]*m->m[1] + m->m[2]*m->m[2];
+    const f32 sy = m->m[4]*m->m[4] + m->m[5]*m->m[5] + m->m[6]*m->m[6];
+    const f32 sz = m->m[8]*m->m[8] + m->m[9]*m->m[9] + m->m[10]*m->m[10];
+    return sqrtf(max(sx, max(sy, sz)));
+}
+
+se_frustum se_frustum_from_matrix(const se_mat4* view_projection) {
+    const f32* m = view_projection->m;
+    se_frustum frustum;
+    // rows of the column-major matrix combined (Gribb/Hartmann)
+    for (i32 i = 0; i < 3; i++) {
+        frustum.planes[i * 2 + 0] = (se_vec4){ m[3] + m[i], m[7] + m[4 + i], m[11] + m[8 + i], m[15] + m[12 + i] };
+        frustum.planes[i * 2 + 1] = (se_vec4){ m[3] - m[i], m[7] - m[4 + i], m[11] - m[8 + i], m[15] - m[12 + i] };
+    }
+    for (i32 i = 0; i < 6; i++) {
+        se_vec4* p = &frustum.planes[i];
+        const f32 len = sqrtf(p->x*p->x + p->y*p->y + p->z*p->z);
+        if (len > 0.0f) {
+            p->x /= len; p->y /= len; p->z /= len; p->w /= len;
+        }
+    }
+    return frustum;
+}
+
+b8 se_frustum_test_sphere(const se_frustum* frustum, se_vec3 center, f32 radius) {
+    for (i32 i = 0; i < 6; i++) {
+        const se_vec4* p = &frustum->planes[i];
+        if (p->x*center.x + p->y*center.y + p->z*center.z + p->w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
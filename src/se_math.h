@@ -40,5 +40,18 @@ se_mat4 mat4_rotate_x(se_mat4 m, f32 angle);
 se_mat4 mat4_rotate_y(se_mat4 m, f32 angle);
 se_mat4 mat4_rotate_z(se_mat4 m, f32 angle);
 se_mat4 mat4_scale(const se_vec3* v);
+se_mat4 mat4_from_quat(const se_vec4* q); // unit quaternion, xyz = axis * sin, w = cos
+se_vec3 vec3_add(se_vec3 a, se_vec3 b);
+se_vec3 vec3_scale(se_vec3 v, f32 s);
+f32 vec3_dot(se_vec3 a, se_vec3 b);
+se_vec3 mat4_transform_point(const se_mat4* m, se_vec3 p);
+se_vec3 mat4_transform_direction(const se_mat4* m, se_vec3 d);
+se_vec3 mat4_transform_normal(const se_mat4* m, se_vec3 n); // inverse transpose of the 3x3 part, not normalized
+f32 mat4_max_scale(const se_mat4* m);
+
+// Frustum (planes are stored as xyz = normal, w = distance, pointing inwards)
+typedef struct { se_vec4 planes[6]; } se_frustum;
+se_frustum se_frustum_from_matrix(const se_mat4* view_projection);
+b8 se_frustum_test_sphere(const se_frustum* frustum, se_vec3 center, f32 radius);
 
 #endif // SE_MATH_H
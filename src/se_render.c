@@ -2,6 +2,10 @@
 
 #include "se_render.h"
 #include "se_gl.h"
+#include "se_geometry.h"
+#include "se_json.h"
+#include "se_worker.h"
+#include "se_image.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,6 +13,8 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <errno.h>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -16,7 +22,22 @@
 static f64 se_target_fps = 60.0;
 
 static GLuint compile_shader(const char* source, GLenum type);
-static GLuint create_shader_program(const char* vertex_source, const char* fragment_source);
+static se_program* se_program_acquire(se_program_pool* pool, const c8* vertex_source, const c8* fragment_source, b8* out_cached);
+static void se_program_release(se_program* program);
+static void se_texture_destroy(se_texture* texture);
+static void se_texture_reload(se_texture* texture, se_render_handle* render_handle, const c8* path);
+static b8 se_texture_alias_valid(const se_texture_alias* alias);
+b8 se_shader_load_internal(se_shader* shader);
+static void se_render_handle_update_shader_builds(se_render_handle* render_handle);
+static b8 se_shader_rebuild(se_shader* shader);
+static b8 se_shader_build_variant_async(se_shader* shader);
+static b8 se_program_is_complete(se_program* program, const u64 frame);
+static b8 se_program_finish(se_program* program);
+static void se_model_reload(se_model* model, se_render_handle* render_handle);
+static void se_render_handle_update_texture_streaming(se_render_handle* render_handle);
+static void se_render_handle_update_texture_atlas(se_render_handle* render_handle);
+static void se_render_handle_trim_render_targets(se_render_handle* render_handle);
+static void se_render_target_free(se_render_target* target);
 
 void se_enable_blending() {
     glEnable(GL_BLEND);
@@ -49,6 +70,10 @@ se_render_handle* se_render_handle_create() {
     printf("Creating render handle\n");
     se_render_handle* render_handle = malloc(sizeof(se_render_handle));
     memset(render_handle, 0, sizeof(se_render_handle));
+    render_handle->load_budget_ms = SE_LOAD_FRAME_BUDGET_MS;
+    render_handle->texture_anisotropy = 1.0f;
+    se_render_handle_reset_texture_bindings(render_handle);
+    glActiveTexture(GL_TEXTURE0 + SE_TEXTURE_SCRATCH_UNIT);
     render_handle->render_quad_shader = se_shader_load(render_handle, "shaders/render_quad_vert.glsl", "shaders/render_quad_frag.glsl");
     return render_handle;
 }
@@ -56,6 +81,23 @@ se_render_handle* se_render_handle_create() {
 void se_render_handle_cleanup(se_render_handle* render_handle) {
     se_assertf(render_handle, "se_render_handle_cleanup :: render_handle is null");
 
+    if (se_gl_caps.program_binary) {
+        const se_program_cache_stats stats = se_program_cache_get_stats();
+        printf("Program cache - hits: %u, misses: %u, rejected: %u, saved: %u\n", stats.hits, stats.misses, stats.rejected, stats.saved);
+    }
+
+    if (render_handle->file_watch) {
+        se_file_watch_destroy(render_handle->file_watch);
+        render_handle->file_watch = NULL;
+    }
+
+    // pending loads are dropped, the slots they would fill are cleaned up below
+    if (render_handle->loader) {
+        se_worker_pool_destroy(render_handle->loader);
+        render_handle->loader = NULL;
+    }
+    se_upload_queue_cleanup(&render_handle->uploads);
+
     se_foreach(se_models, render_handle->models, i) {
         se_model* curr_model = se_models_get(&render_handle->models, i);
         se_model_cleanup(curr_model);
@@ -63,7 +105,7 @@ void se_render_handle_cleanup(se_render_handle* render_handle) {
 
     se_foreach(se_textures, render_handle->textures, i) {
         se_texture* curr_texture = se_textures_get(&render_handle->textures, i);
-        se_texture_cleanup(curr_texture);
+        se_texture_destroy(curr_texture);
     }
 
     se_foreach(se_shaders, render_handle->shaders, i) {
@@ -86,13 +128,220 @@ void se_render_handle_cleanup(se_render_handle* render_handle) {
         se_render_buffer_cleanup(curr_buffer);
     }
 
+    se_foreach(se_render_targets, render_handle->render_targets, i) {
+        se_render_target_free(se_render_targets_get(&render_handle->render_targets, i));
+    }
+
+    se_draw_list_cleanup(&render_handle->draw_list);
+    se_ring_buffer_cleanup(&render_handle->dynamic_data);
+    se_mesh_pool_cleanup(&render_handle->mesh_pool);
+    if (render_handle->placeholder_texture) {
+        glDeleteTextures(1, &render_handle->placeholder_texture);
+    }
+    for (u32 i = 0; i < render_handle->atlas_page_count; i++) {
+        glDeleteTextures(1, &render_handle->atlas_pages[i].id);
+    }
+    se_foreach(se_texture_arrays, render_handle->texture_arrays, i) {
+        se_texture_array_cleanup(se_texture_arrays_get(&render_handle->texture_arrays, i));
+    }
+    se_foreach(se_samplers, render_handle->samplers, i) {
+        glDeleteSamplers(1, &se_samplers_get(&render_handle->samplers, i)->id);
+    }
+
     free(render_handle);
 }
 
-void se_render_handle_reload_changed_shaders(se_render_handle* render_handle) {
+static se_worker_pool* se_render_handle_get_loader(se_render_handle* render_handle) {
+    if (render_handle->loader == NULL) {
+        render_handle->loader = se_worker_pool_create(0);
+    }
+    return render_handle->loader;
+}
+
+static se_ring_buffer* se_render_handle_get_dynamic_data(se_render_handle* render_handle) {
+    se_ring_buffer* ring = &render_handle->dynamic_data;
+    if (ring->buffer == 0) {
+        // the transform texture spans the whole ring
+        const sz max_size = (sz)se_gl_caps.max_texture_buffer_size * 4 * sizeof(f32);
+        se_ring_buffer_init(ring, max_size > 0 ? min((sz)SE_RING_BUFFER_SIZE, max_size) : SE_RING_BUFFER_SIZE);
+    }
+    return ring;
+}
+
+void se_render_handle_process_loads(se_render_handle* render_handle) {
+    render_handle->frame++;
+    se_render_handle_reset_texture_bindings(render_handle);
+    if (render_handle->loader) {
+        se_worker_pool_finish(render_handle->loader, render_handle->load_budget_ms / 1000.0);
+    }
+    se_render_handle_update_texture_streaming(render_handle);
+    se_render_handle_update_texture_atlas(render_handle);
+    se_upload_queue_process(&render_handle->uploads);
+    se_render_handle_update_shader_builds(render_handle);
+    se_render_handle_trim_render_targets(render_handle);
+}
+
+b8 se_render_handle_loads_pending(se_render_handle* render_handle) {
+    se_foreach(se_shaders, render_handle->shaders, i) {
+        const se_shader* shader = se_shaders_get(&render_handle->shaders, i);
+        if (shader->pending_program || shader->pending_variant.program) {
+            return true;
+        }
+    }
+    return (render_handle->loader && !se_worker_pool_is_idle(render_handle->loader)) || !se_upload_queue_is_idle(&render_handle->uploads);
+}
+
+void se_render_handle_set_texture_budget(se_render_handle* render_handle, const sz bytes) {
+    render_handle->texture_budget = bytes;
+}
+
+void se_render_handle_set_texture_anisotropy(se_render_handle* render_handle, const f32 anisotropy) {
+    render_handle->texture_anisotropy = min(max(anisotropy, 1.0f), se_gl_caps.max_anisotropy);
+}
+
+void se_render_handle_set_texture_atlasing(se_render_handle* render_handle, const b8 enabled) {
+    render_handle->texture_atlasing = enabled;
+}
+
+void se_render_handle_set_texture_compression(se_render_handle* render_handle, const b8 enabled) {
+    render_handle->texture_compression = enabled;
+}
+
+void se_render_handle_set_upload_budget(se_render_handle* render_handle, const u32 bytes_per_frame) {
+    se_upload_queue_set_budget(&render_handle->uploads, bytes_per_frame);
+}
+
+// Hot reload. Loaded files are registered with the file watch, frames only take its queue of changes
+
+static void se_render_handle_watch_file(se_render_handle* render_handle, const c8* full_path) {
+    if (render_handle->file_watch) {
+        se_file_watch_add(render_handle->file_watch, full_path);
+    }
+}
+
+static void se_render_handle_watch_resource(se_render_handle* render_handle, const c8* path) {
+    c8 full_path[MAX_PATH_LENGTH] = {0};
+    snprintf(full_path, MAX_PATH_LENGTH, "%s%s", RESOURCES_DIR, path);
+    se_render_handle_watch_file(render_handle, full_path);
+}
+
+static b8 se_path_changed(const c8* path, c8 (*changed)[MAX_PATH_LENGTH], const u32 changed_count) {
+    for (u32 i = 0; i < changed_count; i++) {
+        if (strcmp(path, changed[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static b8 se_resource_changed(const c8* path, c8 (*changed)[MAX_PATH_LENGTH], const u32 changed_count) {
+    c8 full_path[MAX_PATH_LENGTH] = {0};
+    snprintf(full_path, MAX_PATH_LENGTH, "%s%s", RESOURCES_DIR, path);
+    return se_path_changed(full_path, changed, changed_count);
+}
+
+static b8 se_shader_changed(const se_shader* shader, c8 (*changed)[MAX_PATH_LENGTH], const u32 changed_count) {
+    if (se_path_changed(shader->vertex_path, changed, changed_count) || se_path_changed(shader->fragment_path, changed, changed_count)) {
+        return true;
+    }
+    for (u32 i = 0; i < shader->dependencies.count; i++) {
+        if (se_path_changed(shader->dependencies.paths[i], changed, changed_count)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Includes are only known once the sources are read, a reload can also add new ones
+static void se_render_handle_watch_shader_dependencies(se_render_handle* render_handle) {
+    se_foreach(se_shaders, render_handle->shaders, i) {
+        se_shader* shader = se_shaders_get(&render_handle->shaders, i);
+        if (!shader->watch_dependencies) {
+            continue;
+        }
+        for (u32 j = 0; j < shader->dependencies.count; j++) {
+            se_render_handle_watch_file(render_handle, shader->dependencies.paths[j]);
+        }
+        shader->watch_dependencies = false;
+    }
+}
+
+// Changes are picked up by the next frame, a loop waiting for events has to be woken for it
+static void se_render_handle_on_file_change(void* user_data) {
+    glfwPostEmptyEvent();
+}
+
+b8 se_render_handle_reload_changed_assets(se_render_handle* render_handle) {
+    se_render_handle_update_shader_builds(render_handle);
+    if (render_handle->file_watch == NULL) {
+        // everything loaded so far is registered now, later loads register themselves
+        render_handle->file_watch = se_file_watch_create();
+        if (render_handle->file_watch == NULL) {
+            return se_render_handle_loads_pending(render_handle);
+        }
+        se_file_watch_set_callback(render_handle->file_watch, se_render_handle_on_file_change, render_handle);
+        se_foreach(se_shaders, render_handle->shaders, i) {
+            se_shader* shader = se_shaders_get(&render_handle->shaders, i);
+            se_render_handle_watch_file(render_handle, shader->vertex_path);
+            se_render_handle_watch_file(render_handle, shader->fragment_path);
+            shader->watch_dependencies = true;
+        }
+        se_render_handle_watch_shader_dependencies(render_handle);
+        se_foreach(se_textures, render_handle->textures, i) {
+            se_texture* texture = se_textures_get(&render_handle->textures, i);
+            if (texture->ref_count > 0) {
+                se_render_handle_watch_resource(render_handle, texture->path);
+            }
+        }
+        se_foreach(se_texture_aliases, render_handle->texture_aliases, i) {
+            se_texture_alias* alias = se_texture_aliases_get(&render_handle->texture_aliases, i);
+            if (se_texture_alias_valid(alias)) {
+                se_render_handle_watch_resource(render_handle, alias->path);
+            }
+        }
+        se_foreach(se_models, render_handle->models, i) {
+            se_model* model = se_models_get(&render_handle->models, i);
+            if (model->path[0] != '\0') {
+                se_render_handle_watch_resource(render_handle, model->path);
+            }
+        }
+        return se_render_handle_loads_pending(render_handle);
+    }
+
+    se_render_handle_watch_shader_dependencies(render_handle);
+    c8 changed[SE_MAX_CHANGED_FILES][MAX_PATH_LENGTH];
+    const u32 changed_count = se_file_watch_poll(render_handle->file_watch, changed, SE_MAX_CHANGED_FILES);
+    if (changed_count == 0) {
+        return se_render_handle_loads_pending(render_handle);
+    }
+    // a shader whose stages or includes changed in the same burst is rebuilt once
     se_foreach(se_shaders, render_handle->shaders, i) {
-        se_shader_reload_if_changed(se_shaders_get(&render_handle->shaders, i));
+        se_shader* shader = se_shaders_get(&render_handle->shaders, i);
+        if (shader->state != SE_ASSET_PENDING && se_shader_changed(shader, changed, changed_count)) {
+            printf("Reloading shader: %s, %s\n", shader->vertex_path, shader->fragment_path);
+            se_shader_rebuild(shader);
+        }
+    }
+    se_foreach(se_textures, render_handle->textures, i) {
+        se_texture* texture = se_textures_get(&render_handle->textures, i);
+        if (texture->ref_count > 0 && se_resource_changed(texture->path, changed, changed_count)) {
+            se_texture_reload(texture, render_handle, texture->path);
+        }
     }
+    // copies share one texture, an edit to any of them reloads it
+    se_foreach(se_texture_aliases, render_handle->texture_aliases, i) {
+        se_texture_alias* alias = se_texture_aliases_get(&render_handle->texture_aliases, i);
+        if (se_texture_alias_valid(alias) && se_resource_changed(alias->path, changed, changed_count)) {
+            se_texture_reload(alias->texture, render_handle, alias->path);
+        }
+    }
+    se_foreach(se_models, render_handle->models, i) {
+        se_model* model = se_models_get(&render_handle->models, i);
+        if (model->path[0] != '\0' && se_resource_changed(model->path, changed, changed_count)) {
+            se_model_reload(model, render_handle);
+        }
+    }
+    return true;
 }
 
 se_uniforms* se_render_handle_get_global_uniforms(se_render_handle* render_handle) {
@@ -114,430 +363,3105 @@ char *read_file(const char *path) {
     return buf;
 }
 
-se_texture* se_texture_load(se_render_handle* render_handle, const char* file_path, const se_texture_wrap wrap) {
-    stbi_set_flip_vertically_on_load(1);
+static void* se_map_file(const c8* path, sz* out_size) {
+    const i32 fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    void* data = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+    *out_size = file_stat.st_size;
+    return data;
+}
 
-    se_texture* texture = se_textures_increment(&render_handle->textures);
-    
-    const c8 full_path[MAX_PATH_LENGTH] = RESOURCES_DIR;
-    strncat((c8*)full_path, file_path, MAX_PATH_LENGTH - strlen(full_path) - 1);
+// Source path and format version, one cache file per source so a re-cook overwrites the previous one
+static u64 se_cache_key(const c8* full_path, const u32 version) {
+    const u64 key = se_hash(full_path, strlen(full_path), SE_HASH_SEED);
+    return se_hash(&version, sizeof(version), key);
+}
 
-    unsigned char* pixels = stbi_load(full_path, &texture->width, &texture->height, &texture->channels, 0);
-    if (!pixels) {
-        fprintf(stderr, "Error: could not load image %s\n", file_path);
+// Modification time (to the nanosecond) and size of the source, stored in the cooked header. 0 if the source doesn't exist
+static u64 se_cache_source_stamp(const c8* full_path) {
+    struct stat st;
+    if (stat(full_path, &st) != 0) {
         return 0;
     }
+#ifdef __APPLE__
+    const struct timespec mtime = st.st_mtimespec;
+#else
+    const struct timespec mtime = st.st_mtim;
+#endif
+    const i64 seconds = mtime.tv_sec;
+    const i64 nanoseconds = mtime.tv_nsec;
+    const i64 size = st.st_size;
+    u64 stamp = se_hash(&seconds, sizeof(seconds), SE_HASH_SEED);
+    stamp = se_hash(&nanoseconds, sizeof(nanoseconds), stamp);
+    return se_hash(&size, sizeof(size), stamp);
+}
 
-    glGenTextures(1, &texture->id);
-    glActiveTexture(GL_TEXTURE0);             // always bind to unit 0 by default
-    glBindTexture(GL_TEXTURE_2D, texture->id);
+// Cooked texture container, every mip level pre-filtered (and BC compressed when enabled) so loads are only I/O
+#define SE_TEXTURE_CACHE_MAGIC 0x58544553 // "SETX"
+#define SE_TEXTURE_MAX_LEVELS 16
 
-    // Upload to GPU
-    GLenum format = (texture->channels == 4) ? GL_RGBA : GL_RGB;
-    glTexImage2D(GL_TEXTURE_2D, 0, format, texture->width, texture->height, 0, format, GL_UNSIGNED_BYTE, pixels);
-    glGenerateMipmap(GL_TEXTURE_2D);
+typedef enum {
+    SE_TEXTURE_FORMAT_RGB8,
+    SE_TEXTURE_FORMAT_RGBA8,
+    SE_TEXTURE_FORMAT_BC1,
+    SE_TEXTURE_FORMAT_BC3
+} se_texture_format;
 
-    // Set filtering/wrapping
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    if (wrap == SE_CLAMP) {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE);
-    } else if (wrap == SE_REPEAT) {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_REPEAT);
-    }
-    
-    stbi_image_free(pixels);
-    return texture;
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 format;
+    i32 width;
+    i32 height;
+    i32 channels; // of the source image
+    u32 level_count;
+    u32 level_offsets[SE_TEXTURE_MAX_LEVELS]; // from the start of the file
+    u32 level_sizes[SE_TEXTURE_MAX_LEVELS];
+    u64 content_hash; // of the whole file with this field and source_stamp zeroed, so loads never hash the levels
+    u64 source_stamp; // se_cache_source_stamp when cooked, stale once it differs
+} se_texture_cache_header;
+
+static b8 se_texture_compression_enabled(se_render_handle* render_handle) {
+    return render_handle->texture_compression && se_gl_caps.texture_compression_s3tc;
 }
 
-void se_texture_cleanup(se_texture* texture){
-    glDeleteTextures(1, &texture->id);
-    texture->id = 0;
-    texture->width = 0;
-    texture->height = 0;
-    texture->channels = 0;
-    texture->path[0] = '\0';
+static b8 se_texture_cache_get_path(c8* out_path, const c8* full_path, const b8 compress) {
+    const u64 key = se_hash(&compress, sizeof(compress), se_cache_key(full_path, SE_TEXTURE_CACHE_VERSION));
+    return se_cache_get_path(out_path, key, "setex");
 }
 
-b8 se_shader_load_internal(se_shader* shader) {
-   
-    assert(shader);
+static u8* se_texture_cook(const u8* pixels, const i32 width, const i32 height, const i32 channels, b8 compress, const u64 source_stamp, sz* out_size) {
+    // small images gain little from BC and stay packable into the atlas
+    compress = compress && max(width, height) > SE_TEXTURE_ATLAS_MAX_IMAGE_SIZE;
+    u8* expanded = NULL;
+    i32 level_channels = channels;
+    if (channels < 3) {
+        expanded = se_image_expand_channels(pixels, width, height, channels, &level_channels);
+        pixels = expanded;
+    }
+    const b8 alpha = level_channels == 4;
 
-    se_shader_cleanup(shader);
-    
-    char* vertex_source = load_file(shader->vertex_path);
-    char* fragment_source = load_file(shader->fragment_path);
-    
-    if (!vertex_source || !fragment_source) {
-        free(vertex_source);
-        free(fragment_source);
+    se_texture_cache_header header = {0};
+    header.magic = SE_TEXTURE_CACHE_MAGIC;
+    header.version = SE_TEXTURE_CACHE_VERSION;
+    header.format = compress ? (alpha ? SE_TEXTURE_FORMAT_BC3 : SE_TEXTURE_FORMAT_BC1) : (alpha ? SE_TEXTURE_FORMAT_RGBA8 : SE_TEXTURE_FORMAT_RGB8);
+    header.width = width;
+    header.height = height;
+    header.channels = channels;
+
+    // full chain down to 1x1, levels are 16 byte aligned
+    sz size = (sizeof(header) + 15) & ~(sz)15;
+    i32 level_width = width, level_height = height;
+    while (header.level_count < SE_TEXTURE_MAX_LEVELS) {
+        const sz level_size = compress ? se_image_bc_size(level_width, level_height, alpha ? SE_IMAGE_BC3_BLOCK_SIZE : SE_IMAGE_BC1_BLOCK_SIZE)
+                                       : (sz)level_width * level_height * level_channels;
+        header.level_offsets[header.level_count] = (u32)size;
+        header.level_sizes[header.level_count] = (u32)level_size;
+        header.level_count++;
+        size += (level_size + 15) & ~(sz)15;
+        if (level_width == 1 && level_height == 1) {
+            break;
+        }
+        level_width = max(level_width / 2, 1);
+        level_height = max(level_height / 2, 1);
+    }
+
+    u8* data = calloc(1, size);
+    memcpy(data, &header, sizeof(header));
+    const u8* level_pixels = pixels;
+    u8* owned_pixels = NULL;
+    level_width = width;
+    level_height = height;
+    for (u32 level = 0; level < header.level_count; level++) {
+        u8* out = data + header.level_offsets[level];
+        if (!compress) {
+            memcpy(out, level_pixels, header.level_sizes[level]);
+        } else if (alpha) {
+            se_image_encode_bc3(level_pixels, level_width, level_height, out);
+        } else {
+            se_image_encode_bc1(level_pixels, level_width, level_height, level_channels, out);
+        }
+        if (level + 1 < header.level_count) {
+            u8* next = se_image_downsample(level_pixels, level_width, level_height, level_channels, &level_width, &level_height);
+            free(owned_pixels);
+            owned_pixels = next;
+            level_pixels = next;
+        }
+    }
+    free(owned_pixels);
+    free(expanded);
+    header.content_hash = se_hash(data, size, SE_HASH_SEED);
+    header.source_stamp = source_stamp;
+    memcpy(data, &header, sizeof(header));
+    *out_size = size;
+    return data;
+}
+
+static u64 se_texture_cache_content_hash(const u8* cooked) {
+    se_texture_cache_header header;
+    memcpy(&header, cooked, sizeof(header));
+    return header.content_hash;
+}
+
+static b8 se_texture_cache_validate(const u8* data, const sz size, const c8* full_path) {
+    se_texture_cache_header header;
+    if (size < sizeof(header)) {
         return false;
     }
-    shader->program = create_shader_program(vertex_source, fragment_source);
-    free(vertex_source);
-    free(fragment_source);
-    
-    if (!shader->program) {
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != SE_TEXTURE_CACHE_MAGIC || header.version != SE_TEXTURE_CACHE_VERSION || header.source_stamp != se_cache_source_stamp(full_path) ||
+        header.format > SE_TEXTURE_FORMAT_BC3 ||
+        header.level_count == 0 || header.level_count > SE_TEXTURE_MAX_LEVELS || header.width <= 0 || header.height <= 0) {
         return false;
     }
-    
-    shader->vertex_mtime = get_file_mtime(shader->vertex_path);
-    shader->fragment_mtime = get_file_mtime(shader->fragment_path);
-    printf("Shader - created program: %d, from %s, %s\n", shader->program, shader->vertex_path, shader->fragment_path);
+    // every level has to hold exactly its pixels, uploads read level_sizes bytes for the dimensions of the level
+    const b8 compressed = header.format == SE_TEXTURE_FORMAT_BC1 || header.format == SE_TEXTURE_FORMAT_BC3;
+    for (u32 i = 0; i < header.level_count; i++) {
+        const i32 width = max(header.width >> i, 1);
+        const i32 height = max(header.height >> i, 1);
+        const sz level_size = compressed ? se_image_bc_size(width, height, header.format == SE_TEXTURE_FORMAT_BC1 ? SE_IMAGE_BC1_BLOCK_SIZE : SE_IMAGE_BC3_BLOCK_SIZE)
+                                         : (sz)width * height * (header.format == SE_TEXTURE_FORMAT_RGBA8 ? 4 : 3);
+        if (header.level_sizes[i] != level_size || (sz)header.level_offsets[i] + header.level_sizes[i] > size) {
+            return false;
+        }
+    }
     return true;
 }
 
-se_shader* se_shader_load(se_render_handle* render_handle, const char* vertex_file_path, const char* fragment_file_path) {
-    se_shader* new_shader = se_shaders_increment(&render_handle->shaders);
-    // make path absolute
-    char* new_vertex_path = NULL;
-    char* new_fragment_path = NULL;
-    
-    if (strlen(vertex_file_path) > 0) {
-        new_vertex_path = malloc(strlen(RESOURCES_DIR) + strlen(vertex_file_path) + 1);
-        strcpy(new_vertex_path, RESOURCES_DIR);
-        strcat(new_vertex_path, vertex_file_path);
-    }
-    
-    if (strlen(fragment_file_path) > 0) {
-        new_fragment_path = malloc(strlen(RESOURCES_DIR) + strlen(fragment_file_path) + 1);
-        strcpy(new_fragment_path, RESOURCES_DIR);
-        strcat(new_fragment_path, fragment_file_path);
+// Decodes the source and cooks it, the container is written to cache_path when given. No GL calls
+static u8* se_texture_cook_file(const c8* full_path, const c8* cache_path, const b8 compress, sz* out_size) {
+    // stamped before decoding, an edit landing meanwhile makes the next load cook again
+    const u64 source_stamp = se_cache_source_stamp(full_path);
+    i32 width = 0, height = 0, channels = 0;
+    u8* pixels = stbi_load(full_path, &width, &height, &channels, 0);
+    if (!pixels) {
+        return NULL;
     }
+    u8* cooked = se_texture_cook(pixels, width, height, channels, compress, source_stamp, out_size);
+    stbi_image_free(pixels);
 
-    strcpy(new_shader->vertex_path, new_vertex_path);
-    strcpy(new_shader->fragment_path, new_fragment_path);
-    free(new_vertex_path);
-    free(new_fragment_path);
-    if (se_shader_load_internal(new_shader)) {
-        return new_shader;
+    if (cache_path && cache_path[0] != '\0') {
+        FILE* file = fopen(cache_path, "wb");
+        if (file) {
+            fwrite(cooked, 1, *out_size, file);
+            fclose(file);
+        } else {
+            fprintf(stderr, "se_texture_cook_file :: could not write %s\n", cache_path);
+        }
     }
-    return NULL;
+    return cooked;
 }
 
-b8 se_shader_reload_if_changed(se_shader* shader) {
-    if (strlen(shader->vertex_path) == 0 || strlen(shader->fragment_path) == 0) {
-        return false;
-    }
-    
-    time_t vertex_mtime = get_file_mtime(shader->vertex_path);
-    time_t fragment_mtime = get_file_mtime(shader->fragment_path);
-    
-    if (vertex_mtime != shader->vertex_mtime || fragment_mtime != shader->fragment_mtime) {
-        printf("Reloading shader: %s, %s\n", shader->vertex_path, shader->fragment_path);
-        return se_shader_load_internal(shader);
+static GLenum se_texture_format_to_gl(const u32 format, b8* out_compressed) {
+    *out_compressed = format == SE_TEXTURE_FORMAT_BC1 || format == SE_TEXTURE_FORMAT_BC3;
+    switch (format) {
+        case SE_TEXTURE_FORMAT_RGBA8: return GL_RGBA;
+        case SE_TEXTURE_FORMAT_BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case SE_TEXTURE_FORMAT_BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        default: return GL_RGB;
     }
-    
-    return false;
 }
 
-void se_shader_use(se_render_handle* render_handle, se_shader* shader, const b8 update_uniforms, const b8 update_global_uniforms) {
-    glUseProgram(shader->program);
-    if (update_uniforms) {
-        se_uniform_apply(render_handle, shader, update_global_uniforms);
+static void se_texture_set_header(se_texture* texture, const se_texture_cache_header* header) {
+    texture->format = se_texture_format_to_gl(header->format, &texture->compressed);
+    texture->width = header->width;
+    texture->height = header->height;
+    texture->channels = header->channels;
+    texture->level_count = header->level_count;
+    texture->tail_level = 0;
+    while (texture->tail_level + 1 < texture->level_count &&
+           max(header->width >> texture->tail_level, header->height >> texture->tail_level) > SE_TEXTURE_MIP_TAIL_SIZE) {
+        texture->tail_level++;
     }
 }
 
-void se_shader_cleanup(se_shader* shader) {
-    if (shader->program) {
-        glDeleteProgram(shader->program);
-        shader->program = 0;
+static sz se_texture_level_size(const se_texture* texture, const u32 level) {
+    const i32 width = max(texture->width >> level, 1);
+    const i32 height = max(texture->height >> level, 1);
+    if (texture->compressed) {
+        return se_image_bc_size(width, height, texture->format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? SE_IMAGE_BC1_BLOCK_SIZE : SE_IMAGE_BC3_BLOCK_SIZE);
     }
+    return (sz)width * height * (texture->format == GL_RGBA ? 4 : 3);
 }
 
-GLuint se_shader_get_uniform_location(se_shader* shader, const char* name) {
-    return glGetUniformLocation(shader->program, name);
+// Specifies the storage of one level on the bound texture, released again with allocate false
+static void se_texture_define_level(const se_texture* texture, const u32 level, const u8* pixels, const b8 allocate) {
+    const i32 width = allocate ? max(texture->width >> level, 1) : 0;
+    const i32 height = allocate ? max(texture->height >> level, 1) : 0;
+    if (texture->compressed) {
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, texture->format, width, height, 0, allocate ? se_texture_level_size(texture, level) : 0, pixels);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, level, texture->format, width, height, 0, texture->format, GL_UNSIGNED_BYTE, pixels);
+    }
 }
 
-void se_shader_set_float(se_shader* shader, const char* name, f32 value){
-    se_uniform_set_float(&shader->uniforms, name, value);
+// Levels under the base level are never sampled, so they can be missing. It is texture state, unlike GL_TEXTURE_MIN_LOD the bound sampler can't override it
+static void se_texture_set_base_level(const u32 level) {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
 }
 
-void se_shader_set_vec2(se_shader* shader, const char* name, const se_vec2* value){
-    se_uniform_set_vec2(&shader->uniforms, name, value);
-}
+// Allocates the levels from first_level down to 1x1, and fills them from the container when fill is set
+static GLuint se_texture_create_levels(const se_texture* texture, const u8* data, const u32 first_level, const b8 fill) {
+    se_texture_cache_header header;
+    memcpy(&header, data, sizeof(header));
 
-void se_shader_set_vec3(se_shader* shader, const char* name, const se_vec3* value){
-    se_uniform_set_vec3(&shader->uniforms, name, value);
-}
+    GLuint id = 0;
+    glGenTextures(1, &id);
+    glBindTexture(GL_TEXTURE_2D, id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture->level_count - 1);
+    se_texture_set_base_level(first_level);
 
-void se_shader_set_vec4(se_shader* shader, const char* name, const se_vec4* value){
-    se_uniform_set_vec4(&shader->uniforms, name, value);
-}
+    // Upload to GPU, straight from the container
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (u32 level = first_level; level < texture->level_count; level++) {
+        se_texture_define_level(texture, level, fill ? data + header.level_offsets[level] : NULL, true);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
-void se_shader_set_int(se_shader* shader, const char* name, i32 value){
-    se_uniform_set_int(&shader->uniforms, name, value);
+    // Set filtering/wrapping
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    if (texture->wrap == SE_CLAMP) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE);
+    } else if (texture->wrap == SE_REPEAT) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_REPEAT);
+    }
+    return id;
 }
 
-void se_shader_set_texture(se_shader* shader, const char* name, GLuint texture){
-    se_uniform_set_texture(&shader->uniforms, name, texture);
+// Texture atlas. Small clamped images are packed into shared pages with a skyline packer, so 2D scenes
+// bind one or two textures. Every image is surrounded by a gutter of its replicated edge texels and placed
+// on a SE_TEXTURE_ATLAS_PADDING grid, which keeps the first SE_TEXTURE_ATLAS_LEVELS mips free of bleeding.
+
+static void se_texture_atlas_page_reset(se_texture_atlas_page* page) {
+    page->skyline[0] = (se_skyline_node){ 0, 0, SE_TEXTURE_ATLAS_SIZE };
+    page->node_count = 1;
 }
 
-void se_shader_set_buffer_texture(se_shader* shader, const char* name, se_render_buffer* buffer){
-    se_uniform_set_buffer_texture(&shader->uniforms, name, buffer);
+static void se_texture_atlas_page_init(se_texture_atlas_page* page) {
+    glGenTextures(1, &page->id);
+    glBindTexture(GL_TEXTURE_2D, page->id);
+    for (i32 level = 0; level < SE_TEXTURE_ATLAS_LEVELS; level++) {
+        const i32 size = SE_TEXTURE_ATLAS_SIZE >> level;
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, SE_TEXTURE_ATLAS_LEVELS - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    page->texture_count = 0;
+    page->dirty = false;
+    se_texture_atlas_page_reset(page);
 }
 
-// Mesh functions
-void se_mesh_translate(se_mesh* mesh, const se_vec3* v){
-    mesh->matrix = mat4_mul(mesh->matrix, mat4_translate(v));
+// y the rect lands at when its left edge is on the node, -1 if it doesn't fit
+static i32 se_skyline_fit(const se_texture_atlas_page* page, const u32 index, const i32 width, const i32 height) {
+    const i32 x = page->skyline[index].x;
+    if (x + width > SE_TEXTURE_ATLAS_SIZE) {
+        return -1;
+    }
+    i32 y = 0;
+    i32 width_left = width;
+    for (u32 i = index; width_left > 0; i++) {
+        if (i >= page->node_count) {
+            return -1;
+        }
+        y = max(y, page->skyline[i].y);
+        if (y + height > SE_TEXTURE_ATLAS_SIZE) {
+            return -1;
+        }
+        width_left -= page->skyline[i].width;
+    }
+    return y;
 }
 
-void se_mesh_rotate(se_mesh* mesh, const se_vec3* v){
-    mesh->matrix = mat4_mul(mesh->matrix, mat4_rotate_x(mat4_identity(), v->x));
-    mesh->matrix = mat4_mul(mesh->matrix, mat4_rotate_y(mat4_identity(), v->y));
-    mesh->matrix = mat4_mul(mesh->matrix, mat4_rotate_z(mat4_identity(), v->z));
+// Bottom left: lowest top edge first, then the narrowest node
+static b8 se_skyline_insert(se_texture_atlas_page* page, const i32 width, const i32 height, i32* out_x, i32* out_y) {
+    if (page->node_count >= SE_TEXTURE_ATLAS_MAX_NODES) {
+        return false;
+    }
+    i32 best_index = -1, best_top = SE_TEXTURE_ATLAS_SIZE + 1, best_width = SE_TEXTURE_ATLAS_SIZE + 1, best_y = 0;
+    for (u32 i = 0; i < page->node_count; i++) {
+        const i32 y = se_skyline_fit(page, i, width, height);
+        if (y < 0) {
+            continue;
+        }
+        if (y + height < best_top || (y + height == best_top && page->skyline[i].width < best_width)) {
+            best_index = i;
+            best_top = y + height;
+            best_width = page->skyline[i].width;
+            best_y = y;
+        }
+    }
+    if (best_index < 0) {
+        return false;
+    }
+
+    const se_skyline_node node = { page->skyline[best_index].x, best_y + height, width };
+    memmove(&page->skyline[best_index + 1], &page->skyline[best_index], (page->node_count - best_index) * sizeof(se_skyline_node));
+    page->skyline[best_index] = node;
+    page->node_count++;
+
+    // the new node shadows the ones it covers
+    for (u32 i = best_index + 1; i < page->node_count;) {
+        const se_skyline_node* previous = &page->skyline[i - 1];
+        se_skyline_node* current = &page->skyline[i];
+        const i32 overlap = previous->x + previous->width - current->x;
+        if (overlap <= 0) {
+            break;
+        }
+        current->x += overlap;
+        current->width -= overlap;
+        if (current->width > 0) {
+            break;
+        }
+        memmove(current, current + 1, (page->node_count - i - 1) * sizeof(se_skyline_node));
+        page->node_count--;
+    }
+    for (u32 i = 0; i + 1 < page->node_count;) {
+        if (page->skyline[i].y == page->skyline[i + 1].y) {
+            page->skyline[i].width += page->skyline[i + 1].width;
+            memmove(&page->skyline[i + 1], &page->skyline[i + 2], (page->node_count - i - 2) * sizeof(se_skyline_node));
+            page->node_count--;
+        } else {
+            i++;
+        }
+    }
+    *out_x = node.x;
+    *out_y = best_y;
+    return true;
 }
 
-void se_mesh_scale(se_mesh* mesh, const se_vec3* v){
-    mesh->matrix = mat4_mul(mesh->matrix, mat4_scale(v));
+static b8 se_texture_atlas_accepts(se_render_handle* render_handle, const se_texture* texture, const se_texture_cache_header* header) {
+    return render_handle->texture_atlasing && texture->wrap == SE_CLAMP &&
+           (header->format == SE_TEXTURE_FORMAT_RGB8 || header->format == SE_TEXTURE_FORMAT_RGBA8) &&
+           header->width <= SE_TEXTURE_ATLAS_MAX_IMAGE_SIZE && header->height <= SE_TEXTURE_ATLAS_MAX_IMAGE_SIZE;
 }
 
-// Helper function to finalize a mesh
-void finalize_mesh(se_mesh* mesh, se_vertex* vertices, u32* indices, u32 vertex_count, u32 index_count, 
-                   se_shaders_ptr* shaders, u32 se_mesh_index) {
-// Allocate mesh data
-    mesh->vertices = malloc(vertex_count * sizeof(se_vertex));
-    mesh->indices = malloc(index_count * sizeof(u32));
+// Packs level 0 of the container, false when every page is full
+static b8 se_texture_atlas_insert(se_render_handle* render_handle, se_texture* texture, const u8* data) {
+    se_texture_cache_header header;
+    memcpy(&header, data, sizeof(header));
+    const i32 padding = SE_TEXTURE_ATLAS_PADDING;
+    const i32 cell_width = (header.width + 2 * padding + padding - 1) / padding * padding;
+    const i32 cell_height = (header.height + 2 * padding + padding - 1) / padding * padding;
+
+    se_texture_atlas_page* page = NULL;
+    i32 x = 0, y = 0;
+    for (u32 i = 0; i < render_handle->atlas_page_count && !page; i++) {
+        if (se_skyline_insert(&render_handle->atlas_pages[i], cell_width, cell_height, &x, &y)) {
+            page = &render_handle->atlas_pages[i];
+        }
+    }
+    if (!page && render_handle->atlas_page_count < SE_TEXTURE_ATLAS_MAX_PAGES) {
+        se_texture_atlas_page* new_page = &render_handle->atlas_pages[render_handle->atlas_page_count++];
+        se_texture_atlas_page_init(new_page);
+        if (se_skyline_insert(new_page, cell_width, cell_height, &x, &y)) {
+            page = new_page;
+        }
+    }
+    if (!page) {
+        return false;
+    }
+
+    // the whole cell, edges clamped into the gutter
+    const i32 channels = header.format == SE_TEXTURE_FORMAT_RGBA8 ? 4 : 3;
+    const u8* pixels = data + header.level_offsets[0];
+    u8* cell = malloc((sz)cell_width * cell_height * 4);
+    for (i32 cell_y = 0; cell_y < cell_height; cell_y++) {
+        const i32 source_y = min(max(cell_y - padding, 0), header.height - 1);
+        for (i32 cell_x = 0; cell_x < cell_width; cell_x++) {
+            const i32 source_x = min(max(cell_x - padding, 0), header.width - 1);
+            const u8* source = pixels + ((sz)source_y * header.width + source_x) * channels;
+            u8* out = cell + ((sz)cell_y * cell_width + cell_x) * 4;
+            out[0] = source[0];
+            out[1] = source[1];
+            out[2] = source[2];
+            out[3] = channels == 4 ? source[3] : 255;
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, page->id);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, cell_width, cell_height, GL_RGBA, GL_UNSIGNED_BYTE, cell);
+    free(cell);
+    page->dirty = true;
+    page->texture_count++;
+
+    const f32 size = SE_TEXTURE_ATLAS_SIZE;
+    texture->id = page->id;
+    texture->atlas_page = page;
+    texture->uv_rect = (se_vec4){ (x + padding) / size, (y + padding) / size, header.width / size, header.height / size };
+    texture->format = GL_RGBA;
+    texture->width = header.width;
+    texture->height = header.height;
+    texture->channels = header.channels;
+    return true;
+}
+
+// On the scratch unit, so it can run while se_uniform_apply binds textures
+static void se_texture_atlas_page_update_mips(se_texture_atlas_page* page) {
+    if (!page->dirty) {
+        return;
+    }
+    if (se_gl_caps.direct_state_access) {
+        glGenerateTextureMipmap(page->id);
+    } else {
+        glActiveTexture(GL_TEXTURE0 + SE_TEXTURE_SCRATCH_UNIT);
+        glBindTexture(GL_TEXTURE_2D, page->id);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    page->dirty = false;
+}
+
+// Mips of the pages written since the last call, se_texture_use catches pages written after it (sync loads mid frame)
+static void se_render_handle_update_texture_atlas(se_render_handle* render_handle) {
+    for (u32 i = 0; i < render_handle->atlas_page_count; i++) {
+        se_texture_atlas_page_update_mips(&render_handle->atlas_pages[i]);
+    }
+}
+
+static u64 se_texture_path_hash(const c8* path, const se_texture_wrap wrap) {
+    return se_hash(&wrap, sizeof(wrap), se_hash(path, strlen(path), SE_HASH_SEED));
+}
+
+static b8 se_texture_alias_valid(const se_texture_alias* alias) {
+    return alias->texture->ref_count > 0 && alias->texture->path_hash == alias->texture_path_hash;
+}
+
+// Records path as another name of texture and watches it, stale entries are reused first
+static void se_texture_add_alias(se_render_handle* render_handle, se_texture* texture, const c8* path, const u64 path_hash) {
+    se_texture_alias* alias = NULL;
+    se_foreach(se_texture_aliases, render_handle->texture_aliases, i) {
+        se_texture_alias* curr_alias = se_texture_aliases_get(&render_handle->texture_aliases, i);
+        if (!se_texture_alias_valid(curr_alias)) {
+            alias = curr_alias;
+            break;
+        }
+    }
+    if (!alias) {
+        alias = se_texture_aliases_increment(&render_handle->texture_aliases);
+    }
+    if (!alias) {
+        return; // still deduplicated, later loads of path just hash it again
+    }
+    memset(alias, 0, sizeof(se_texture_alias));
+    strncpy(alias->path, path, sizeof(alias->path) - 1);
+    alias->path_hash = path_hash;
+    alias->texture = texture;
+    alias->texture_path_hash = texture->path_hash;
+    se_render_handle_watch_resource(render_handle, path);
+}
+
+static se_texture* se_texture_find_path(se_render_handle* render_handle, const c8* path, const u64 path_hash) {
+    se_foreach(se_textures, render_handle->textures, i) {
+        se_texture* texture = se_textures_get(&render_handle->textures, i);
+        if (texture->ref_count > 0 && texture->state != SE_ASSET_FAILED && texture->path_hash == path_hash && strcmp(texture->path, path) == 0) {
+            return texture;
+        }
+    }
+    se_foreach(se_texture_aliases, render_handle->texture_aliases, i) {
+        se_texture_alias* alias = se_texture_aliases_get(&render_handle->texture_aliases, i);
+        if (se_texture_alias_valid(alias) && alias->texture->state != SE_ASSET_FAILED && alias->path_hash == path_hash && strcmp(alias->path, path) == 0) {
+            return alias->texture;
+        }
+    }
+    return NULL;
+}
+
+// Same pixels loaded from another path (copies of an icon, symlinks...)
+static se_texture* se_texture_find_content(se_render_handle* render_handle, const u64 content_hash, const se_texture_wrap wrap) {
+    se_foreach(se_textures, render_handle->textures, i) {
+        se_texture* texture = se_textures_get(&render_handle->textures, i);
+        if (texture->ref_count > 0 && texture->state == SE_ASSET_READY && texture->content_hash == content_hash && texture->wrap == wrap) {
+            return texture;
+        }
+    }
+    return NULL;
+}
+
+// Reuses slots released by se_texture_cleanup before growing the array
+static se_texture* se_texture_allocate(se_render_handle* render_handle, const c8* path, const u64 path_hash, const se_texture_wrap wrap) {
+    se_texture* texture = NULL;
+    se_foreach(se_textures, render_handle->textures, i) {
+        se_texture* curr_texture = se_textures_get(&render_handle->textures, i);
+        if (curr_texture->ref_count == 0) {
+            texture = curr_texture;
+            break;
+        }
+    }
+    if (!texture) {
+        texture = se_textures_increment(&render_handle->textures);
+    }
+    if (!texture) {
+        fprintf(stderr, "se_texture_allocate :: too many textures, max is %d\n", SE_MAX_TEXTURES);
+        return NULL;
+    }
+    memset(texture, 0, sizeof(se_texture));
+    strncpy(texture->path, path, sizeof(texture->path) - 1);
+    texture->path_hash = path_hash;
+    texture->wrap = wrap;
+    texture->ref_count = 1;
+    texture->uv_rect = (se_vec4){ 0.0f, 0.0f, 1.0f, 1.0f };
+    const se_sampler_desc sampler = { SE_FILTER_LINEAR, wrap, render_handle->texture_anisotropy };
+    texture->sampler = se_render_handle_get_sampler(render_handle, &sampler);
+    se_render_handle_watch_resource(render_handle, path);
+    // new names may reuse ones deleted while still bound
+    se_render_handle_reset_texture_bindings(render_handle);
+    return texture;
+}
+
+se_texture* se_texture_load(se_render_handle* render_handle, const char* file_path, const se_texture_wrap wrap) {
+    stbi_set_flip_vertically_on_load(1);
+
+    const u64 path_hash = se_texture_path_hash(file_path, wrap);
+    se_texture* texture = se_texture_find_path(render_handle, file_path, path_hash);
+    if (texture) {
+        texture->ref_count++;
+        return texture;
+    }
+    
+    const c8 full_path[MAX_PATH_LENGTH] = RESOURCES_DIR;
+    strncat((c8*)full_path, file_path, MAX_PATH_LENGTH - strlen(full_path) - 1);
+
+    // cooked container if there is one, mapped and uploaded as is
+    c8 cache_path[MAX_PATH_LENGTH] = {0};
+    const b8 compress = se_texture_compression_enabled(render_handle);
+    sz size = 0;
+    u8* cooked = NULL;
+    b8 mapped = false;
+    if (se_texture_cache_get_path(cache_path, full_path, compress) && (cooked = se_map_file(cache_path, &size))) {
+        mapped = se_texture_cache_validate(cooked, size, full_path);
+        if (!mapped) {
+            munmap(cooked, size);
+            cooked = NULL;
+        }
+    }
+    if (!cooked) {
+        cooked = se_texture_cook_file(full_path, cache_path, compress, &size);
+    }
+    if (!cooked) {
+        fprintf(stderr, "Error: could not load image %s\n", file_path);
+        return 0;
+    }
+
+    const u64 content_hash = se_texture_cache_content_hash(cooked);
+    texture = se_texture_find_content(render_handle, content_hash, wrap);
+    if (texture) {
+        texture->ref_count++;
+        se_texture_add_alias(render_handle, texture, file_path, path_hash);
+    } else {
+        se_texture_cache_header header;
+        memcpy(&header, cooked, sizeof(header));
+        texture = se_texture_allocate(render_handle, file_path, path_hash, wrap);
+        if (!texture) {
+            if (mapped) {
+                munmap(cooked, size);
+            } else {
+                free(cooked);
+            }
+            return NULL;
+        }
+        texture->content_hash = content_hash;
+        if (!se_texture_atlas_accepts(render_handle, texture, &header) || !se_texture_atlas_insert(render_handle, texture, cooked)) {
+            se_texture_set_header(texture, &header);
+            texture->id = se_texture_create_levels(texture, cooked, 0, true);
+            // evicted levels come back from the container
+            if (mapped || (cache_path[0] != '\0' && access(cache_path, R_OK) == 0)) {
+                memcpy(texture->cache_path, cache_path, sizeof(texture->cache_path));
+            }
+        }
+        texture->last_used_frame = render_handle->frame;
+        texture->state = SE_ASSET_READY;
+    }
+    
+    if (mapped) {
+        munmap(cooked, size);
+    } else {
+        free(cooked);
+    }
+    return texture;
+}
+
+// 1x1 white, bound by textures that are still loading
+static GLuint se_render_handle_get_placeholder_texture(se_render_handle* render_handle) {
+    if (render_handle->placeholder_texture == 0) {
+        const u8 white[4] = { 255, 255, 255, 255 };
+        glGenTextures(1, &render_handle->placeholder_texture);
+        glBindTexture(GL_TEXTURE_2D, render_handle->placeholder_texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    return render_handle->placeholder_texture;
+}
+
+typedef struct {
+    se_job job;
+    se_render_handle* render_handle;
+    se_texture* texture;
+    u64 path_hash; // the slot may have been released and reused while loading
+    se_texture_wrap wrap;
+    b8 compress;
+    c8 full_path[MAX_PATH_LENGTH];
+    c8 cache_path[MAX_PATH_LENGTH];
+    b8 cached; // the container is on disk, higher levels can stream from it later
+    u8* cooked;
+    sz cooked_size;
+    u64 content_hash;
+} se_texture_load_job;
+
+static void se_texture_load_job_run(se_job* job) {
+    se_texture_load_job* load = (se_texture_load_job*)job;
+    if (se_texture_cache_get_path(load->cache_path, load->full_path, load->compress)) {
+        FILE* file = fopen(load->cache_path, "rb");
+        if (file) {
+            fseek(file, 0, SEEK_END);
+            load->cooked_size = ftell(file);
+            fseek(file, 0, SEEK_SET);
+            load->cooked = malloc(load->cooked_size);
+            if (fread(load->cooked, 1, load->cooked_size, file) != load->cooked_size || !se_texture_cache_validate(load->cooked, load->cooked_size, load->full_path)) {
+                free(load->cooked);
+                load->cooked = NULL;
+            }
+            fclose(file);
+        }
+    }
+    if (!load->cooked) {
+        load->cooked = se_texture_cook_file(load->full_path, load->cache_path, load->compress, &load->cooked_size);
+    }
+    if (load->cooked) {
+        load->content_hash = se_texture_cache_content_hash(load->cooked);
+        load->cached = load->cache_path[0] != '\0' && access(load->cache_path, R_OK) == 0;
+    }
+}
+
+typedef struct {
+    se_render_handle* render_handle;
+    se_texture* texture;
+    u64 path_hash;
+    se_texture streamed; // format and size, copied over once resident
+} se_texture_stream;
+
+// The texture keeps the placeholder until the first levels have landed
+static void se_texture_stream_complete(void* user_data, const b8 cancelled) {
+    se_texture_stream* stream = user_data;
+    se_texture* texture = stream->texture;
+    if (!cancelled && texture->state == SE_ASSET_PENDING && texture->path_hash == stream->path_hash) {
+        texture->id = stream->streamed.id;
+        texture->format = stream->streamed.format;
+        texture->compressed = stream->streamed.compressed;
+        texture->width = stream->streamed.width;
+        texture->height = stream->streamed.height;
+        texture->channels = stream->streamed.channels;
+        texture->level_count = stream->streamed.level_count;
+        texture->tail_level = stream->streamed.tail_level;
+        texture->resident_level = stream->streamed.resident_level;
+        texture->last_used_frame = stream->render_handle->frame;
+        memcpy(texture->cache_path, stream->streamed.cache_path, sizeof(texture->cache_path));
+        texture->state = SE_ASSET_READY;
+    } else {
+        glDeleteTextures(1, &stream->streamed.id);
+    }
+    free(stream);
+}
+
+static void se_texture_load_job_finish(se_job* job, const b8 cancelled) {
+    se_texture_load_job* load = (se_texture_load_job*)job;
+    se_texture* texture = load->texture;
+    // the slot may have been cleaned up while loading
+    if (!cancelled && texture->state == SE_ASSET_PENDING && texture->path_hash == load->path_hash) {
+        se_render_handle_reset_texture_bindings(load->render_handle);
+        se_texture_cache_header header;
+        if (load->cooked) {
+            memcpy(&header, load->cooked, sizeof(header));
+            texture->content_hash = load->content_hash;
+        }
+        if (load->cooked && se_texture_atlas_accepts(load->render_handle, texture, &header) && se_texture_atlas_insert(load->render_handle, texture, load->cooked)) {
+            // small enough to land right away
+            texture->last_used_frame = load->render_handle->frame;
+            texture->state = SE_ASSET_READY;
+        } else if (load->cooked) {
+            se_texture_stream* stream = malloc(sizeof(se_texture_stream));
+            memset(stream, 0, sizeof(se_texture_stream));
+            stream->render_handle = load->render_handle;
+            stream->texture = texture;
+            stream->path_hash = load->path_hash;
+            stream->streamed.wrap = load->wrap;
+            se_texture_set_header(&stream->streamed, &header);
+
+            // only the mip tail now when the rest can be streamed from disk later
+            if (load->cached) {
+                stream->streamed.resident_level = stream->streamed.tail_level;
+                memcpy(stream->streamed.cache_path, load->cache_path, sizeof(stream->streamed.cache_path));
+            }
+            const u32 first_level = stream->streamed.resident_level;
+            stream->streamed.id = se_texture_create_levels(&stream->streamed, load->cooked, first_level, false);
+
+            // one upload per level, smallest first, the last one owns the container and completes the texture
+            se_upload_texture_desc desc = { .texture = stream->streamed.id, .format = stream->streamed.format, .compressed = stream->streamed.compressed };
+            for (u32 level = header.level_count; level-- > first_level;) {
+                const b8 last = level == first_level;
+                desc.level = level;
+                desc.width = max(header.width >> level, 1);
+                desc.height = max(header.height >> level, 1);
+                se_upload_texture(&load->render_handle->uploads, &desc, load->cooked + header.level_offsets[level],
+                                  last ? free : NULL, last ? se_texture_stream_complete : NULL, last ? stream : NULL);
+            }
+            load->cooked = NULL; // owned by the uploads now
+        } else {
+            fprintf(stderr, "Error: could not load image %s\n", load->full_path);
+            texture->state = SE_ASSET_FAILED; // keeps the placeholder
+        }
+    }
+    free(load->cooked);
+    free(load);
+}
+
+se_texture* se_texture_load_async(se_render_handle* render_handle, const char* file_path, const se_texture_wrap wrap) {
+    stbi_set_flip_vertically_on_load(1);
+
+    // a pending load of the same path is shared too, content dedup needs the decoded data and only applies to sync loads
+    const u64 path_hash = se_texture_path_hash(file_path, wrap);
+    se_texture* texture = se_texture_find_path(render_handle, file_path, path_hash);
+    if (texture) {
+        texture->ref_count++;
+        return texture;
+    }
+
+    texture = se_texture_allocate(render_handle, file_path, path_hash, wrap);
+    if (!texture) {
+        return NULL;
+    }
+    texture->id = se_render_handle_get_placeholder_texture(render_handle);
+    texture->width = 1;
+    texture->height = 1;
+    texture->channels = 4;
+    texture->state = SE_ASSET_PENDING;
+
+    se_texture_load_job* load = malloc(sizeof(se_texture_load_job));
+    memset(load, 0, sizeof(se_texture_load_job));
+    load->job.run = se_texture_load_job_run;
+    load->job.finish = se_texture_load_job_finish;
+    load->render_handle = render_handle;
+    load->texture = texture;
+    load->path_hash = path_hash;
+    load->wrap = wrap;
+    load->compress = se_texture_compression_enabled(render_handle);
+    snprintf(load->full_path, sizeof(load->full_path), "%s%s", RESOURCES_DIR, file_path);
+    se_worker_pool_submit(se_render_handle_get_loader(render_handle), &load->job);
+    return texture;
+}
+
+// Texture streaming. Textures stay usable with only their mip tail resident, the levels above it are read
+// back from the cooked container one at a time while the texture is in use and dropped again under memory pressure.
+
+typedef struct {
+    se_job job;
+    se_render_handle* render_handle;
+    se_texture* texture;
+    u64 path_hash;
+    GLuint id; // the texture may have been destroyed and its slot reused meanwhile
+    u32 generation;
+    u32 level;
+    c8 cache_path[MAX_PATH_LENGTH];
+    u8* data;
+    sz size;
+} se_texture_level_job;
+
+static void se_texture_level_job_run(se_job* job) {
+    se_texture_level_job* stream = (se_texture_level_job*)job;
+    FILE* file = fopen(stream->cache_path, "rb");
+    if (!file) {
+        return;
+    }
+    se_texture_cache_header header;
+    if (fread(&header, sizeof(header), 1, file) == 1 && header.magic == SE_TEXTURE_CACHE_MAGIC && header.version == SE_TEXTURE_CACHE_VERSION &&
+        stream->level < header.level_count && header.level_sizes[stream->level] == stream->size) {
+        stream->data = malloc(stream->size);
+        if (fseek(file, header.level_offsets[stream->level], SEEK_SET) != 0 || fread(stream->data, 1, stream->size, file) != stream->size) {
+            free(stream->data);
+            stream->data = NULL;
+        }
+    }
+    fclose(file);
+}
+
+static b8 se_texture_level_job_is_current(const se_texture_level_job* stream) {
+    const se_texture* texture = stream->texture;
+    return texture->state == SE_ASSET_READY && texture->path_hash == stream->path_hash && texture->id == stream->id &&
+        texture->generation == stream->generation;
+}
+
+static void se_texture_level_complete(void* user_data, const b8 cancelled) {
+    se_texture_level_job* stream = user_data;
+    if (se_texture_level_job_is_current(stream)) {
+        if (!cancelled) {
+            glBindTexture(GL_TEXTURE_2D, stream->id);
+            se_texture_set_base_level(stream->level);
+            stream->texture->resident_level = stream->level;
+        }
+        stream->texture->streaming = false;
+    }
+    free(stream);
+}
+
+static void se_texture_level_job_finish(se_job* job, const b8 cancelled) {
+    se_texture_level_job* stream = (se_texture_level_job*)job;
+    if (!se_texture_level_job_is_current(stream)) {
+        free(stream->data);
+        free(stream);
+        return;
+    }
+    se_texture* texture = stream->texture;
+    if (cancelled || !stream->data) {
+        if (!cancelled) {
+            fprintf(stderr, "se_texture_level_job_finish :: could not read level %u of %s, streaming stopped\n", stream->level, texture->path);
+            texture->cache_path[0] = '\0';
+        }
+        texture->streaming = false;
+        free(stream->data);
+        free(stream);
+        return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, stream->id);
+    se_texture_define_level(texture, stream->level, NULL, true);
+    const se_upload_texture_desc desc = {
+        .texture = stream->id,
+        .level = stream->level,
+        .width = max(texture->width >> stream->level, 1),
+        .height = max(texture->height >> stream->level, 1),
+        .format = texture->format,
+        .compressed = texture->compressed
+    };
+    se_upload_texture(&stream->render_handle->uploads, &desc, stream->data, free, se_texture_level_complete, stream);
+}
+
+static void se_texture_stream_level(se_render_handle* render_handle, se_texture* texture) {
+    se_texture_level_job* stream = malloc(sizeof(se_texture_level_job));
+    memset(stream, 0, sizeof(se_texture_level_job));
+    stream->job.run = se_texture_level_job_run;
+    stream->job.finish = se_texture_level_job_finish;
+    stream->render_handle = render_handle;
+    stream->texture = texture;
+    stream->path_hash = texture->path_hash;
+    stream->id = texture->id;
+    stream->generation = texture->generation;
+    stream->level = texture->resident_level - 1;
+    stream->size = se_texture_level_size(texture, stream->level);
+    memcpy(stream->cache_path, texture->cache_path, sizeof(stream->cache_path));
+    texture->streaming = true;
+    se_worker_pool_submit(se_render_handle_get_loader(render_handle), &stream->job);
+}
+
+// Back down to the mip tail, the storage of the levels above it is released
+static void se_texture_evict(se_texture* texture) {
+    glBindTexture(GL_TEXTURE_2D, texture->id);
+    se_texture_set_base_level(texture->tail_level);
+    for (u32 level = texture->resident_level; level < texture->tail_level; level++) {
+        se_texture_define_level(texture, level, NULL, false);
+    }
+    texture->resident_level = texture->tail_level;
+}
+
+static sz se_texture_get_memory(const se_texture* texture) {
+    sz size = 0;
+    if (texture->state == SE_ASSET_READY) {
+        for (u32 level = texture->resident_level; level < texture->level_count; level++) {
+            size += se_texture_level_size(texture, level);
+        }
+    }
+    return size;
+}
+
+sz se_render_handle_get_texture_memory(se_render_handle* render_handle) {
+    sz size = (sz)render_handle->atlas_page_count * SE_TEXTURE_ATLAS_SIZE * SE_TEXTURE_ATLAS_SIZE * 4 * 4 / 3;
+    se_foreach(se_textures, render_handle->textures, i) {
+        size += se_texture_get_memory(se_textures_get(&render_handle->textures, i));
+    }
+    return size;
+}
+
+static void se_render_handle_update_texture_streaming(se_render_handle* render_handle) {
+    const sz budget = render_handle->texture_budget;
+    sz memory = se_render_handle_get_texture_memory(render_handle);
+
+    // over budget, least recently used textures that weren't drawn last frame go back to their tail
+    while (budget > 0 && memory > budget) {
+        se_texture* victim = NULL;
+        se_foreach(se_textures, render_handle->textures, i) {
+            se_texture* texture = se_textures_get(&render_handle->textures, i);
+            // without a cooked container evicted levels could never come back
+            if (texture->state != SE_ASSET_READY || texture->streaming || texture->resident_level >= texture->tail_level || texture->cache_path[0] == '\0' ||
+                texture->last_used_frame + 1 >= render_handle->frame) {
+                continue;
+            }
+            if (!victim || texture->last_used_frame < victim->last_used_frame) {
+                victim = texture;
+            }
+        }
+        if (!victim) {
+            break;
+        }
+        const sz before = se_texture_get_memory(victim);
+        se_texture_evict(victim);
+        memory -= before - se_texture_get_memory(victim);
+    }
+
+    // one more level for every texture in use, as long as it fits
+    se_foreach(se_textures, render_handle->textures, i) {
+        se_texture* texture = se_textures_get(&render_handle->textures, i);
+        if (texture->state != SE_ASSET_READY || texture->streaming || texture->resident_level == 0 || texture->cache_path[0] == '\0' ||
+            texture->last_used_frame + 1 < render_handle->frame) {
+            continue;
+        }
+        const sz size = se_texture_level_size(texture, texture->resident_level - 1);
+        if (budget > 0 && memory + size > budget) {
+            continue;
+        }
+        se_texture_stream_level(render_handle, texture);
+        memory += size;
+    }
+}
+
+GLuint se_texture_use(se_render_handle* render_handle, se_texture* texture) {
+    texture->last_used_frame = render_handle->frame;
+    if (texture->atlas_page) {
+        se_texture_atlas_page_update_mips(texture->atlas_page);
+    }
+    return texture->id;
+}
+
+static void se_texture_destroy(se_texture* texture) {
+    // pending and failed textures point at the shared placeholder, packed ones at their page
+    if (texture->atlas_page) {
+        // skyline space can't be given back one rect at a time, the page is reused once empty
+        if (--texture->atlas_page->texture_count == 0) {
+            se_texture_atlas_page_reset(texture->atlas_page);
+        }
+        texture->atlas_page = NULL;
+    } else if (texture->state == SE_ASSET_READY && texture->id != 0) {
+        glDeleteTextures(1, &texture->id);
+    }
+    texture->id = 0;
+    texture->width = 0;
+    texture->height = 0;
+    texture->channels = 0;
+    texture->path[0] = '\0';
+    texture->path_hash = 0;
+    texture->content_hash = 0;
+    texture->ref_count = 0;
+    texture->level_count = 0;
+    texture->resident_level = 0;
+    texture->streaming = false;
+    texture->cache_path[0] = '\0';
+    texture->state = SE_ASSET_READY;
+}
+
+void se_texture_cleanup(se_texture* texture){
+    if (texture->ref_count > 1) {
+        texture->ref_count--;
+        return;
+    }
+    se_texture_destroy(texture);
+}
+
+// Re-cooks path (the texture's own or one of its aliases) into the same GL name, so uniforms holding it stay valid. The old image stays if the new one can't be loaded
+static void se_texture_reload(se_texture* texture, se_render_handle* render_handle, const c8* path) {
+    if (texture->state != SE_ASSET_READY || texture->atlas_page) {
+        return; // pending loads read the new file anyway, packed images can't change size in place
+    }
+    c8 full_path[MAX_PATH_LENGTH] = {0};
+    snprintf(full_path, MAX_PATH_LENGTH, "%s%s", RESOURCES_DIR, path);
+    c8 cache_path[MAX_PATH_LENGTH] = {0};
+    const b8 compress = se_texture_compression_enabled(render_handle);
+    se_texture_cache_get_path(cache_path, full_path, compress);
+    sz size = 0;
+    stbi_set_flip_vertically_on_load(1);
+    u8* cooked = se_texture_cook_file(full_path, cache_path, compress, &size);
+    if (!cooked) {
+        fprintf(stderr, "se_texture_reload :: could not load image %s, keeping the previous one\n", path);
+        return;
+    }
+    printf("Reloading texture: %s\n", path);
+
+    se_texture_cache_header header;
+    memcpy(&header, cooked, sizeof(header));
+    se_texture_set_header(texture, &header);
+    glBindTexture(GL_TEXTURE_2D, texture->id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture->level_count - 1);
+    se_texture_set_base_level(0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (u32 level = 0; level < texture->level_count; level++) {
+        se_texture_define_level(texture, level, cooked + header.level_offsets[level], true);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    texture->resident_level = 0;
+    texture->streaming = false;
+    texture->generation++;
+    texture->content_hash = header.content_hash;
+    texture->last_used_frame = render_handle->frame;
+    if (cache_path[0] != '\0' && access(cache_path, R_OK) == 0) {
+        memcpy(texture->cache_path, cache_path, sizeof(texture->cache_path));
+    } else {
+        texture->cache_path[0] = '\0';
+    }
+    free(cooked);
+}
+
+// Sampler functions
+
+GLuint se_render_handle_get_sampler(se_render_handle* render_handle, const se_sampler_desc* desc) {
+    se_foreach(se_samplers, render_handle->samplers, i) {
+        se_sampler* sampler = se_samplers_get(&render_handle->samplers, i);
+        if (sampler->desc.filter == desc->filter && sampler->desc.wrap == desc->wrap && sampler->desc.anisotropy == desc->anisotropy) {
+            return sampler->id;
+        }
+    }
+
+    se_sampler* sampler = se_samplers_increment(&render_handle->samplers);
+    sampler->desc = *desc;
+    glGenSamplers(1, &sampler->id);
+    const b8 linear = desc->filter == SE_FILTER_LINEAR;
+    glSamplerParameteri(sampler->id, GL_TEXTURE_MIN_FILTER, linear ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST);
+    glSamplerParameteri(sampler->id, GL_TEXTURE_MAG_FILTER, linear ? GL_LINEAR : GL_NEAREST);
+    const GLint wrap = desc->wrap == SE_CLAMP ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+    glSamplerParameteri(sampler->id, GL_TEXTURE_WRAP_S, wrap);
+    glSamplerParameteri(sampler->id, GL_TEXTURE_WRAP_T, wrap);
+    if (desc->anisotropy > 1.0f) {
+        glSamplerParameterf(sampler->id, GL_TEXTURE_MAX_ANISOTROPY_EXT, min(desc->anisotropy, se_gl_caps.max_anisotropy));
+    }
+    return sampler->id;
+}
+
+void se_render_handle_reset_texture_bindings(se_render_handle* render_handle) {
+    for (u32 unit = 0; unit < SE_MAX_TEXTURE_UNITS; unit++) {
+        render_handle->bound_textures[unit] = ~0u;
+        render_handle->bound_targets[unit] = 0;
+        render_handle->bound_samplers[unit] = ~0u;
+    }
+}
+
+// Skips what is bound already, true when the active unit had to change
+static b8 se_render_handle_bind_texture(se_render_handle* render_handle, const u32 unit, const GLenum target, const GLuint texture, const GLuint sampler) {
+    se_assertf(unit < SE_MAX_TEXTURE_UNITS, "se_render_handle_bind_texture :: out of texture units");
+    b8 activated = false;
+    if (render_handle->bound_textures[unit] != texture || render_handle->bound_targets[unit] != target) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        render_handle->bound_textures[unit] = texture;
+        render_handle->bound_targets[unit] = target;
+        activated = true;
+    }
+    if (render_handle->bound_samplers[unit] != sampler) {
+        glBindSampler(unit, sampler);
+        render_handle->bound_samplers[unit] = sampler;
+    }
+    return activated;
+}
+
+// Texture array functions
+
+se_texture_array* se_texture_array_create(se_render_handle* render_handle, const i32 width, const i32 height, const u32 layers, const se_sampler_desc* sampler) {
+    se_assertf(width > 0 && height > 0 && layers > 0, "se_texture_array_create :: invalid size");
+    se_render_handle_reset_texture_bindings(render_handle);
+
+    se_texture_array* array = se_texture_arrays_increment(&render_handle->texture_arrays);
+    memset(array, 0, sizeof(se_texture_array));
+    array->width = width;
+    array->height = height;
+    array->layer_capacity = layers;
+    array->sampler = se_render_handle_get_sampler(render_handle, sampler);
+
+    // same chain as the cooked containers, down to 1x1
+    i32 level_width = width, level_height = height;
+    glGenTextures(1, &array->id);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, array->id);
+    while (true) {
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, array->level_count, GL_RGBA8, level_width, level_height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        array->level_count++;
+        if (level_width == 1 && level_height == 1) {
+            break;
+        }
+        level_width = max(level_width / 2, 1);
+        level_height = max(level_height / 2, 1);
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, array->level_count - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return array;
+}
+
+i32 se_texture_array_add(se_render_handle* render_handle, se_texture_array* array, const char* path) {
+    if (array->layer_count >= array->layer_capacity) {
+        fprintf(stderr, "se_texture_array_add :: array is full, %s not added\n", path);
+        return -1;
+    }
+    stbi_set_flip_vertically_on_load(1);
+
+    const c8 full_path[MAX_PATH_LENGTH] = RESOURCES_DIR;
+    strncat((c8*)full_path, path, MAX_PATH_LENGTH - strlen(full_path) - 1);
+
+    // layers are RGBA8, so the uncompressed container is used whatever the handle's compression setting
+    c8 cache_path[MAX_PATH_LENGTH] = {0};
+    sz size = 0;
+    u8* cooked = NULL;
+    b8 mapped = false;
+    if (se_texture_cache_get_path(cache_path, full_path, false) && (cooked = se_map_file(cache_path, &size))) {
+        mapped = se_texture_cache_validate(cooked, size, full_path);
+        if (!mapped) {
+            munmap(cooked, size);
+            cooked = NULL;
+        }
+    }
+    if (!cooked) {
+        cooked = se_texture_cook_file(full_path, cache_path, false, &size);
+    }
+    if (!cooked) {
+        fprintf(stderr, "se_texture_array_add :: could not load image %s\n", path);
+        return -1;
+    }
+
+    se_texture_cache_header header;
+    memcpy(&header, cooked, sizeof(header));
+    i32 layer = -1;
+    if (header.width != array->width || header.height != array->height || header.level_count != array->level_count) {
+        fprintf(stderr, "se_texture_array_add :: %s is %dx%d, the array is %dx%d\n", path, header.width, header.height, array->width, array->height);
+    } else {
+        layer = array->layer_count++;
+        const b8 rgba = header.format == SE_TEXTURE_FORMAT_RGBA8;
+        glBindTexture(GL_TEXTURE_2D_ARRAY, array->id);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (u32 level = 0; level < header.level_count; level++) {
+            const i32 width = max(header.width >> level, 1);
+            const i32 height = max(header.height >> level, 1);
+            const u8* pixels = cooked + header.level_offsets[level];
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1, rgba ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, pixels);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+
+    if (mapped) {
+        munmap(cooked, size);
+    } else {
+        free(cooked);
+    }
+    return layer;
+}
+
+void se_texture_array_cleanup(se_texture_array* array) {
+    glDeleteTextures(1, &array->id);
+    array->id = 0;
+    array->layer_count = 0;
+}
+
+static void se_shader_release_variants(se_shader* shader) {
+    for (u32 i = 0; i < shader->variant_count; i++) {
+        se_program_release(shader->variants[i].program);
+    }
+    shader->variant_count = 0;
+}
+
+// The previous program stays in use until the new one has linked, so a broken edit keeps the last good one on screen
+static void se_shader_set_program(se_shader* shader, se_program* program, const b8 reused) {
+    if (shader->shared_program) {
+        se_program_release(shader->shared_program);
+    }
+    shader->shared_program = program;
+    shader->program = program->id;
+    shader->vertex_mtime = get_file_mtime(shader->vertex_path);
+    shader->fragment_mtime = get_file_mtime(shader->fragment_path);
+    for (u32 i = 0; i < shader->dependencies.count; i++) {
+        shader->dependency_mtimes[i] = get_file_mtime(shader->dependencies.paths[i]);
+    }
+    shader->state = SE_ASSET_READY;
+    printf("Shader - created program: %d, from %s, %s%s\n", shader->program, shader->vertex_path, shader->fragment_path, reused ? " (reused)" : "");
+
+    // variants were built from the previous sources. The selected one keeps drawing while it is rebuilt in the
+    // background (and retried by the next reload if that fails)
+    se_program* selected = NULL;
+    if (shader->variant_defines[0] != '\0') {
+        const u64 key = se_hash(shader->variant_defines, strlen(shader->variant_defines), SE_HASH_SEED);
+        for (u32 i = 0; i < shader->variant_count; i++) {
+            if (shader->variants[i].key == key) {
+                selected = shader->variants[i].program;
+                shader->variants[i] = shader->variants[--shader->variant_count];
+                break;
+            }
+        }
+    }
+    se_shader_release_variants(shader);
+    if (selected) {
+        if (shader->previous_variant) {
+            se_program_release(shader->previous_variant);
+        }
+        shader->previous_variant = selected;
+    }
+    if (shader->previous_variant) {
+        shader->program = shader->previous_variant->id;
+    }
+    if (shader->variant_defines[0] != '\0') {
+        se_shader_build_variant_async(shader);
+    }
+}
+
+// Landed rebuild of the selected variant, the previous sources' one is dropped either way
+static void se_shader_finish_variant(se_shader* shader, const u64 key, se_program* program) {
+    b8 keep = se_program_finish(program);
+    if (!keep) {
+        fprintf(stderr, "Shader - variant [%s] of %s, %s failed, keeping the previous one\n", shader->variant_defines, shader->vertex_path, shader->fragment_path);
+        se_program_release(program);
+        return;
+    }
+    // se_shader_set_variant may have built it meanwhile
+    for (u32 i = 0; i < shader->variant_count && keep; i++) {
+        keep = shader->variants[i].key != key;
+    }
+    if (keep && shader->variant_count < SE_MAX_SHADER_VARIANTS) {
+        shader->variants[shader->variant_count++] = (se_shader_variant){ key, program };
+        if (shader->variant_defines[0] != '\0' && se_hash(shader->variant_defines, strlen(shader->variant_defines), SE_HASH_SEED) == key) {
+            shader->program = program->id;
+        }
+        printf("Shader - created variant program: %d, from %s, %s [%s]\n", program->id, shader->vertex_path, shader->fragment_path, shader->variant_defines);
+    } else {
+        se_program_release(program);
+    }
+    if (shader->previous_variant) {
+        se_program_release(shader->previous_variant);
+        shader->previous_variant = NULL;
+    }
+}
+
+static b8 se_shader_build(se_shader* shader, const c8* vertex_source, const c8* fragment_source) {
+    b8 cached = false;
+    se_program* program = se_program_acquire(shader->pool, vertex_source, fragment_source, &cached);
+    if (!program) {
+        return false;
+    }
+    if (!se_program_finish(program)) {
+        se_program_release(program);
+        return false;
+    }
+    se_shader_set_program(shader, program, cached);
+    return true;
+}
+
+// Compiles and links without waiting, se_render_handle_update_shader_builds swaps the program in once it has linked
+static b8 se_shader_build_async(se_shader* shader, const c8* vertex_source, const c8* fragment_source) {
+    b8 cached = false;
+    se_program* program = se_program_acquire(shader->pool, vertex_source, fragment_source, &cached);
+    if (!program) {
+        return false;
+    }
+    if (shader->pending_program) {
+        se_program_release(shader->pending_program); // superseded by a newer edit
+    }
+    shader->pending_program = program;
+    return true;
+}
+
+static void se_render_handle_update_shader_builds(se_render_handle* render_handle) {
+    se_foreach(se_shaders, render_handle->shaders, i) {
+        se_shader* shader = se_shaders_get(&render_handle->shaders, i);
+        se_program* program = shader->pending_program;
+        if (program && se_program_is_complete(program, render_handle->frame)) {
+            shader->pending_program = NULL;
+            if (se_program_finish(program)) {
+                se_shader_set_program(shader, program, false);
+            } else {
+                se_program_release(program);
+                if (shader->state == SE_ASSET_PENDING) {
+                    shader->state = SE_ASSET_FAILED;
+                } else {
+                    fprintf(stderr, "Shader - keeping the previous program of %s, %s\n", shader->vertex_path, shader->fragment_path);
+                }
+            }
+        }
+        se_program* variant = shader->pending_variant.program;
+        if (variant && se_program_is_complete(variant, render_handle->frame)) {
+            shader->pending_variant.program = NULL;
+            se_shader_finish_variant(shader, shader->pending_variant.key, variant);
+        }
+    }
+}
+
+// Runs both stages through the preprocessor, files included by either are added to out_dependencies once
+static b8 se_shader_preprocess(const c8* vertex_path, const c8* fragment_path, const c8* defines, c8** out_vertex_source, c8** out_fragment_source, se_glsl_dependencies* out_dependencies) {
+    // each stage expands its includes on its own, a file shared by both is still included in both
+    se_glsl_dependencies vertex_dependencies = {0};
+    se_glsl_dependencies fragment_dependencies = {0};
+    *out_vertex_source = se_glsl_preprocess(vertex_path, defines, &vertex_dependencies);
+    *out_fragment_source = se_glsl_preprocess(fragment_path, defines, &fragment_dependencies);
+    if (!*out_vertex_source || !*out_fragment_source) {
+        free(*out_vertex_source);
+        free(*out_fragment_source);
+        *out_vertex_source = NULL;
+        *out_fragment_source = NULL;
+        return false;
+    }
+    *out_dependencies = vertex_dependencies;
+    for (u32 i = 0; i < fragment_dependencies.count; i++) {
+        u32 index = 0;
+        while (index < out_dependencies->count && strcmp(out_dependencies->paths[index], fragment_dependencies.paths[i]) != 0) {
+            index++;
+        }
+        if (index == out_dependencies->count && index < SE_GLSL_MAX_DEPENDENCIES) {
+            memcpy(out_dependencies->paths[out_dependencies->count++], fragment_dependencies.paths[i], MAX_PATH_LENGTH);
+        }
+    }
+    return true;
+}
+
+static b8 se_shader_read_sources(se_shader* shader, const c8* defines, c8** out_vertex_source, c8** out_fragment_source) {
+    se_glsl_dependencies dependencies = {0};
+    if (!se_shader_preprocess(shader->vertex_path, shader->fragment_path, defines, out_vertex_source, out_fragment_source, &dependencies)) {
+        return false;
+    }
+    shader->dependencies = dependencies;
+    shader->watch_dependencies = dependencies.count > 0;
+    return true;
+}
+
+b8 se_shader_load_internal(se_shader* shader) {
+   
+    assert(shader);
+
+    c8* vertex_source = NULL;
+    c8* fragment_source = NULL;
+    if (!se_shader_read_sources(shader, NULL, &vertex_source, &fragment_source)) {
+        return false;
+    }
+    const b8 success = se_shader_build(shader, vertex_source, fragment_source);
+    free(vertex_source);
+    free(fragment_source);
+    return success;
+}
+
+// Selected variant from the current sources, se_render_handle_update_shader_builds swaps it in once it has linked
+static b8 se_shader_build_variant_async(se_shader* shader) {
+    c8* vertex_source = NULL;
+    c8* fragment_source = NULL;
+    if (!se_shader_read_sources(shader, shader->variant_defines, &vertex_source, &fragment_source)) {
+        return false;
+    }
+    b8 cached = false;
+    se_program* program = se_program_acquire(shader->pool, vertex_source, fragment_source, &cached);
+    free(vertex_source);
+    free(fragment_source);
+    if (!program) {
+        return false;
+    }
+    if (shader->pending_variant.program) {
+        se_program_release(shader->pending_variant.program); // superseded by a newer edit
+    }
+    shader->pending_variant = (se_shader_variant){ se_hash(shader->variant_defines, strlen(shader->variant_defines), SE_HASH_SEED), program };
+    return true;
+}
+
+// Hot reload, the frame keeps drawing with the current program while the new one compiles
+static b8 se_shader_rebuild(se_shader* shader) {
+    c8* vertex_source = NULL;
+    c8* fragment_source = NULL;
+    if (!se_shader_read_sources(shader, NULL, &vertex_source, &fragment_source)) {
+        return false;
+    }
+    const b8 success = se_shader_build_async(shader, vertex_source, fragment_source);
+    free(vertex_source);
+    free(fragment_source);
+    return success;
+}
+
+static void se_shader_set_paths(se_shader* shader, const char* vertex_file_path, const char* fragment_file_path) {
+    // make path absolute
+    char* new_vertex_path = NULL;
+    char* new_fragment_path = NULL;
+    
+    if (strlen(vertex_file_path) > 0) {
+        new_vertex_path = malloc(strlen(RESOURCES_DIR) + strlen(vertex_file_path) + 1);
+        strcpy(new_vertex_path, RESOURCES_DIR);
+        strcat(new_vertex_path, vertex_file_path);
+    }
+    
+    if (strlen(fragment_file_path) > 0) {
+        new_fragment_path = malloc(strlen(RESOURCES_DIR) + strlen(fragment_file_path) + 1);
+        strcpy(new_fragment_path, RESOURCES_DIR);
+        strcat(new_fragment_path, fragment_file_path);
+    }
+
+    strcpy(shader->vertex_path, new_vertex_path);
+    strcpy(shader->fragment_path, new_fragment_path);
+    free(new_vertex_path);
+    free(new_fragment_path);
+}
+
+se_shader* se_shader_load(se_render_handle* render_handle, const char* vertex_file_path, const char* fragment_file_path) {
+    se_shader* new_shader = se_shaders_increment(&render_handle->shaders);
+    se_shader_set_paths(new_shader, vertex_file_path, fragment_file_path);
+    new_shader->pool = &render_handle->program_pool;
+    new_shader->state = SE_ASSET_READY;
+    se_render_handle_watch_file(render_handle, new_shader->vertex_path);
+    se_render_handle_watch_file(render_handle, new_shader->fragment_path);
+    if (se_shader_load_internal(new_shader)) {
+        return new_shader;
+    }
+    return NULL;
+}
+
+typedef struct {
+    se_job job;
+    se_shader* shader;
+    c8* vertex_source;
+    c8* fragment_source;
+    se_glsl_dependencies dependencies;
+} se_shader_load_job;
+
+static void se_shader_load_job_run(se_job* job) {
+    se_shader_load_job* load = (se_shader_load_job*)job;
+    se_shader_preprocess(load->shader->vertex_path, load->shader->fragment_path, NULL, &load->vertex_source, &load->fragment_source, &load->dependencies);
+}
+
+static void se_shader_load_job_finish(se_job* job, const b8 cancelled) {
+    se_shader_load_job* load = (se_shader_load_job*)job;
+    se_shader* shader = load->shader;
+    if (!cancelled && shader->state == SE_ASSET_PENDING) {
+        shader->dependencies = load->dependencies;
+        shader->watch_dependencies = load->dependencies.count > 0;
+        if (!load->vertex_source || !load->fragment_source || !se_shader_build_async(shader, load->vertex_source, load->fragment_source)) {
+            shader->state = SE_ASSET_FAILED;
+        }
+    }
+    free(load->vertex_source);
+    free(load->fragment_source);
+    free(load);
+}
+
+// Program stays 0 until it is compiled on the context thread, meshes using it are skipped until then
+se_shader* se_shader_load_async(se_render_handle* render_handle, const char* vertex_file_path, const char* fragment_file_path) {
+    se_shader* new_shader = se_shaders_increment(&render_handle->shaders);
+    se_shader_set_paths(new_shader, vertex_file_path, fragment_file_path);
+    new_shader->pool = &render_handle->program_pool;
+    new_shader->program = 0;
+    new_shader->state = SE_ASSET_PENDING;
+    se_render_handle_watch_file(render_handle, new_shader->vertex_path);
+    se_render_handle_watch_file(render_handle, new_shader->fragment_path);
+
+    se_shader_load_job* load = malloc(sizeof(se_shader_load_job));
+    memset(load, 0, sizeof(se_shader_load_job));
+    load->job.run = se_shader_load_job_run;
+    load->job.finish = se_shader_load_job_finish;
+    load->shader = new_shader;
+    se_worker_pool_submit(se_render_handle_get_loader(render_handle), &load->job);
+    return new_shader;
+}
+
+// Generated into the cache as a file including every stage, so their reloads rebuild it through the dependencies
+se_shader* se_shader_load_fused(se_render_handle* render_handle, se_shader** stages, const u32 count) {
+    if (count == 0 || count > SE_GLSL_MAX_FUSED_STAGES) {
+        fprintf(stderr, "se_shader_load_fused :: %u stages, max is %d\n", count, SE_GLSL_MAX_FUSED_STAGES);
+        return NULL;
+    }
+    const c8* paths[SE_GLSL_MAX_FUSED_STAGES];
+    u64 key = se_hash(stages[0]->vertex_path, strlen(stages[0]->vertex_path), SE_HASH_SEED);
+    for (u32 i = 0; i < count; i++) {
+        paths[i] = stages[i]->fragment_path;
+        key = se_hash(paths[i], strlen(paths[i]), key);
+    }
+    c8 fragment_path[MAX_PATH_LENGTH];
+    if (!se_cache_get_path(fragment_path, key, "glsl")) {
+        fprintf(stderr, "se_shader_load_fused :: could not create cache directory\n");
+        return NULL;
+    }
+    // failed builds and released shaders leave their slot empty, for the next fused shader
+    se_shader* new_shader = NULL;
+    se_foreach(se_shaders, render_handle->shaders, i) {
+        se_shader* shader = se_shaders_get(&render_handle->shaders, i);
+        if (shader->ref_count > 0 && shader->state != SE_ASSET_FAILED &&
+            strcmp(shader->fragment_path, fragment_path) == 0 && strcmp(shader->vertex_path, stages[0]->vertex_path) == 0) {
+            shader->ref_count++;
+            return shader;
+        }
+        if (new_shader == NULL && shader->ref_count == 0 && shader->fragment_path[0] == '\0' && shader->vertex_path[0] == '\0') {
+            new_shader = shader;
+        }
+    }
+    if (new_shader == NULL && (new_shader = se_shaders_increment(&render_handle->shaders)) == NULL) {
+        fprintf(stderr, "se_shader_load_fused :: out of shader slots\n");
+        return NULL;
+    }
+    memset(new_shader, 0, sizeof(se_shader));
+
+    c8* source = se_glsl_fuse_pointwise(paths, count);
+    if (source == NULL) {
+        return NULL;
+    }
+    FILE* file = fopen(fragment_path, "wb");
+    const b8 written = file && fwrite(source, 1, strlen(source), file) == strlen(source);
+    if (file) {
+        fclose(file);
+    }
+    free(source);
+    if (!written) {
+        fprintf(stderr, "se_shader_load_fused :: could not write %s\n", fragment_path);
+        return NULL;
+    }
+
+    strcpy(new_shader->vertex_path, stages[0]->vertex_path);
+    strcpy(new_shader->fragment_path, fragment_path);
+    new_shader->pool = &render_handle->program_pool;
+    new_shader->state = SE_ASSET_READY;
+    if (!se_shader_load_internal(new_shader)) {
+        se_shader_cleanup(new_shader);
+        memset(new_shader, 0, sizeof(se_shader));
+        return NULL;
+    }
+    new_shader->ref_count = 1;
+    se_render_handle_watch_file(render_handle, new_shader->vertex_path);
+    se_render_handle_watch_file(render_handle, new_shader->fragment_path);
+    return new_shader;
+}
+
+void se_shader_release_fused(se_shader* shader) {
+    if (shader->ref_count == 0 || --shader->ref_count > 0) {
+        return;
+    }
+    se_shader_cleanup(shader);
+    memset(shader, 0, sizeof(se_shader)); // free for the next se_shader_load_fused
+}
+
+b8 se_shader_reload_if_changed(se_shader* shader) {
+    if (strlen(shader->vertex_path) == 0 || strlen(shader->fragment_path) == 0 || shader->state == SE_ASSET_PENDING) {
+        return false;
+    }
+    
+    time_t vertex_mtime = get_file_mtime(shader->vertex_path);
+    time_t fragment_mtime = get_file_mtime(shader->fragment_path);
+    b8 changed = vertex_mtime != shader->vertex_mtime || fragment_mtime != shader->fragment_mtime;
+    for (u32 i = 0; i < shader->dependencies.count; i++) {
+        const time_t dependency_mtime = get_file_mtime(shader->dependencies.paths[i]);
+        changed |= dependency_mtime != shader->dependency_mtimes[i];
+        shader->dependency_mtimes[i] = dependency_mtime;
+    }
+    
+    if (changed) {
+        printf("Reloading shader: %s, %s\n", shader->vertex_path, shader->fragment_path);
+        // a broken edit is not retried until the next one
+        shader->vertex_mtime = vertex_mtime;
+        shader->fragment_mtime = fragment_mtime;
+        return se_shader_rebuild(shader);
+    }
+    
+    return false;
+}
+
+// Variants are compiled the first time they are selected and kept until the sources change. The selection
+// survives reloads, before the base program is built it is only recorded
+b8 se_shader_set_variant(se_shader* shader, const c8* defines) {
+    if (defines == NULL || defines[0] == '\0') {
+        shader->variant_defines[0] = '\0';
+        shader->program = shader->shared_program ? shader->shared_program->id : 0;
+        return true;
+    }
+    const sz length = strlen(defines);
+    if (length >= SE_MAX_SHADER_DEFINES_LENGTH) {
+        fprintf(stderr, "se_shader_set_variant :: defines too long, max is %d\n", SE_MAX_SHADER_DEFINES_LENGTH - 1);
+        return false;
+    }
+    if (shader->shared_program == NULL) {
+        // built along with the base program
+        memcpy(shader->variant_defines, defines, length + 1);
+        return false;
+    }
+
+    const u64 key = se_hash(defines, length, SE_HASH_SEED);
+    for (u32 i = 0; i < shader->variant_count; i++) {
+        if (shader->variants[i].key == key) {
+            memcpy(shader->variant_defines, defines, length + 1);
+            shader->program = shader->variants[i].program->id;
+            return true;
+        }
+    }
+    if (shader->variant_count == SE_MAX_SHADER_VARIANTS) {
+        fprintf(stderr, "se_shader_set_variant :: too many variants of %s, %s, max is %d\n", shader->vertex_path, shader->fragment_path, SE_MAX_SHADER_VARIANTS);
+        return false;
+    }
+
+    c8* vertex_source = NULL;
+    c8* fragment_source = NULL;
+    if (!se_shader_read_sources(shader, defines, &vertex_source, &fragment_source)) {
+        return false;
+    }
+    b8 cached = false;
+    se_program* program = se_program_acquire(shader->pool, vertex_source, fragment_source, &cached);
+    free(vertex_source);
+    free(fragment_source);
+    if (!program) {
+        return false;
+    }
+    if (!se_program_finish(program)) {
+        se_program_release(program);
+        return false;
+    }
+    se_shader_variant* variant = &shader->variants[shader->variant_count++];
+    variant->key = key;
+    variant->program = program;
+    memcpy(shader->variant_defines, defines, length + 1);
+    shader->program = program->id;
+    printf("Shader - created variant program: %d, from %s, %s [%s]%s\n", program->id, shader->vertex_path, shader->fragment_path, defines, cached ? " (reused)" : "");
+    return true;
+}
+
+void se_shader_use(se_render_handle* render_handle, se_shader* shader, const b8 update_uniforms, const b8 update_global_uniforms) {
+    glUseProgram(shader->program);
+    if (update_uniforms) {
+        se_uniform_apply(render_handle, shader, update_global_uniforms);
+    }
+}
+
+void se_shader_cleanup(se_shader* shader) {
+    se_shader_release_variants(shader);
+    shader->variant_defines[0] = '\0';
+    if (shader->pending_variant.program) {
+        se_program_release(shader->pending_variant.program);
+        shader->pending_variant.program = NULL;
+    }
+    if (shader->previous_variant) {
+        se_program_release(shader->previous_variant);
+        shader->previous_variant = NULL;
+    }
+    if (shader->pending_program) {
+        se_program_release(shader->pending_program);
+        shader->pending_program = NULL;
+    }
+    if (shader->shared_program) {
+        se_program_release(shader->shared_program);
+        shader->shared_program = NULL;
+    }
+    shader->program = 0;
+    shader->state = SE_ASSET_READY;
+}
+
+GLuint se_shader_get_uniform_location(se_shader* shader, const char* name) {
+    return glGetUniformLocation(shader->program, name);
+}
+
+void se_shader_set_float(se_shader* shader, const char* name, f32 value){
+    se_uniform_set_float(&shader->uniforms, name, value);
+}
+
+void se_shader_set_vec2(se_shader* shader, const char* name, const se_vec2* value){
+    se_uniform_set_vec2(&shader->uniforms, name, value);
+}
+
+void se_shader_set_vec3(se_shader* shader, const char* name, const se_vec3* value){
+    se_uniform_set_vec3(&shader->uniforms, name, value);
+}
+
+void se_shader_set_vec4(se_shader* shader, const char* name, const se_vec4* value){
+    se_uniform_set_vec4(&shader->uniforms, name, value);
+}
+
+void se_shader_set_int(se_shader* shader, const char* name, i32 value){
+    se_uniform_set_int(&shader->uniforms, name, value);
+}
+
+void se_shader_set_texture(se_shader* shader, const char* name, GLuint texture){
+    se_uniform_set_texture(&shader->uniforms, name, texture);
+}
+
+void se_shader_set_texture_ref(se_shader* shader, const char* name, se_texture* texture){
+    se_uniform_set_texture_ref(&shader->uniforms, name, texture);
+}
+
+void se_shader_set_texture_region(se_shader* shader, const char* name, se_texture* texture){
+    se_uniform_set_texture_region(&shader->uniforms, name, texture);
+}
+
+void se_shader_set_texture_array(se_shader* shader, const char* name, const se_texture_array* array){
+    se_uniform_set_texture_array(&shader->uniforms, name, array);
+}
+
+b8 se_shader_bind_uniform_block(se_render_handle* render_handle, se_shader* shader, const char* name, const u32 binding, const void* data, const sz size){
+    const GLuint block_index = glGetUniformBlockIndex(shader->program, name);
+    if (block_index == GL_INVALID_INDEX) {
+        return false;
+    }
+    se_ring_buffer* ring = se_render_handle_get_dynamic_data(render_handle);
+    sz offset = 0;
+    void* block = se_ring_buffer_alloc(ring, size, max(se_gl_caps.uniform_buffer_alignment, 1), &offset);
+    if (!block) {
+        return false;
+    }
+    memcpy(block, data, size);
+    se_ring_buffer_flush(ring);
+    glUniformBlockBinding(shader->program, block_index, binding);
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, ring->buffer, offset, size);
+    return true;
+}
+
+void se_shader_set_buffer_texture(se_shader* shader, const char* name, se_render_buffer* buffer){
+    se_uniform_set_buffer_texture(&shader->uniforms, name, buffer);
+}
+
+// Mesh functions
+void se_mesh_translate(se_mesh* mesh, const se_vec3* v){
+    mesh->matrix = mat4_mul(mesh->matrix, mat4_translate(v));
+}
+
+void se_mesh_rotate(se_mesh* mesh, const se_vec3* v){
+    mesh->matrix = mat4_mul(mesh->matrix, mat4_rotate_x(mat4_identity(), v->x));
+    mesh->matrix = mat4_mul(mesh->matrix, mat4_rotate_y(mat4_identity(), v->y));
+    mesh->matrix = mat4_mul(mesh->matrix, mat4_rotate_z(mat4_identity(), v->z));
+}
+
+void se_mesh_scale(se_mesh* mesh, const se_vec3* v){
+    mesh->matrix = mat4_mul(mesh->matrix, mat4_scale(v));
+}
+
+// Mesh pool functions
+static b8 se_pool_ranges_take(se_pool_ranges* free_ranges, const u32 count, u32* out_offset) {
+    se_foreach(se_pool_ranges, *free_ranges, i) {
+        se_pool_range* range = se_pool_ranges_get(free_ranges, i);
+        if (range->count >= count) {
+            *out_offset = range->offset;
+            range->offset += count;
+            range->count -= count;
+            if (range->count == 0) {
+                se_pool_ranges_remove_at(free_ranges, i);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+static void se_pool_ranges_release(se_pool_ranges* free_ranges, u32* high_water, const u32 offset, const u32 count) {
+    if (count == 0) {
+        return;
+    }
+    if (offset + count == *high_water) {
+        *high_water = offset;
+        // give back any free range that now touches the end
+        while (se_pool_ranges_get_size(free_ranges) > 0) {
+            se_pool_range* last = se_pool_ranges_get(free_ranges, se_pool_ranges_get_size(free_ranges) - 1);
+            if (last->offset + last->count != *high_water) {
+                break;
+            }
+            *high_water = last->offset;
+            se_pool_ranges_remove_at(free_ranges, se_pool_ranges_get_size(free_ranges) - 1);
+        }
+        return;
+    }
+
+    // keep the list sorted by offset and merge neighbours
+    sz insert_at = 0;
+    while (insert_at < se_pool_ranges_get_size(free_ranges) && se_pool_ranges_get(free_ranges, insert_at)->offset < offset) {
+        insert_at++;
+    }
+    if (insert_at > 0) {
+        se_pool_range* prev = se_pool_ranges_get(free_ranges, insert_at - 1);
+        if (prev->offset + prev->count == offset) {
+            prev->count += count;
+            if (insert_at < se_pool_ranges_get_size(free_ranges)) {
+                se_pool_range* next = se_pool_ranges_get(free_ranges, insert_at);
+                if (prev->offset + prev->count == next->offset) {
+                    prev->count += next->count;
+                    se_pool_ranges_remove_at(free_ranges, insert_at);
+                }
+            }
+            return;
+        }
+    }
+    if (insert_at < se_pool_ranges_get_size(free_ranges)) {
+        se_pool_range* next = se_pool_ranges_get(free_ranges, insert_at);
+        if (offset + count == next->offset) {
+            next->offset = offset;
+            next->count += count;
+            return;
+        }
+    }
+    if (se_pool_ranges_increment(free_ranges) == NULL) {
+        fprintf(stderr, "se_pool_ranges_release :: free list is full, leaking %u elements\n", count);
+        return;
+    }
+    memmove(&free_ranges->data[insert_at + 1], &free_ranges->data[insert_at], sizeof(se_pool_range) * (free_ranges->size - insert_at - 1));
+    free_ranges->data[insert_at] = (se_pool_range){ offset, count };
+}
+
+static void se_mesh_pool_setup_vao(se_mesh_pool* pool) {
+    glBindVertexArray(pool->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, pool->vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pool->ebo);
+
+    // Position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(se_vertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    
+    // Normal attribute
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(se_vertex), (void*)offsetof(se_vertex, normal));
+    glEnableVertexAttribArray(1);
+    
+    // UV attribute
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(se_vertex), (void*)offsetof(se_vertex, uv));
+    glEnableVertexAttribArray(2);
+
+    // Draw id attribute, one per instance and offset by the base instance of each indirect command.
+    // Without multi draw indirect the array stays disabled and the draw id is set as a constant attribute per draw.
+    glBindBuffer(GL_ARRAY_BUFFER, pool->draw_id_buffer);
+    glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(u32), (void*)0);
+    glVertexAttribDivisor(3, 1);
+    if (se_gl_caps.multi_draw_indirect) {
+        glEnableVertexAttribArray(3);
+    } else {
+        glDisableVertexAttribArray(3);
+    }
+
+    glBindVertexArray(0);
+}
+
+static void se_mesh_pool_init(se_mesh_pool* pool) {
+    pool->vertex_capacity = SE_MESH_POOL_MIN_VERTICES;
+    pool->index_capacity = SE_MESH_POOL_MIN_INDICES;
+
+    glGenVertexArrays(1, &pool->vao);
+    glGenBuffers(1, &pool->vbo);
+    glGenBuffers(1, &pool->ebo);
+    glGenBuffers(1, &pool->draw_id_buffer);
+
+    glBindBuffer(GL_ARRAY_BUFFER, pool->vbo);
+    glBufferData(GL_ARRAY_BUFFER, pool->vertex_capacity * sizeof(se_vertex), NULL, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, pool->ebo);
+    glBufferData(GL_ARRAY_BUFFER, pool->index_capacity * sizeof(u32), NULL, GL_STATIC_DRAW);
+
+    u32* draw_ids = malloc(SE_MAX_DRAW_IDS * sizeof(u32));
+    for (u32 i = 0; i < SE_MAX_DRAW_IDS; i++) {
+        draw_ids[i] = i;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, pool->draw_id_buffer);
+    glBufferData(GL_ARRAY_BUFFER, SE_MAX_DRAW_IDS * sizeof(u32), draw_ids, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    free(draw_ids);
+
+    se_mesh_pool_setup_vao(pool);
+}
+
+static void se_mesh_pool_grow_buffer(GLuint* buffer, const sz used_size, const sz new_size) {
+    GLuint new_buffer = 0;
+    glGenBuffers(1, &new_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, new_buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, new_size, NULL, GL_STATIC_DRAW);
+    if (used_size > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, *buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used_size);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, buffer);
+    *buffer = new_buffer;
+}
+
+static void se_mesh_pool_alloc(se_mesh_pool* pool, const u32 vertex_count, const u32 index_count, u32* out_base_vertex, u32* out_first_index) {
+    if (pool->vao == 0) {
+        se_mesh_pool_init(pool);
+    }
+
+    b8 grown = false;
+    if (!se_pool_ranges_take(&pool->free_vertices, vertex_count, out_base_vertex)) {
+        if (pool->vertex_count + vertex_count > pool->vertex_capacity) {
+            const u32 new_capacity = max(pool->vertex_capacity * 2, pool->vertex_count + vertex_count);
+            se_mesh_pool_grow_buffer(&pool->vbo, pool->vertex_count * sizeof(se_vertex), new_capacity * sizeof(se_vertex));
+            pool->vertex_capacity = new_capacity;
+            grown = true;
+        }
+        *out_base_vertex = pool->vertex_count;
+        pool->vertex_count += vertex_count;
+    }
+    if (!se_pool_ranges_take(&pool->free_indices, index_count, out_first_index)) {
+        if (pool->index_count + index_count > pool->index_capacity) {
+            const u32 new_capacity = max(pool->index_capacity * 2, pool->index_count + index_count);
+            se_mesh_pool_grow_buffer(&pool->ebo, pool->index_count * sizeof(u32), new_capacity * sizeof(u32));
+            pool->index_capacity = new_capacity;
+            grown = true;
+        }
+        *out_first_index = pool->index_count;
+        pool->index_count += index_count;
+    }
+    if (grown) {
+        se_mesh_pool_setup_vao(pool);
+    }
+}
+
+static void se_mesh_pool_free(se_mesh_pool* pool, const u32 base_vertex, const u32 vertex_count, const u32 first_index, const u32 index_count) {
+    se_pool_ranges_release(&pool->free_vertices, &pool->vertex_count, base_vertex, vertex_count);
+    se_pool_ranges_release(&pool->free_indices, &pool->index_count, first_index, index_count);
+}
+
+void se_mesh_pool_cleanup(se_mesh_pool* pool) {
+    if (pool->vao) {
+        glDeleteVertexArrays(1, &pool->vao);
+        glDeleteBuffers(1, &pool->vbo);
+        glDeleteBuffers(1, &pool->ebo);
+        glDeleteBuffers(1, &pool->draw_id_buffer);
+    }
+    memset(pool, 0, sizeof(se_mesh_pool));
+}
+
+static se_shader* se_mesh_pick_shader(se_shaders_ptr* shaders, const u32 se_mesh_index) {
+    // cycle through available shaders
+    if (se_shaders_ptr_get_size(shaders) > 0) {
+        return *se_shaders_ptr_get(shaders, se_mesh_index % se_shaders_ptr_get_size(shaders));
+    }
+    fprintf(stderr, "No shaders provided for mesh %u\n", se_mesh_index);
+    return NULL;
+}
+
+// Uploads into the mesh pool, the source doesn't have to be mesh->vertices/indices (e.g. a mapped glTF buffer)
+static se_mesh_pool* se_mesh_allocate(se_render_handle* render_handle, se_mesh* mesh) {
+    se_mesh_pool* pool = &render_handle->mesh_pool;
+    se_mesh_pool_alloc(pool, mesh->vertex_count, mesh->index_count, &mesh->base_vertex, &mesh->first_index);
+    mesh->pool = pool;
+    mesh->vao = pool->vao;
+    return pool;
+}
+
+static void se_mesh_upload(se_render_handle* render_handle, se_mesh* mesh, const se_vertex* vertices, const u32* indices) {
+    se_mesh_pool* pool = se_mesh_allocate(render_handle, mesh);
+
+    if (se_gl_caps.direct_state_access) {
+        glNamedBufferSubData(pool->vbo, mesh->base_vertex * sizeof(se_vertex), mesh->vertex_count * sizeof(se_vertex), vertices);
+        glNamedBufferSubData(pool->ebo, mesh->first_index * sizeof(u32), mesh->index_count * sizeof(u32), indices);
+        return;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, pool->vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, mesh->base_vertex * sizeof(se_vertex), mesh->vertex_count * sizeof(se_vertex), vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, pool->ebo);
+    glBufferSubData(GL_ARRAY_BUFFER, mesh->first_index * sizeof(u32), mesh->index_count * sizeof(u32), indices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+static void se_mesh_set_lods(se_mesh* mesh, const se_mesh_lod* lods, const u32 lod_count) {
+    mesh->lods = malloc(lod_count * sizeof(se_mesh_lod));
+    memcpy(mesh->lods, lods, lod_count * sizeof(se_mesh_lod));
+    mesh->lod_count = lod_count;
+    mesh->current_lod = 0;
+}
+
+static void se_mesh_set_bounds(se_mesh* mesh, const se_vec3 bounds_min, const se_vec3 bounds_max) {
+    mesh->bounds_center = vec3_scale(vec3_add(bounds_min, bounds_max), 0.5f);
+    mesh->bounds_radius = vec3_length(vec3_sub(bounds_max, mesh->bounds_center));
+}
+
+// Builds bounds, clusters and levels of detail from mesh->vertices/indices
+static void se_mesh_process(se_mesh* mesh) {
+    // Bounding sphere (center of the box, radius to the farthest vertex)
+    se_vec3 bounds_min = mesh->vertex_count > 0 ? mesh->vertices[0].position : (se_vec3){0};
+    se_vec3 bounds_max = bounds_min;
+    for (u32 i = 1; i < mesh->vertex_count; i++) {
+        const se_vec3* p = &mesh->vertices[i].position;
+        bounds_min = (se_vec3){ min(bounds_min.x, p->x), min(bounds_min.y, p->y), min(bounds_min.z, p->z) };
+        bounds_max = (se_vec3){ max(bounds_max.x, p->x), max(bounds_max.y, p->y), max(bounds_max.z, p->z) };
+    }
+    se_mesh_set_bounds(mesh, bounds_min, bounds_max);
+    mesh->bounds_radius = 0.0f;
+    for (u32 i = 0; i < mesh->vertex_count; i++) {
+        mesh->bounds_radius = max(mesh->bounds_radius, vec3_length(vec3_sub(mesh->vertices[i].position, mesh->bounds_center)));
+    }
+
+    // Large meshes are split into clusters (reorders mesh->indices) so the draw list can cull parts of them
+    mesh->clusters = NULL;
+    mesh->cluster_count = 0;
+    if (mesh->index_count / 3 >= SE_CLUSTER_MIN_MESH_TRIANGLES) {
+        mesh->cluster_count = se_geometry_build_clusters(mesh->vertices, mesh->vertex_count, mesh->indices, mesh->index_count, &mesh->clusters);
+    }
+
+    // Simplified levels are appended after the full detail indices
+    se_mesh_lod lods[SE_MAX_MESH_LODS];
+    const u32 lod_count = se_geometry_build_lods(mesh->vertices, mesh->vertex_count, &mesh->indices, &mesh->index_count, mesh->bounds_radius, lods);
+    se_mesh_set_lods(mesh, lods, lod_count);
+}
+
+// Helper function to finalize a mesh (CPU side only, se_model_upload puts it on the GPU)
+void finalize_mesh(se_mesh* mesh, se_vertex* vertices, u32* indices, u32 vertex_count, u32 index_count) {
+// Allocate mesh data
+    mesh->vertices = malloc(vertex_count * sizeof(se_vertex));
+    mesh->indices = malloc(index_count * sizeof(u32));
     memcpy(mesh->vertices, vertices, vertex_count * sizeof(se_vertex));
     memcpy(mesh->indices, indices, index_count * sizeof(u32));
     mesh->vertex_count = vertex_count;
     mesh->index_count = index_count;
-    mesh->matrix = mat4_identity();
-    
-    // Assign shader (cycle through available shaders)
-    if (se_shaders_ptr_get_size(shaders) > 0) {
-        mesh->shader = *se_shaders_ptr_get(shaders, se_mesh_index % se_shaders_ptr_get_size(shaders));
+    mesh->matrix = mat4_identity();
+    mesh->shader = NULL;
+    mesh->pool = NULL;
+
+    se_mesh_process(mesh);
+}
+
+// Picks shaders, uploads every mesh and applies the residency policy
+static void se_model_upload(se_render_handle* render_handle, se_model* model, se_shaders_ptr* shaders) {
+    se_foreach(se_meshes, model->meshes, i) {
+        se_mesh* mesh = se_meshes_get(&model->meshes, i);
+        mesh->shader = se_mesh_pick_shader(shaders, i);
+        se_mesh_upload(render_handle, mesh, mesh->vertices, mesh->indices);
+    }
+    se_model_set_residency(model, model->residency);
+}
+
+// Cooked model cache, stores processed meshes (clusters and levels of detail included) so imports run once
+#define SE_MESH_CACHE_MAGIC 0x434d4553 // "SEMC"
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 mesh_count;
+    u64 source_stamp; // se_cache_source_stamp when cooked, stale once it differs
+} se_mesh_cache_header;
+
+typedef struct {
+    u32 vertex_count;
+    u32 index_count;
+    u32 cluster_count;
+    u32 lod_count;
+    se_vec3 bounds_center;
+    f32 bounds_radius;
+    se_mesh_lod lods[SE_MAX_MESH_LODS];
+} se_mesh_cache_entry;
+
+static u64 se_model_cache_key(const c8* full_path) {
+    return se_cache_key(full_path, SE_MESH_CACHE_VERSION);
+}
+
+static b8 se_model_cache_load(se_model* model, const c8* cache_path, const u64 source_stamp) {
+    FILE* file = fopen(cache_path, "rb");
+    if (!file) {
+        return false;
+    }
+    se_mesh_cache_header header = {0};
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != SE_MESH_CACHE_MAGIC ||
+        header.version != SE_MESH_CACHE_VERSION || header.source_stamp != source_stamp || header.mesh_count == 0 || header.mesh_count > SE_MAX_MESHES) {
+        fclose(file);
+        return false;
+    }
+
+    for (u32 i = 0; i < header.mesh_count; i++) {
+        se_mesh_cache_entry entry = {0};
+        if (fread(&entry, sizeof(entry), 1, file) != 1 || entry.lod_count == 0 || entry.lod_count > SE_MAX_MESH_LODS) {
+            break;
+        }
+        se_mesh* mesh = se_meshes_increment(&model->meshes);
+        mesh->vertex_count = entry.vertex_count;
+        mesh->index_count = entry.index_count;
+        mesh->cluster_count = entry.cluster_count;
+        mesh->bounds_center = entry.bounds_center;
+        mesh->bounds_radius = entry.bounds_radius;
+        se_mesh_set_lods(mesh, entry.lods, entry.lod_count);
+        mesh->vertices = malloc(entry.vertex_count * sizeof(se_vertex));
+        mesh->indices = malloc(entry.index_count * sizeof(u32));
+        mesh->clusters = entry.cluster_count > 0 ? malloc(entry.cluster_count * sizeof(se_mesh_cluster)) : NULL;
+        if (fread(mesh->vertices, sizeof(se_vertex), entry.vertex_count, file) != entry.vertex_count ||
+            fread(mesh->indices, sizeof(u32), entry.index_count, file) != entry.index_count ||
+            fread(mesh->clusters, sizeof(se_mesh_cluster), entry.cluster_count, file) != entry.cluster_count) {
+            free(mesh->vertices);
+            free(mesh->indices);
+            free(mesh->clusters);
+            free(mesh->lods);
+            se_meshes_remove_at(&model->meshes, se_meshes_get_size(&model->meshes) - 1);
+            break;
+        }
+        mesh->pool = NULL;
+        mesh->matrix = mat4_identity();
+        mesh->shader = NULL;
+    }
+    fclose(file);
+
+    if (se_meshes_get_size(&model->meshes) != header.mesh_count) {
+        fprintf(stderr, "se_model_cache_load :: corrupted cache file %s, reimporting\n", cache_path);
+        se_model_cleanup(model);
+        return false;
+    }
+    return true;
+}
+
+static b8 se_model_cache_save(se_model* model, const c8* cache_path, const u64 source_stamp) {
+    FILE* file = fopen(cache_path, "wb");
+    if (!file) {
+        fprintf(stderr, "se_model_cache_save :: could not write %s\n", cache_path);
+        return false;
+    }
+    const se_mesh_cache_header header = { SE_MESH_CACHE_MAGIC, SE_MESH_CACHE_VERSION, (u32)se_meshes_get_size(&model->meshes), source_stamp };
+    fwrite(&header, sizeof(header), 1, file);
+    se_foreach(se_meshes, model->meshes, i) {
+        const se_mesh* mesh = se_meshes_get(&model->meshes, i);
+        se_mesh_cache_entry entry = {0};
+        entry.vertex_count = mesh->vertex_count;
+        entry.index_count = mesh->index_count;
+        entry.cluster_count = mesh->cluster_count;
+        entry.lod_count = mesh->lod_count;
+        entry.bounds_center = mesh->bounds_center;
+        entry.bounds_radius = mesh->bounds_radius;
+        memcpy(entry.lods, mesh->lods, mesh->lod_count * sizeof(se_mesh_lod));
+        fwrite(&entry, sizeof(entry), 1, file);
+        fwrite(mesh->vertices, sizeof(se_vertex), mesh->vertex_count, file);
+        fwrite(mesh->indices, sizeof(u32), mesh->index_count, file);
+        fwrite(mesh->clusters, sizeof(se_mesh_cluster), mesh->cluster_count, file);
+    }
+    return fclose(file) == 0;
+}
+
+// Reads the CPU copies of meshes that don't have them, the cache has to match the loaded model
+static b8 se_model_cache_read_cpu_data(se_model* model) {
+    FILE* file = fopen(model->cache_path, "rb");
+    if (!file) {
+        return false;
+    }
+    se_mesh_cache_header header = {0};
+    b8 success = fread(&header, sizeof(header), 1, file) == 1 && header.magic == SE_MESH_CACHE_MAGIC &&
+        header.version == SE_MESH_CACHE_VERSION && header.mesh_count == se_meshes_get_size(&model->meshes);
+    for (u32 i = 0; i < header.mesh_count && success; i++) {
+        se_mesh* mesh = se_meshes_get(&model->meshes, i);
+        se_mesh_cache_entry entry = {0};
+        if (fread(&entry, sizeof(entry), 1, file) != 1 || entry.vertex_count != mesh->vertex_count || entry.index_count != mesh->index_count) {
+            success = false;
+            break;
+        }
+        const sz vertices_size = entry.vertex_count * sizeof(se_vertex);
+        const sz indices_size = entry.index_count * sizeof(u32);
+        if (mesh->vertices == NULL) {
+            se_vertex* vertices = malloc(vertices_size);
+            u32* indices = malloc(indices_size);
+            if (fread(vertices, 1, vertices_size, file) != vertices_size || fread(indices, 1, indices_size, file) != indices_size) {
+                free(vertices);
+                free(indices);
+                success = false;
+                break;
+            }
+            free(mesh->indices);
+            mesh->vertices = vertices;
+            mesh->indices = indices;
+        } else if (fseek(file, (long)(vertices_size + indices_size), SEEK_CUR) != 0) {
+            success = false;
+            break;
+        }
+        success = fseek(file, (long)(entry.cluster_count * sizeof(se_mesh_cluster)), SEEK_CUR) == 0;
+    }
+    fclose(file);
+    return success;
+}
+
+// Growable scratch storage used while importing
+static void* se_grow(void* data, u32* capacity, const u32 needed, const sz element_size) {
+    if (needed <= *capacity) {
+        return data;
+    }
+    const u32 new_capacity = max(*capacity * 2, needed);
+    void* new_data = realloc(data, (sz)new_capacity * element_size);
+    se_assertf(new_data, "se_grow :: out of memory (%u elements)\n", new_capacity);
+    *capacity = new_capacity;
+    return new_data;
+}
+
+// OBJ faces index positions, uvs and normals separately, this map merges identical corners into one vertex
+typedef struct {
+    u32 position;
+    u32 uv;
+    u32 normal;
+    u32 vertex;
+} se_obj_corner;
+
+typedef struct {
+    se_obj_corner* entries;
+    u32 capacity; // power of two
+    u32 count;
+} se_obj_corner_map;
+
+static u32 se_obj_corner_hash(const u32 position, const u32 uv, const u32 normal) {
+    return (position * 73856093u) ^ (uv * 19349663u) ^ (normal * 83492791u);
+}
+
+static void se_obj_corner_map_reset(se_obj_corner_map* map, const u32 capacity) {
+    free(map->entries);
+    map->capacity = capacity;
+    map->count = 0;
+    map->entries = malloc(capacity * sizeof(se_obj_corner));
+    memset(map->entries, 0xff, capacity * sizeof(se_obj_corner));
+}
+
+// returns the vertex index for the corner, or UINT32_MAX if the corner is new and was assigned new_vertex
+static u32 se_obj_corner_map_find_or_add(se_obj_corner_map* map, const u32 position, const u32 uv, const u32 normal, const u32 new_vertex) {
+    if ((map->count + 1) * 2 > map->capacity) {
+        se_obj_corner* old_entries = map->entries;
+        const u32 old_capacity = map->capacity;
+        map->entries = NULL;
+        se_obj_corner_map_reset(map, old_capacity * 2);
+        for (u32 i = 0; i < old_capacity; i++) {
+            if (old_entries[i].vertex != UINT32_MAX) {
+                se_obj_corner_map_find_or_add(map, old_entries[i].position, old_entries[i].uv, old_entries[i].normal, old_entries[i].vertex);
+            }
+        }
+        free(old_entries);
+    }
+    u32 slot = se_obj_corner_hash(position, uv, normal) & (map->capacity - 1);
+    while (map->entries[slot].vertex != UINT32_MAX) {
+        const se_obj_corner* entry = &map->entries[slot];
+        if (entry->position == position && entry->uv == uv && entry->normal == normal) {
+            return entry->vertex;
+        }
+        slot = (slot + 1) & (map->capacity - 1);
+    }
+    map->entries[slot] = (se_obj_corner){ position, uv, normal, new_vertex };
+    map->count++;
+    return UINT32_MAX;
+}
+
+// Parses (or reads the cooked cache of) an OBJ into CPU side meshes, no GL calls so it can run on a worker
+static b8 se_model_import_obj(se_model* model, const char* path) {
+    model->cache_path[0] = '\0';
+    strncpy(model->path, path, SE_MAX_PATH_LENGTH - 1);
+
+    char full_path[MAX_PATH_LENGTH];
+    strncpy(full_path, RESOURCES_DIR, MAX_PATH_LENGTH - 1);
+    strncat(full_path, path, MAX_PATH_LENGTH - strlen(full_path) - 1);
+    
+    c8 cache_path[MAX_PATH_LENGTH] = {0};
+    // stamped before parsing, an edit landing meanwhile makes the next load import again
+    const u64 source_stamp = se_cache_source_stamp(full_path);
+    if (source_stamp && se_cache_get_path(cache_path, se_model_cache_key(full_path), "semesh") && se_model_cache_load(model, cache_path, source_stamp)) {
+        printf("Model - loaded %s from cache\n", path);
+        strncpy(model->cache_path, cache_path, SE_MAX_PATH_LENGTH - 1);
+        return true;
+    }
+    
+    FILE* file = fopen(full_path, "r");
+    if (!file) {
+        fprintf(stderr, "Failed to open OBJ file: %s\n", path);
+        return false;
+    }
+
+    // Arrays for temporary storage (shared across all meshes), they grow with the file
+    u32 position_capacity = SE_MAX_VERTICES;
+    u32 normal_capacity = SE_MAX_VERTICES;
+    u32 uv_capacity = SE_MAX_VERTICES;
+    se_vec3* temp_vertices = malloc(position_capacity * sizeof(se_vec3));
+    se_vec3* temp_normals = malloc(normal_capacity * sizeof(se_vec3));
+    se_vec2* temp_uvs = malloc(uv_capacity * sizeof(se_vec2));
+    
+    u32 vertex_count = 0;
+    u32 normal_count = 0;
+    u32 uv_count = 0;
+    
+    // Current mesh data
+    u32 current_vertex_capacity = SE_MAX_VERTICES;
+    u32 current_index_capacity = SE_MAX_INDICES;
+    se_vertex* current_vertices = malloc(current_vertex_capacity * sizeof(se_vertex));
+    u32* current_indices = malloc(current_index_capacity * sizeof(u32));
+    u32 current_vertex_count = 0;
+    u32 current_index_count = 0;
+    se_obj_corner_map corner_map = {0};
+    se_obj_corner_map_reset(&corner_map, 1024);
+    
+    char line[256];
+    char current_object[256] = "default";
+    b8 hse_faces = false;
+    
+    while (fgets(line, sizeof(line), file)) {
+        if (strncmp(line, "v ", 2) == 0) {
+            // Vertex position
+            temp_vertices = se_grow(temp_vertices, &position_capacity, vertex_count + 1, sizeof(se_vec3));
+            sscanf(line, "v %f %f %f", &temp_vertices[vertex_count].x, 
+                   &temp_vertices[vertex_count].y, &temp_vertices[vertex_count].z);
+            vertex_count++;
+        } else if (strncmp(line, "vn ", 3) == 0) {
+            // Vertex normal
+            temp_normals = se_grow(temp_normals, &normal_capacity, normal_count + 1, sizeof(se_vec3));
+            sscanf(line, "vn %f %f %f", &temp_normals[normal_count].x,
+                   &temp_normals[normal_count].y, &temp_normals[normal_count].z);
+            normal_count++;
+        } else if (strncmp(line, "vt ", 3) == 0) {
+            // Vertex texture coordinate
+            temp_uvs = se_grow(temp_uvs, &uv_capacity, uv_count + 1, sizeof(se_vec2));
+            sscanf(line, "vt %f %f", &temp_uvs[uv_count].x, &temp_uvs[uv_count].y);
+            uv_count++;
+        } else if (strncmp(line, "o ", 2) == 0 || strncmp(line, "g ", 2) == 0) {
+            // New object/group - finalize current mesh if it has faces
+            if (hse_faces && current_vertex_count > 0) {
+                se_mesh* new_mesh = se_meshes_increment(&model->meshes);
+                finalize_mesh(new_mesh, current_vertices, current_indices, current_vertex_count, current_index_count);
+                // Reset for next mesh
+                current_vertex_count = 0;
+                current_index_count = 0;
+                se_obj_corner_map_reset(&corner_map, 1024);
+                hse_faces = false;
+            }
+            
+            // Get new object name
+            sscanf(line, "%*s %255s", current_object);
+        } else if (strncmp(line, "f ", 2) == 0) {
+            // Face
+            u32 v[3], t[3] = { 0, 0, 0 }, n[3];
+            b8 has_uvs = true;
+            i32 matches = sscanf(line, "f %u/%u/%u %u/%u/%u %u/%u/%u",
+                                &v[0], &t[0], &n[0], &v[1], &t[1], &n[1], &v[2], &t[2], &n[2]);
+            if (matches != 9) {
+                // Try to parse face without texture coordinates (v//n format)
+                has_uvs = false;
+                matches = sscanf(line, "f %u//%u %u//%u %u//%u", &v[0], &n[0], &v[1], &n[1], &v[2], &n[2]);
+                if (matches != 6) {
+                    continue;
+                }
+            }
+            hse_faces = true;
+
+            // Check bounds
+            b8 valid = true;
+            for (i32 i = 0; i < 3; i++) {
+                if (v[i] - 1 >= vertex_count || n[i] - 1 >= normal_count || (has_uvs && t[i] - 1 >= uv_count)) {
+                    valid = false;
+                }
+            }
+            if (!valid) {
+                fprintf(stderr, "OBJ file contains invalid face indices\n");
+                continue;
+            }
+
+            current_indices = se_grow(current_indices, &current_index_capacity, current_index_count + 3, sizeof(u32));
+            for (i32 i = 0; i < 3; i++) {
+                const u32 vi = v[i] - 1;
+                const u32 ni = n[i] - 1;
+                const u32 ti = has_uvs ? t[i] - 1 : UINT32_MAX;
+
+                u32 index = se_obj_corner_map_find_or_add(&corner_map, vi, ti, ni, current_vertex_count);
+                if (index == UINT32_MAX) {
+                    current_vertices = se_grow(current_vertices, &current_vertex_capacity, current_vertex_count + 1, sizeof(se_vertex));
+                    current_vertices[current_vertex_count].position = temp_vertices[vi];
+                    current_vertices[current_vertex_count].normal = temp_normals[ni];
+                    current_vertices[current_vertex_count].uv = has_uvs ? temp_uvs[ti] : (se_vec2){0.0f, 0.0f}; // Default UV
+                    index = current_vertex_count++;
+                }
+                current_indices[current_index_count++] = index;
+            }
+        }
+    }
+    
+    // Finalize the last mesh
+    if (hse_faces && current_vertex_count > 0) {
+        se_mesh* new_mesh = se_meshes_increment(&model->meshes);
+        finalize_mesh(new_mesh, current_vertices, current_indices, current_vertex_count, current_index_count);
+    }
+    
+    fclose(file);
+    
+    // Cleanup temporary arrays
+    free(temp_vertices);
+    free(temp_normals);
+    free(temp_uvs);
+    free(current_vertices);
+    free(current_indices);
+    free(corner_map.entries);
+    
+    // If no meshes were created, create a default one
+    if (se_meshes_get_size(&model->meshes) == 0) {
+        fprintf(stderr, "No valid meshes found in OBJ file: %s\n", path);
+        se_meshes_clear(&model->meshes);
+        return false;
+    }
+
+    if (cache_path[0] != '\0' && se_model_cache_save(model, cache_path, source_stamp)) {
+        strncpy(model->cache_path, cache_path, SE_MAX_PATH_LENGTH - 1);
+    }
+    return true;
+}
+
+se_model* se_model_load_obj(se_render_handle* render_handle, const char* path, se_shaders_ptr* shaders) {
+    se_model* model = se_models_increment(&render_handle->models);
+    model->residency = render_handle->model_residency;
+    model->state = SE_ASSET_READY;
+    se_render_handle_watch_resource(render_handle, path);
+    if (!se_model_import_obj(model, path)) {
+        return NULL;
+    }
+    se_model_upload(render_handle, model, shaders);
+    return model;
+}
+
+typedef struct {
+    se_mesh_pool* pool;
+    u32 base_vertex;
+    u32 vertex_count;
+    u32 first_index;
+    u32 index_count;
+} se_model_stream_range;
+
+typedef struct se_model_stream {
+    se_model* model; // NULL once the model was cleaned up, the ranges below are freed when the uploads retire instead
+    u32 remaining;
+    b8 cancelled;
+    se_model_stream_range* ranges;
+    u32 range_count;
+} se_model_stream;
+
+static void se_model_stream_complete(void* user_data, const b8 cancelled) {
+    se_model_stream* stream = user_data;
+    stream->cancelled |= cancelled;
+    if (--stream->remaining > 0) {
+        return;
+    }
+    if (stream->model) {
+        stream->model->stream = NULL;
+        if (!stream->cancelled && stream->model->state == SE_ASSET_PENDING) {
+            stream->model->state = SE_ASSET_READY;
+        }
+    }
+    for (u32 i = 0; i < stream->range_count; i++) {
+        const se_model_stream_range* range = &stream->ranges[i];
+        se_mesh_pool_free(range->pool, range->base_vertex, range->vertex_count, range->first_index, range->index_count);
+    }
+    free(stream->ranges);
+    free(stream);
+}
+
+// Queued copies still target the pool ranges of the meshes, they are handed over to the stream until they retire
+static void se_model_stream_orphan(se_model* model) {
+    se_model_stream* stream = model->stream;
+    stream->model = NULL;
+    stream->ranges = malloc(se_meshes_get_size(&model->meshes) * sizeof(se_model_stream_range));
+    se_foreach(se_meshes, model->meshes, i) {
+        se_mesh* mesh = se_meshes_get(&model->meshes, i);
+        if (mesh->pool) {
+            stream->ranges[stream->range_count++] = (se_model_stream_range){ mesh->pool, mesh->base_vertex, mesh->vertex_count, mesh->first_index, mesh->index_count };
+            mesh->pool = NULL;
+        }
+    }
+    model->stream = NULL;
+}
+
+// Like se_model_upload, but through the upload scheduler. The model stays pending (not drawn) until every mesh has landed
+static void se_model_upload_streamed(se_render_handle* render_handle, se_model* model, se_shaders_ptr* shaders) {
+    if (se_meshes_get_size(&model->meshes) == 0) {
+        model->state = SE_ASSET_READY; // nothing to wait for
+        return;
+    }
+    se_model_stream* stream = malloc(sizeof(se_model_stream));
+    *stream = (se_model_stream){ model, (u32)se_meshes_get_size(&model->meshes) * 2, false, NULL, 0 };
+    model->stream = stream;
+    se_foreach(se_meshes, model->meshes, i) {
+        se_mesh* mesh = se_meshes_get(&model->meshes, i);
+        mesh->shader = se_mesh_pick_shader(shaders, i);
+        se_mesh_pool* pool = se_mesh_allocate(render_handle, mesh);
+
+        // the upload takes the CPU copies over, unless the model keeps them
+        se_vertex* vertices = mesh->vertices;
+        u32* indices = mesh->indices;
+        if (model->residency == SE_MODEL_CPU_ACCESS) {
+            vertices = memcpy(malloc(mesh->vertex_count * sizeof(se_vertex)), mesh->vertices, mesh->vertex_count * sizeof(se_vertex));
+            indices = memcpy(malloc(mesh->index_count * sizeof(u32)), mesh->indices, mesh->index_count * sizeof(u32));
+        } else {
+            mesh->vertices = NULL;
+            mesh->indices = NULL;
+        }
+        se_upload_buffer(&render_handle->uploads, &pool->vbo, mesh->base_vertex * sizeof(se_vertex), vertices, mesh->vertex_count * sizeof(se_vertex),
+                         free, se_model_stream_complete, stream);
+        se_upload_buffer(&render_handle->uploads, &pool->ebo, mesh->first_index * sizeof(u32), indices, mesh->index_count * sizeof(u32),
+                         free, se_model_stream_complete, stream);
+    }
+}
+
+typedef struct {
+    se_job job;
+    se_render_handle* render_handle;
+    se_model* model;
+    se_model* imported; // filled on the worker, the slot only sees it once uploaded
+    se_shaders_ptr shaders;
+    c8 path[MAX_PATH_LENGTH];
+    b8 success;
+} se_model_load_job;
+
+static void se_model_load_job_run(se_job* job) {
+    se_model_load_job* load = (se_model_load_job*)job;
+    load->success = se_model_import_obj(load->imported, load->path);
+}
+
+static void se_model_load_job_finish(se_job* job, const b8 cancelled) {
+    se_model_load_job* load = (se_model_load_job*)job;
+    se_model* model = load->model;
+    if (!cancelled && model->state == SE_ASSET_PENDING) {
+        if (load->success) {
+            memcpy(model, load->imported, sizeof(se_model));
+            model->state = SE_ASSET_PENDING;
+            se_model_upload_streamed(load->render_handle, model, &load->shaders);
+            se_meshes_clear(&load->imported->meshes); // owned by the slot now
+        } else {
+            model->state = SE_ASSET_FAILED;
+        }
+    }
+    se_model_cleanup(load->imported);
+    free(load->imported);
+    free(load);
+}
+
+// Returns an empty model right away, meshes appear once imported and uploaded
+se_model* se_model_load_obj_async(se_render_handle* render_handle, const char* path, se_shaders_ptr* shaders) {
+    se_model* model = se_models_increment(&render_handle->models);
+    se_meshes_clear(&model->meshes);
+    model->residency = render_handle->model_residency;
+    model->cache_path[0] = '\0';
+    model->path[0] = '\0'; // set once imported
+    model->stream = NULL;
+    model->state = SE_ASSET_PENDING;
+    se_render_handle_watch_resource(render_handle, path);
+
+    se_model_load_job* load = malloc(sizeof(se_model_load_job));
+    memset(load, 0, sizeof(se_model_load_job));
+    load->job.run = se_model_load_job_run;
+    load->job.finish = se_model_load_job_finish;
+    load->render_handle = render_handle;
+    load->model = model;
+    load->imported = malloc(sizeof(se_model));
+    memset(load->imported, 0, sizeof(se_model));
+    load->imported->residency = model->residency;
+    load->shaders = *shaders;
+    strncpy(load->path, path, MAX_PATH_LENGTH - 1);
+    se_worker_pool_submit(se_render_handle_get_loader(render_handle), &load->job);
+    return model;
+}
+
+// glTF 2.0 loader (.gltf with external or embedded buffers, and .glb). Files are mapped, and primitives whose
+// vertex layout already matches se_vertex are uploaded straight from the mapping without touching the vertices.
+#define SE_GLTF_MAGIC 0x46546c67 // "glTF"
+#define SE_GLTF_CHUNK_JSON 0x4e4f534a
+#define SE_GLTF_CHUNK_BIN 0x004e4942
+#define SE_GLTF_MAX_BUFFERS 16
+#define SE_GLTF_MAX_NODE_DEPTH 64
+#define SE_GLTF_BYTE 5120
+#define SE_GLTF_UNSIGNED_BYTE 5121
+#define SE_GLTF_SHORT 5122
+#define SE_GLTF_UNSIGNED_SHORT 5123
+#define SE_GLTF_UNSIGNED_INT 5125
+#define SE_GLTF_FLOAT 5126
+#define SE_GLTF_TRIANGLES 4
+
+typedef struct {
+    const u8* data;
+    sz size;
+    void* mapping; // munmap on cleanup
+    b8 owned; // decoded data uri
+} se_gltf_buffer;
+
+typedef struct {
+    se_render_handle* render_handle;
+    se_model* model;
+    se_shaders_ptr* shaders;
+    se_json_document document;
+    se_gltf_buffer buffers[SE_GLTF_MAX_BUFFERS];
+    u32 buffer_count;
+    u32 direct_uploads;
+} se_gltf;
+
+typedef struct {
+    const u8* data;
+    u32 count;
+    u32 stride;
+    u32 component_type;
+    u32 components;
+} se_gltf_accessor;
+
+static u8* se_base64_decode(const c8* text, const u32 length, sz* out_size) {
+    u8* out = malloc(length / 4 * 3 + 3);
+    u32 value = 0;
+    u32 bits = 0;
+    sz size = 0;
+    for (u32 i = 0; i < length && text[i] != '='; i++) {
+        const c8 c = text[i];
+        u32 digit;
+        if (c >= 'A' && c <= 'Z') digit = c - 'A';
+        else if (c >= 'a' && c <= 'z') digit = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') digit = c - '0' + 52;
+        else if (c == '+') digit = 62;
+        else if (c == '/') digit = 63;
+        else continue;
+        value = (value << 6) | digit;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out[size++] = (u8)(value >> bits);
+        }
+    }
+    *out_size = size;
+    return out;
+}
+
+static b8 se_gltf_load_buffers(se_gltf* gltf, const c8* full_path, const u8* glb_bin, const sz glb_bin_size) {
+    const se_json* buffers = se_json_get(gltf->document.root, "buffers");
+    const u32 buffer_count = buffers ? buffers->child_count : 0;
+    if (buffer_count > SE_GLTF_MAX_BUFFERS) {
+        fprintf(stderr, "se_model_load_gltf :: too many buffers (%u, max %d)\n", buffer_count, SE_GLTF_MAX_BUFFERS);
+        return false;
+    }
+    u32 i = 0;
+    for (const se_json* buffer = buffers ? buffers->first_child : NULL; buffer; buffer = buffer->next, i++) {
+        se_gltf_buffer* out = &gltf->buffers[gltf->buffer_count++];
+        memset(out, 0, sizeof(se_gltf_buffer));
+        const se_json* uri = se_json_get(buffer, "uri");
+        if (uri == NULL || uri->type != SE_JSON_STRING) {
+            // the first buffer of a .glb is its binary chunk
+            if (i != 0 || glb_bin == NULL) {
+                fprintf(stderr, "se_model_load_gltf :: buffer %u has no data\n", i);
+                return false;
+            }
+            out->data = glb_bin;
+            out->size = glb_bin_size;
+        } else if (uri->value.string.length > 5 && strncmp(uri->value.string.data, "data:", 5) == 0) {
+            const c8* payload = strstr(uri->value.string.data, "base64,");
+            const c8* uri_end = uri->value.string.data + uri->value.string.length;
+            if (payload == NULL || payload >= uri_end) {
+                fprintf(stderr, "se_model_load_gltf :: unsupported data uri in buffer %u\n", i);
+                return false;
+            }
+            payload += 7;
+            out->data = se_base64_decode(payload, (u32)(uri_end - payload), &out->size);
+            out->owned = true;
+        } else {
+            // external file, relative to the .gltf
+            c8 buffer_path[MAX_PATH_LENGTH];
+            const c8* slash = strrchr(full_path, '/');
+            const i32 directory_length = slash ? (i32)(slash - full_path + 1) : 0;
+            snprintf(buffer_path, sizeof(buffer_path), "%.*s%.*s", directory_length, full_path, (i32)uri->value.string.length, uri->value.string.data);
+            out->mapping = se_map_file(buffer_path, &out->size);
+            if (out->mapping == NULL) {
+                fprintf(stderr, "se_model_load_gltf :: failed to open buffer %s\n", buffer_path);
+                return false;
+            }
+            out->data = out->mapping;
+        }
+        if ((sz)se_json_get_number(buffer, "byteLength", 0) > out->size) {
+            fprintf(stderr, "se_model_load_gltf :: buffer %u is shorter than its byteLength\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+static b8 se_gltf_get_accessor(const se_gltf* gltf, const i32 index, se_gltf_accessor* out) {
+    const se_json* root = gltf->document.root;
+    const se_json* accessor = se_json_at(se_json_get(root, "accessors"), (u32)index);
+    if (index < 0 || accessor == NULL) {
+        return false;
+    }
+    // accessors without a view (all zeros) and sparse accessors are not supported
+    const i32 view_index = (i32)se_json_get_number(accessor, "bufferView", -1);
+    const se_json* view = se_json_at(se_json_get(root, "bufferViews"), (u32)view_index);
+    if (view_index < 0 || view == NULL || se_json_get(accessor, "sparse")) {
+        fprintf(stderr, "se_model_load_gltf :: unsupported accessor %d\n", index);
+        return false;
+    }
+    const u32 buffer_index = (u32)se_json_get_number(view, "buffer", 0);
+    if (buffer_index >= gltf->buffer_count) {
+        return false;
+    }
+
+    const se_json* type = se_json_get(accessor, "type");
+    out->components = se_json_equals(type, "SCALAR") ? 1 : se_json_equals(type, "VEC2") ? 2 : se_json_equals(type, "VEC3") ? 3 : se_json_equals(type, "VEC4") ? 4 : 0;
+    out->component_type = (u32)se_json_get_number(accessor, "componentType", 0);
+    u32 component_size = 0;
+    switch (out->component_type) {
+        case SE_GLTF_BYTE: case SE_GLTF_UNSIGNED_BYTE: component_size = 1; break;
+        case SE_GLTF_SHORT: case SE_GLTF_UNSIGNED_SHORT: component_size = 2; break;
+        case SE_GLTF_UNSIGNED_INT: case SE_GLTF_FLOAT: component_size = 4; break;
+    }
+    if (out->components == 0 || component_size == 0) {
+        fprintf(stderr, "se_model_load_gltf :: unsupported accessor type in accessor %d\n", index);
+        return false;
+    }
+
+    const u32 element_size = out->components * component_size;
+    const sz view_offset = (sz)se_json_get_number(view, "byteOffset", 0);
+    const sz view_length = (sz)se_json_get_number(view, "byteLength", 0);
+    const sz offset = (sz)se_json_get_number(accessor, "byteOffset", 0);
+    out->count = (u32)se_json_get_number(accessor, "count", 0);
+    out->stride = (u32)se_json_get_number(view, "byteStride", element_size);
+    if (out->count == 0 || view_offset + view_length > gltf->buffers[buffer_index].size ||
+        offset + (sz)(out->count - 1) * out->stride + element_size > view_length) {
+        fprintf(stderr, "se_model_load_gltf :: accessor %d is out of bounds\n", index);
+        return false;
+    }
+    out->data = gltf->buffers[buffer_index].data + view_offset + offset;
+    return true;
+}
+
+static f32 se_gltf_read_float(const se_gltf_accessor* accessor, const u32 element, const u32 component) {
+    const u8* data = accessor->data + (sz)element * accessor->stride;
+    switch (accessor->component_type) {
+        case SE_GLTF_FLOAT: { f32 value; memcpy(&value, data + component * 4, 4); return value; }
+        case SE_GLTF_UNSIGNED_BYTE: return data[component] / 255.0f;
+        case SE_GLTF_BYTE: return max(((i8)data[component]) / 127.0f, -1.0f);
+        case SE_GLTF_UNSIGNED_SHORT: { u16 value; memcpy(&value, data + component * 2, 2); return value / 65535.0f; }
+        case SE_GLTF_SHORT: { i16 value; memcpy(&value, data + component * 2, 2); return max(value / 32767.0f, -1.0f); }
+    }
+    return 0.0f;
+}
+
+static u32 se_gltf_read_index(const se_gltf_accessor* accessor, const u32 element) {
+    const u8* data = accessor->data + (sz)element * accessor->stride;
+    switch (accessor->component_type) {
+        case SE_GLTF_UNSIGNED_BYTE: return data[0];
+        case SE_GLTF_UNSIGNED_SHORT: { u16 value; memcpy(&value, data, 2); return value; }
+        case SE_GLTF_UNSIGNED_INT: { u32 value; memcpy(&value, data, 4); return value; }
+    }
+    return 0;
+}
+
+static b8 se_gltf_load_primitive(se_gltf* gltf, const se_json* primitive, const se_mat4* matrix) {
+    if (se_json_get_number(primitive, "mode", SE_GLTF_TRIANGLES) != SE_GLTF_TRIANGLES) {
+        fprintf(stderr, "se_model_load_gltf :: skipping non triangle primitive\n");
+        return true;
+    }
+    const se_json* attributes = se_json_get(primitive, "attributes");
+    se_gltf_accessor positions = {0}, normals = {0}, uvs = {0}, indices = {0};
+    if (!se_gltf_get_accessor(gltf, (i32)se_json_get_number(attributes, "POSITION", -1), &positions) ||
+        positions.component_type != SE_GLTF_FLOAT || positions.components != 3) {
+        fprintf(stderr, "se_model_load_gltf :: primitive without float3 positions\n");
+        return false;
+    }
+    const b8 has_normals = se_gltf_get_accessor(gltf, (i32)se_json_get_number(attributes, "NORMAL", -1), &normals) && normals.count == positions.count;
+    const b8 has_uvs = se_gltf_get_accessor(gltf, (i32)se_json_get_number(attributes, "TEXCOORD_0", -1), &uvs) && uvs.count == positions.count;
+    const b8 has_indices = se_gltf_get_accessor(gltf, (i32)se_json_get_number(primitive, "indices", -1), &indices);
+    const u32 vertex_count = positions.count;
+    const u32 index_count = has_indices ? indices.count : vertex_count;
+    if (index_count < 3) {
+        return true;
+    }
+
+    if (se_meshes_get_size(&gltf->model->meshes) >= SE_MAX_MESHES) {
+        fprintf(stderr, "se_model_load_gltf :: too many primitives (max %d)\n", SE_MAX_MESHES);
+        return false;
+    }
+    const u32 mesh_index = (u32)se_meshes_get_size(&gltf->model->meshes);
+    se_mesh* mesh = se_meshes_increment(&gltf->model->meshes);
+    memset(mesh, 0, sizeof(se_mesh));
+    mesh->vertex_count = vertex_count;
+    mesh->index_count = index_count;
+    mesh->matrix = *matrix;
+    mesh->shader = se_mesh_pick_shader(gltf->shaders, mesh_index);
+
+    // interleaved position/normal/uv floats in one view are exactly se_vertex, and u32 indices are used as is
+    const b8 direct_vertices = has_normals && has_uvs &&
+        positions.stride == sizeof(se_vertex) && normals.stride == sizeof(se_vertex) && uvs.stride == sizeof(se_vertex) &&
+        normals.component_type == SE_GLTF_FLOAT && normals.components == 3 && normals.data == positions.data + offsetof(se_vertex, normal) &&
+        uvs.component_type == SE_GLTF_FLOAT && uvs.components == 2 && uvs.data == positions.data + offsetof(se_vertex, uv);
+    const b8 direct_indices = has_indices && indices.component_type == SE_GLTF_UNSIGNED_INT && indices.stride == sizeof(u32);
+
+    const se_vertex* vertices = direct_vertices ? (const se_vertex*)positions.data : NULL;
+    const u32* mesh_indices = direct_indices ? (const u32*)indices.data : NULL;
+    se_vertex* converted_vertices = NULL;
+    u32* converted_indices = NULL;
+    if (vertices == NULL) {
+        converted_vertices = malloc(vertex_count * sizeof(se_vertex));
+        for (u32 i = 0; i < vertex_count; i++) {
+            se_vertex* vertex = &converted_vertices[i];
+            vertex->position = (se_vec3){ se_gltf_read_float(&positions, i, 0), se_gltf_read_float(&positions, i, 1), se_gltf_read_float(&positions, i, 2) };
+            vertex->normal = has_normals ? (se_vec3){ se_gltf_read_float(&normals, i, 0), se_gltf_read_float(&normals, i, 1), se_gltf_read_float(&normals, i, 2) } : (se_vec3){0};
+            vertex->uv = has_uvs ? (se_vec2){ se_gltf_read_float(&uvs, i, 0), se_gltf_read_float(&uvs, i, 1) } : (se_vec2){0};
+        }
+        vertices = converted_vertices;
+    }
+    if (mesh_indices == NULL) {
+        converted_indices = malloc(index_count * sizeof(u32));
+        for (u32 i = 0; i < index_count; i++) {
+            converted_indices[i] = has_indices ? se_gltf_read_index(&indices, i) : i;
+        }
+        mesh_indices = converted_indices;
+    }
+    for (u32 i = 0; i < index_count; i++) {
+        if (mesh_indices[i] >= vertex_count) {
+            fprintf(stderr, "se_model_load_gltf :: primitive contains invalid indices\n");
+            free(converted_vertices);
+            free(converted_indices);
+            se_meshes_remove_at(&gltf->model->meshes, mesh_index);
+            return false;
+        }
+    }
+
+    if (index_count / 3 >= SE_LOD_MIN_TRIANGLES) {
+        // big enough for clusters and levels of detail, these need their own copy to reorder and append to
+        mesh->vertices = converted_vertices ? converted_vertices : malloc(vertex_count * sizeof(se_vertex));
+        mesh->indices = converted_indices ? converted_indices : malloc(index_count * sizeof(u32));
+        if (converted_vertices == NULL) memcpy(mesh->vertices, vertices, vertex_count * sizeof(se_vertex));
+        if (converted_indices == NULL) memcpy(mesh->indices, mesh_indices, index_count * sizeof(u32));
+        se_mesh_process(mesh);
+        se_mesh_upload(gltf->render_handle, mesh, mesh->vertices, mesh->indices);
+        return true;
+    }
+
+    // small primitives skip processing, bounds come from the accessor min/max (required for positions)
+    const se_json* accessor = se_json_at(se_json_get(gltf->document.root, "accessors"), (u32)se_json_get_number(attributes, "POSITION", -1));
+    const se_json* bounds_min = se_json_get(accessor, "min");
+    const se_json* bounds_max = se_json_get(accessor, "max");
+    if (bounds_min && bounds_max && bounds_min->child_count == 3 && bounds_max->child_count == 3) {
+        se_mesh_set_bounds(mesh,
+            (se_vec3){ se_json_at(bounds_min, 0)->value.number, se_json_at(bounds_min, 1)->value.number, se_json_at(bounds_min, 2)->value.number },
+            (se_vec3){ se_json_at(bounds_max, 0)->value.number, se_json_at(bounds_max, 1)->value.number, se_json_at(bounds_max, 2)->value.number });
+    } else {
+        se_vec3 low = vertices[0].position, high = vertices[0].position;
+        for (u32 i = 1; i < vertex_count; i++) {
+            const se_vec3* p = &vertices[i].position;
+            low = (se_vec3){ min(low.x, p->x), min(low.y, p->y), min(low.z, p->z) };
+            high = (se_vec3){ max(high.x, p->x), max(high.y, p->y), max(high.z, p->z) };
+        }
+        se_mesh_set_bounds(mesh, low, high);
+    }
+    se_mesh_set_lods(mesh, &(se_mesh_lod){ 0, index_count, 0.0f }, 1);
+    se_mesh_upload(gltf->render_handle, mesh, vertices, mesh_indices);
+    gltf->direct_uploads += direct_vertices && direct_indices;
+    if (gltf->model->residency == SE_MODEL_CPU_ACCESS) {
+        mesh->vertices = converted_vertices ? converted_vertices : memcpy(malloc(vertex_count * sizeof(se_vertex)), vertices, vertex_count * sizeof(se_vertex));
+        mesh->indices = converted_indices ? converted_indices : memcpy(malloc(index_count * sizeof(u32)), mesh_indices, index_count * sizeof(u32));
+    } else {
+        free(converted_vertices);
+        free(converted_indices);
+    }
+    return true;
+}
+
+static b8 se_gltf_load_node(se_gltf* gltf, const u32 node_index, const se_mat4* parent, const u32 depth) {
+    const se_json* node = se_json_at(se_json_get(gltf->document.root, "nodes"), node_index);
+    if (node == NULL || depth > SE_GLTF_MAX_NODE_DEPTH) {
+        fprintf(stderr, "se_model_load_gltf :: invalid node %u\n", node_index);
+        return false;
+    }
+
+    se_mat4 local = mat4_identity();
+    const se_json* matrix = se_json_get(node, "matrix");
+    if (matrix && matrix->child_count == 16) {
+        u32 i = 0;
+        for (const se_json* value = matrix->first_child; value; value = value->next) {
+            local.m[i++] = (f32)value->value.number;
+        }
     } else {
-        mesh->shader = NULL;
-        fprintf(stderr, "No shaders provided for mesh %u\n", se_mesh_index);
+        // T * R * S
+        const se_json* translation = se_json_get(node, "translation");
+        const se_json* rotation = se_json_get(node, "rotation");
+        const se_json* scale = se_json_get(node, "scale");
+        if (translation && translation->child_count == 3) {
+            const se_vec3 t = { se_json_at(translation, 0)->value.number, se_json_at(translation, 1)->value.number, se_json_at(translation, 2)->value.number };
+            local = mat4_translate(&t);
+        }
+        if (rotation && rotation->child_count == 4) {
+            const se_vec4 q = { se_json_at(rotation, 0)->value.number, se_json_at(rotation, 1)->value.number, se_json_at(rotation, 2)->value.number, se_json_at(rotation, 3)->value.number };
+            local = mat4_mul(local, mat4_from_quat(&q));
+        }
+        if (scale && scale->child_count == 3) {
+            const se_vec3 s = { se_json_at(scale, 0)->value.number, se_json_at(scale, 1)->value.number, se_json_at(scale, 2)->value.number };
+            local = mat4_mul(local, mat4_scale(&s));
+        }
     }
-    
-    // Create OpenGL objects
-    glGenVertexArrays(1, &mesh->vao);
-    glGenBuffers(1, &mesh->vbo);
-    glGenBuffers(1, &mesh->ebo);
-    
-    glBindVertexArray(mesh->vao);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertex_count * sizeof(se_vertex), mesh->vertices, GL_STATIC_DRAW);
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_count * sizeof(u32), mesh->indices, GL_STATIC_DRAW);
-    
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(se_vertex), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(se_vertex), (void*)offsetof(se_vertex, normal));
-    glEnableVertexAttribArray(1);
-    
-    // UV attribute
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(se_vertex), (void*)offsetof(se_vertex, uv));
-    glEnableVertexAttribArray(2);
-    
-    glBindVertexArray(0);
-}
+    const se_mat4 world = mat4_mul(*parent, local);
 
-se_model* se_model_load_obj(se_render_handle* render_handle, const char* path, se_shaders_ptr* shaders) {
-    se_model* model = se_models_increment(&render_handle->models);
+    const i32 mesh_index = (i32)se_json_get_number(node, "mesh", -1);
+    if (mesh_index >= 0) {
+        const se_json* primitives = se_json_get(se_json_at(se_json_get(gltf->document.root, "meshes"), (u32)mesh_index), "primitives");
+        for (const se_json* primitive = primitives ? primitives->first_child : NULL; primitive; primitive = primitive->next) {
+            if (!se_gltf_load_primitive(gltf, primitive, &world)) {
+                return false;
+            }
+        }
+    }
+    const se_json* children = se_json_get(node, "children");
+    for (const se_json* child = children ? children->first_child : NULL; child; child = child->next) {
+        if (!se_gltf_load_node(gltf, (u32)child->value.number, &world, depth + 1)) {
+            return false;
+        }
+    }
+    return true;
+}
 
+se_model* se_model_load_gltf(se_render_handle* render_handle, const char* path, se_shaders_ptr* shaders) {
     char full_path[MAX_PATH_LENGTH];
     strncpy(full_path, RESOURCES_DIR, MAX_PATH_LENGTH - 1);
     strncat(full_path, path, MAX_PATH_LENGTH - strlen(full_path) - 1);
-    
-    FILE* file = fopen(full_path, "r");
-    if (!file) {
-        fprintf(stderr, "Failed to open OBJ file: %s\n", path);
+
+    sz file_size = 0;
+    u8* file = se_map_file(full_path, &file_size);
+    if (file == NULL) {
+        fprintf(stderr, "Failed to open glTF file: %s\n", path);
         return NULL;
     }
 
-    // Arrays for temporary storage (shared across all meshes)
-    se_vec3* temp_vertices = malloc(SE_MAX_VERTICES * sizeof(se_vec3));
-    se_vec3* temp_normals = malloc(SE_MAX_VERTICES * sizeof(se_vec3));
-    se_vec2* temp_uvs = malloc(SE_MAX_VERTICES * sizeof(se_vec2));
-    
-    u32 vertex_count = 0;
-    u32 normal_count = 0;
-    u32 uv_count = 0;
-    
-    // Dynamic array for meshes
-    
-    // Current mesh data
-    se_vertex* current_vertices = malloc(SE_MAX_VERTICES * sizeof(se_vertex));
-    u32* current_indices = malloc(SE_MAX_INDICES * sizeof(u32));
-    u32 current_vertex_count = 0;
-    u32 current_index_count = 0;
-    
-    char line[256];
-    char current_object[256] = "default";
-    b8 hse_faces = false;
-    
-    while (fgets(line, sizeof(line), file)) {
-        if (strncmp(line, "v ", 2) == 0) {
-            // Vertex position
-            sscanf(line, "v %f %f %f", &temp_vertices[vertex_count].x, 
-                   &temp_vertices[vertex_count].y, &temp_vertices[vertex_count].z);
-            vertex_count++;
-        } else if (strncmp(line, "vn ", 3) == 0) {
-            // Vertex normal
-            sscanf(line, "vn %f %f %f", &temp_normals[normal_count].x,
-                   &temp_normals[normal_count].y, &temp_normals[normal_count].z);
-            normal_count++;
-        } else if (strncmp(line, "vt ", 3) == 0) {
-            // Vertex texture coordinate
-            sscanf(line, "vt %f %f", &temp_uvs[uv_count].x, &temp_uvs[uv_count].y);
-            uv_count++;
-        } else if (strncmp(line, "o ", 2) == 0 || strncmp(line, "g ", 2) == 0) {
-            // New object/group - finalize current mesh if it has faces
-            if (hse_faces && current_vertex_count > 0) {
-                se_mesh* new_mesh = se_meshes_increment(&model->meshes);
-                const sz mesh_count = se_meshes_get_size(&model->meshes);
-                if (mesh_count > 0) {
-                    finalize_mesh(new_mesh, current_vertices, current_indices, 
-                                 current_vertex_count, current_index_count, shaders, mesh_count - 1);
-                }
-                // Reset for next mesh
-                current_vertex_count = 0;
-                current_index_count = 0;
-                hse_faces = false;
-            }
-            
-            // Get new object name
-            sscanf(line, "%*s %255s", current_object);
-        } else if (strncmp(line, "f ", 2) == 0) {
-            // Face
-            hse_faces = true;
-            u32 v1, v2, v3, n1, n2, n3, t1, t2, t3;
-            i32 matches = sscanf(line, "f %d/%d/%d %d/%d/%d %d/%d/%d",
-                                &v1, &t1, &n1, &v2, &t2, &n2, &v3, &t3, &n3);
-            
-            if (matches == 9) {
-                // Create vertices for this face
-                for (i32 i = 0; i < 3; i++) {
-                    u32 vi = (i == 0) ? v1 - 1 : (i == 1) ? v2 - 1 : v3 - 1;
-                    u32 ni = (i == 0) ? n1 - 1 : (i == 1) ? n2 - 1 : n3 - 1;
-                    u32 ti = (i == 0) ? t1 - 1 : (i == 1) ? t2 - 1 : t3 - 1;
-                    
-                    // Check bounds
-                    if (vi >= vertex_count || ni >= normal_count || ti >= uv_count) {
-                        fprintf(stderr, "OBJ file contains invalid face indices\n");
-                        continue;
-                    }
-                    
-                    current_vertices[current_vertex_count].position = temp_vertices[vi];
-                    current_vertices[current_vertex_count].normal = temp_normals[ni];
-                    current_vertices[current_vertex_count].uv = temp_uvs[ti];
-                    
-                    current_indices[current_index_count] = current_vertex_count;
-                    current_vertex_count++;
-                    current_index_count++;
-                }
-            } else {
-                // Try to parse face without texture coordinates (v//n format)
-                matches = sscanf(line, "f %d//%d %d//%d %d//%d", &v1, &n1, &v2, &n2, &v3, &n3);
-                if (matches == 6) {
-                    for (i32 i = 0; i < 3; i++) {
-                        u32 vi = (i == 0) ? v1 - 1 : (i == 1) ? v2 - 1 : v3 - 1;
-                        u32 ni = (i == 0) ? n1 - 1 : (i == 1) ? n2 - 1 : n3 - 1;
-                        
-                        if (vi >= vertex_count || ni >= normal_count) {
-                            fprintf(stderr, "OBJ file contains invalid face indices\n");
-                            continue;
-                        }
-                        
-                        current_vertices[current_vertex_count].position = temp_vertices[vi];
-                        current_vertices[current_vertex_count].normal = temp_normals[ni];
-                        current_vertices[current_vertex_count].uv = (se_vec2){0.0f, 0.0f}; // Default UV
-                        
-                        current_indices[current_index_count] = current_vertex_count;
-                        current_vertex_count++;
-                        current_index_count++;
-                    }
-                }
-            }
+    // .glb is a 12 byte header followed by a JSON chunk and an optional binary chunk, each with an 8 byte header
+    const c8* json = (const c8*)file;
+    sz json_size = file_size;
+    const u8* bin = NULL;
+    sz bin_size = 0;
+    u32 header[3] = {0};
+    if (file_size >= sizeof(header)) {
+        memcpy(header, file, sizeof(header));
+    }
+    if (header[0] == SE_GLTF_MAGIC) {
+        u32 chunk[2] = {0};
+        if (file_size < 20 || (memcpy(chunk, file + 12, sizeof(chunk)), chunk[1] != SE_GLTF_CHUNK_JSON) || 20 + (sz)chunk[0] > file_size) {
+            fprintf(stderr, "se_model_load_gltf :: invalid glb file %s\n", path);
+            munmap(file, file_size);
+            return NULL;
+        }
+        json = (const c8*)file + 20;
+        json_size = chunk[0];
+        const sz bin_offset = 20 + json_size;
+        if (bin_offset + 8 <= file_size && (memcpy(chunk, file + bin_offset, sizeof(chunk)), chunk[1] == SE_GLTF_CHUNK_BIN) && bin_offset + 8 + chunk[0] <= file_size) {
+            bin = file + bin_offset + 8;
+            bin_size = chunk[0];
         }
     }
-    
-    // Finalize the last mesh
-    if (hse_faces && current_vertex_count > 0) {
-        const sz mesh_count = se_meshes_get_size(&model->meshes);
-        se_mesh* new_mesh = se_meshes_increment(&model->meshes);
-        finalize_mesh(new_mesh, current_vertices, current_indices, 
-                     current_vertex_count, current_index_count, shaders, mesh_count - 1);
+
+    se_gltf gltf = { .render_handle = render_handle, .shaders = shaders };
+    b8 success = se_json_parse(&gltf.document, json, json_size) && se_gltf_load_buffers(&gltf, full_path, bin, bin_size);
+    if (success) {
+        gltf.model = se_models_increment(&render_handle->models);
+        memset(gltf.model, 0, sizeof(se_model));
+        gltf.model->residency = render_handle->model_residency;
+        gltf.model->state = SE_ASSET_READY;
+
+        // default scene, or every root node when there is none
+        const se_json* scenes = se_json_get(gltf.document.root, "scenes");
+        const se_json* scene = se_json_at(scenes, (u32)se_json_get_number(gltf.document.root, "scene", 0));
+        const se_json* roots = se_json_get(scene, "nodes");
+        const se_mat4 identity = mat4_identity();
+        for (const se_json* root = roots ? roots->first_child : NULL; root && success; root = root->next) {
+            success = se_gltf_load_node(&gltf, (u32)root->value.number, &identity, 0);
+        }
+        if (success && se_meshes_get_size(&gltf.model->meshes) == 0) {
+            fprintf(stderr, "No valid meshes found in glTF file: %s\n", path);
+            success = false;
+        }
+        if (!success) {
+            se_model_cleanup(gltf.model);
+            se_models_remove_at(&render_handle->models, se_models_get_size(&render_handle->models) - 1);
+        } else {
+            printf("Model - loaded %s, %zu meshes, %u uploaded directly\n", path, se_meshes_get_size(&gltf.model->meshes), gltf.direct_uploads);
+            se_model_set_residency(gltf.model, gltf.model->residency);
+        }
     }
-    
-    fclose(file);
-    
-    // Cleanup temporary arrays
-    free(temp_vertices);
-    free(temp_normals);
-    free(temp_uvs);
-    free(current_vertices);
-    free(current_indices);
-    
-    // If no meshes were created, create a default one
-    if (se_meshes_get_size(&model->meshes) == 0) {
-        fprintf(stderr, "No valid meshes found in OBJ file: %s\n", path);
-        se_meshes_clear(&model->meshes);
-        return NULL;
+
+    for (u32 i = 0; i < gltf.buffer_count; i++) {
+        if (gltf.buffers[i].mapping) {
+            munmap(gltf.buffers[i].mapping, gltf.buffers[i].size);
+        } else if (gltf.buffers[i].owned) {
+            free((void*)gltf.buffers[i].data);
+        }
     }
-    
-    return model;
+    se_json_free(&gltf.document);
+    munmap(file, file_size);
+    return success ? gltf.model : NULL;
 }
 
 void se_model_render(se_render_handle* render_handle, se_model* model, se_camera* camera) {
-    // set up global view/proj once per frame
-    const se_mat4 proj = se_camera_get_projection_matrix(camera);
-    const se_mat4 view = se_camera_get_view_matrix(camera);
+    se_draw_list_begin(render_handle, camera);
+    se_draw_list_add_model(render_handle, model);
+    se_draw_list_submit(render_handle);
+}
+
+void se_model_cleanup(se_model* model) {
+    if (model->stream) {
+        se_model_stream_orphan(model);
+    }
     se_foreach(se_meshes, model->meshes, i) {
         se_mesh* mesh = se_meshes_get(&model->meshes, i);
-        se_shader* sh = mesh->shader;
-
-        se_shader_use(render_handle, sh, true, true);
-
-        se_mat4 vp  = mat4_mul(proj, view);
-        se_mat4 mvp = mat4_mul(vp, mesh->matrix); 
-
-        GLint loc_mvp = glGetUniformLocation(sh->program, "u_mvp");
-        if (loc_mvp >= 0) {
-            glUniformMatrix4fv(loc_mvp, 1, GL_FALSE, mvp.m);
+        if (mesh->pool) {
+            se_mesh_pool_free(mesh->pool, mesh->base_vertex, mesh->vertex_count, mesh->first_index, mesh->index_count);
         }
+        free(mesh->vertices);
+        free(mesh->indices);
+        free(mesh->clusters);
+        free(mesh->lods);
+    }
+    se_meshes_clear(&model->meshes);
+    model->state = SE_ASSET_READY;
+}
 
-        GLint loc_model = glGetUniformLocation(sh->program, "u_model");
-        if (loc_model >= 0) {
-            glUniformMatrix4fv(loc_model, 1, GL_FALSE, mesh->matrix.m);
+// Meshes get the shaders of the previous import back, in the same order
+static void se_model_reload(se_model* model, se_render_handle* render_handle) {
+    if (model->state != SE_ASSET_READY) {
+        return;
+    }
+    se_shaders_ptr shaders = {0};
+    se_foreach(se_meshes, model->meshes, i) {
+        se_shader* shader = se_meshes_get(&model->meshes, i)->shader;
+        if (shader) {
+            se_shaders_ptr_add(&shaders, shader);
         }
+    }
+    c8 path[SE_MAX_PATH_LENGTH] = {0};
+    memcpy(path, model->path, sizeof(path));
+    printf("Reloading model: %s\n", path);
+    se_model_cleanup(model);
+    if (!se_model_import_obj(model, path)) {
+        fprintf(stderr, "se_model_reload :: could not import %s\n", path);
+        model->state = SE_ASSET_FAILED;
+        return;
+    }
+    se_model_upload(render_handle, model, &shaders);
+}
 
-        // send to the GPU other uniforms (lights if forward rendering, etc)
+void se_model_set_residency(se_model* model, const se_model_residency residency) {
+    model->residency = residency;
+    if (residency == SE_MODEL_GPU_ONLY) {
+        se_model_release_cpu_data(model);
+    }
+}
 
-        // draw
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);  
-        glBindVertexArray(mesh->vao);
-        glDrawElements(GL_TRIANGLES, mesh->index_count, GL_UNSIGNED_INT, 0);
+b8 se_model_fetch_cpu_data(se_model* model) {
+    b8 complete = true;
+    se_foreach(se_meshes, model->meshes, i) {
+        complete &= se_meshes_get(&model->meshes, i)->vertices != NULL;
     }
-    // unbind
-    glBindVertexArray(0);
-    glUseProgram(0);
+    if (complete) {
+        return true;
+    }
+
+    // cooked cache first, it avoids stalling on the GPU
+    if (model->cache_path[0] != '\0' && se_model_cache_read_cpu_data(model)) {
+        return true;
+    }
+    se_foreach(se_meshes, model->meshes, i) {
+        se_mesh* mesh = se_meshes_get(&model->meshes, i);
+        if (mesh->vertices != NULL) {
+            continue;
+        }
+        if (mesh->pool == NULL) {
+            fprintf(stderr, "se_model_fetch_cpu_data :: mesh %zu was never uploaded\n", i);
+            return false;
+        }
+        free(mesh->indices);
+        mesh->vertices = malloc(mesh->vertex_count * sizeof(se_vertex));
+        mesh->indices = malloc(mesh->index_count * sizeof(u32));
+        glBindBuffer(GL_ARRAY_BUFFER, mesh->pool->vbo);
+        glGetBufferSubData(GL_ARRAY_BUFFER, mesh->base_vertex * sizeof(se_vertex), mesh->vertex_count * sizeof(se_vertex), mesh->vertices);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh->pool->ebo);
+        glGetBufferSubData(GL_ARRAY_BUFFER, mesh->first_index * sizeof(u32), mesh->index_count * sizeof(u32), mesh->indices);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    return true;
 }
 
-void se_model_cleanup(se_model* model) {
+void se_model_release_cpu_data(se_model* model) {
     se_foreach(se_meshes, model->meshes, i) {
         se_mesh* mesh = se_meshes_get(&model->meshes, i);
-        glDeleteVertexArrays(1, &mesh->vao);
-        glDeleteBuffers(1, &mesh->vbo);
-        glDeleteBuffers(1, &mesh->ebo);
         free(mesh->vertices);
         free(mesh->indices);
+        mesh->vertices = NULL;
+        mesh->indices = NULL;
     }
-    se_meshes_clear(&model->meshes);
 }
 
 void se_model_translate(se_model* model, const se_vec3* v){
@@ -561,6 +3485,306 @@ void se_model_scale(se_model* model, const se_vec3* v){
     }
 }
 
+// Draw list functions
+void se_draw_list_begin(se_render_handle* render_handle, se_camera* camera) {
+    se_draw_list* draw_list = &render_handle->draw_list;
+    draw_list->item_count = 0;
+    draw_list->transform_count = 0;
+
+    draw_list->view = se_camera_get_view_matrix(camera);
+    draw_list->projection = se_camera_get_projection_matrix(camera);
+    draw_list->view_projection = mat4_mul(draw_list->projection, draw_list->view);
+    draw_list->frustum = se_frustum_from_matrix(&draw_list->view_projection);
+    draw_list->camera_position = camera->position;
+
+    GLint viewport[4] = {0};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    draw_list->lod_pixel_scale = viewport[3] * 0.5f * draw_list->projection.m[5];
+}
+
+// projected error of a level in pixels, the band around the threshold keeps the choice stable
+static u32 se_draw_list_select_lod(se_draw_list* draw_list, se_mesh* mesh, const se_vec3 center, const f32 radius, const f32 scale) {
+    if (mesh->lod_count <= 1) {
+        return 0;
+    }
+    const f32 distance = max(vec3_length(vec3_sub(center, draw_list->camera_position)) - radius, 1e-3f);
+    const f32 pixels_per_unit = scale * draw_list->lod_pixel_scale / distance;
+
+    u32 lod = min(mesh->current_lod, mesh->lod_count - 1);
+    while (lod > 0 && mesh->lods[lod].error * pixels_per_unit > SE_LOD_PIXEL_ERROR * (1.0f + SE_LOD_HYSTERESIS)) {
+        lod--;
+    }
+    while (lod + 1 < mesh->lod_count && mesh->lods[lod + 1].error * pixels_per_unit <= SE_LOD_PIXEL_ERROR * (1.0f - SE_LOD_HYSTERESIS)) {
+        lod++;
+    }
+    mesh->current_lod = lod;
+    return lod;
+}
+
+// doubles capacity until count fits, false past SE_MAX_DRAWS
+static b8 se_draw_list_reserve(void** data, u32* capacity, const u32 count, const sz element_size) {
+    if (count <= *capacity) {
+        return true;
+    }
+    if (count > SE_MAX_DRAWS) {
+        return false;
+    }
+    u32 new_capacity = *capacity > 0 ? *capacity : 256;
+    while (new_capacity < count) {
+        new_capacity *= 2;
+    }
+    new_capacity = min(new_capacity, (u32)SE_MAX_DRAWS);
+    *data = realloc(*data, new_capacity * element_size);
+    *capacity = new_capacity;
+    return true;
+}
+
+// adds a draw, or extends the previous one when it continues the same index range (adjacent visible clusters)
+static void se_draw_list_push(se_draw_list* draw_list, se_shader* shader, const u32 first_index, const u32 index_count, const i32 base_vertex, const u32 transform_index) {
+    if (draw_list->item_count > 0) {
+        se_draw_item* last = &draw_list->items[draw_list->item_count - 1];
+        if (last->shader == shader && last->transform_index == transform_index && last->base_vertex == base_vertex &&
+            last->first_index + last->index_count == first_index) {
+            last->index_count += index_count;
+            return;
+        }
+    }
+    if (!se_draw_list_reserve((void**)&draw_list->items, &draw_list->item_capacity, draw_list->item_count + 1, sizeof(se_draw_item))) {
+        static b8 reported = false;
+        if (!reported) {
+            fprintf(stderr, "se_draw_list_push :: draw list is full (%d), dropping draws\n", SE_MAX_DRAWS);
+            reported = true;
+        }
+        return;
+    }
+    se_draw_item* item = &draw_list->items[draw_list->item_count++];
+    item->shader = shader;
+    item->first_index = first_index;
+    item->index_count = index_count;
+    item->base_vertex = base_vertex;
+    item->transform_index = transform_index;
+}
+
+// Falls back to a single draw of the whole mesh when its visible clusters don't fit in the list
+static void se_draw_list_add_mesh_clusters(se_draw_list* draw_list, se_mesh* mesh, const u32 transform_index) {
+    const f32 scale = mat4_max_scale(&mesh->matrix);
+    const u32 first_item = draw_list->item_count;
+    for (u32 i = 0; i < mesh->cluster_count; i++) {
+        if (draw_list->item_count >= SE_MAX_DRAWS) {
+            static b8 reported = false;
+            if (!reported && first_item < SE_MAX_DRAWS) {
+                fprintf(stderr, "se_draw_list_add_mesh_clusters :: visible clusters exceed the draw list (%d), drawing whole meshes\n", SE_MAX_DRAWS);
+                reported = true;
+            }
+            draw_list->item_count = first_item;
+            se_draw_list_push(draw_list, mesh->shader, mesh->first_index + mesh->lods[0].first_index, mesh->lods[0].index_count, (i32)mesh->base_vertex, transform_index);
+            return;
+        }
+        const se_mesh_cluster* cluster = &mesh->clusters[i];
+        const se_vec3 center = mat4_transform_point(&mesh->matrix, cluster->center);
+        const f32 radius = cluster->radius * scale;
+        if (!se_frustum_test_sphere(&draw_list->frustum, center, radius)) {
+            continue;
+        }
+        // back facing cone test, the cluster can be skipped when every triangle faces away from the camera
+        if (cluster->cone_cutoff < 1.0f) {
+            se_vec3 axis = mat4_transform_normal(&mesh->matrix, cluster->cone_axis);
+            const f32 axis_length = vec3_length(axis);
+            if (axis_length > 0.0f) {
+                axis = vec3_scale(axis, 1.0f / axis_length);
+                const se_vec3 to_center = vec3_sub(center, draw_list->camera_position);
+                if (vec3_dot(to_center, axis) >= cluster->cone_cutoff * vec3_length(to_center) + radius) {
+                    continue;
+                }
+            }
+        }
+        se_draw_list_push(draw_list, mesh->shader, mesh->first_index + cluster->first_index, cluster->index_count, (i32)mesh->base_vertex, transform_index);
+    }
+}
+
+void se_draw_list_add_model(se_render_handle* render_handle, se_model* model) {
+    se_draw_list* draw_list = &render_handle->draw_list;
+    if (model->state != SE_ASSET_READY) {
+        return;
+    }
+    se_foreach(se_meshes, model->meshes, i) {
+        se_mesh* mesh = se_meshes_get(&model->meshes, i);
+        if (mesh->shader == NULL || mesh->shader->program == 0 || mesh->index_count == 0) {
+            continue;
+        }
+
+        const f32 scale = mat4_max_scale(&mesh->matrix);
+        const se_vec3 center = mat4_transform_point(&mesh->matrix, mesh->bounds_center);
+        const f32 radius = mesh->bounds_radius * scale;
+        if (!se_frustum_test_sphere(&draw_list->frustum, center, radius)) {
+            continue;
+        }
+
+        if (!se_draw_list_reserve((void**)&draw_list->transforms, &draw_list->transform_capacity, draw_list->transform_count + 1, sizeof(se_mat4))) {
+            fprintf(stderr, "se_draw_list_add_model :: draw list is full (%d)\n", SE_MAX_DRAWS);
+            return;
+        }
+        const u32 transform_index = draw_list->transform_count++;
+        draw_list->transforms[transform_index] = mesh->matrix;
+
+        const u32 lod = se_draw_list_select_lod(draw_list, mesh, center, radius, scale);
+        if (lod == 0 && mesh->cluster_count > 0) {
+            se_draw_list_add_mesh_clusters(draw_list, mesh, transform_index);
+        } else {
+            const se_mesh_lod* level = &mesh->lods[lod];
+            se_draw_list_push(draw_list, mesh->shader, mesh->first_index + level->first_index, level->index_count, (i32)mesh->base_vertex, transform_index);
+        }
+    }
+}
+
+static i32 se_draw_item_compare(const void* a, const void* b) {
+    const se_draw_item* item_a = a;
+    const se_draw_item* item_b = b;
+    if (item_a->shader != item_b->shader) {
+        return item_a->shader < item_b->shader ? -1 : 1;
+    }
+    return (item_a->first_index > item_b->first_index) - (item_a->first_index < item_b->first_index);
+}
+
+static void se_draw_list_init(se_render_handle* render_handle) {
+    se_draw_list* draw_list = &render_handle->draw_list;
+    const se_ring_buffer* ring = se_render_handle_get_dynamic_data(render_handle);
+    glGenTextures(1, &draw_list->transform_texture);
+    glBindTexture(GL_TEXTURE_BUFFER, draw_list->transform_texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, ring->buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void se_draw_list_submit(se_render_handle* render_handle) {
+    se_draw_list* draw_list = &render_handle->draw_list;
+    const sz item_count = draw_list->item_count;
+    if (item_count == 0) {
+        return;
+    }
+    if (draw_list->transform_texture == 0) {
+        se_draw_list_init(render_handle);
+    }
+    se_ring_buffer* ring = &render_handle->dynamic_data;
+
+    qsort(draw_list->items, item_count, sizeof(se_draw_item), se_draw_item_compare);
+
+    // per draw data goes to the dynamic ring, draws find their transform at the ring offset plus their index
+    sz transforms_offset = 0;
+    se_mat4* transforms = se_ring_buffer_alloc(ring, max(draw_list->transform_count, 1) * sizeof(se_mat4), sizeof(se_mat4), &transforms_offset);
+    if (!transforms) {
+        draw_list->item_count = 0;
+        draw_list->transform_count = 0;
+        return;
+    }
+    memcpy(transforms, draw_list->transforms, draw_list->transform_count * sizeof(se_mat4));
+    const u32 transform_base = (u32)(transforms_offset / sizeof(se_mat4));
+
+    // sized like the items, they only grow
+    draw_list->commands = realloc(draw_list->commands, draw_list->item_capacity * sizeof(se_draw_command));
+    for (sz i = 0; i < item_count; i++) {
+        const se_draw_item* item = &draw_list->items[i];
+        se_draw_command* command = &draw_list->commands[i];
+        command->count = item->index_count;
+        command->instance_count = 1;
+        command->first_index = item->first_index;
+        command->base_vertex = item->base_vertex;
+        command->base_instance = transform_base + item->transform_index;
+    }
+    sz commands_offset = 0;
+    if (se_gl_caps.multi_draw_indirect) {
+        se_draw_command* commands = se_ring_buffer_alloc(ring, item_count * sizeof(se_draw_command), sizeof(u32), &commands_offset);
+        if (!commands) {
+            draw_list->item_count = 0;
+            draw_list->transform_count = 0;
+            return;
+        }
+        memcpy(commands, draw_list->commands, item_count * sizeof(se_draw_command));
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, ring->buffer);
+    }
+    se_ring_buffer_flush(ring);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+    glFrontFace(GL_CCW);
+    glBindVertexArray(render_handle->mesh_pool.vao);
+
+    sz run_start = 0;
+    while (run_start < item_count) {
+        se_shader* shader = draw_list->items[run_start].shader;
+        sz run_end = run_start + 1;
+        while (run_end < item_count && draw_list->items[run_end].shader == shader) {
+            run_end++;
+        }
+        const se_draw_command* commands = &draw_list->commands[run_start];
+        const sz run_count = run_end - run_start;
+
+        se_shader_use(render_handle, shader, true, true);
+
+        const GLint loc_transforms = glGetUniformLocation(shader->program, "u_transforms");
+        if (loc_transforms >= 0) {
+            // batched path: transforms are fetched by draw id in the vertex shader
+            glActiveTexture(GL_TEXTURE0 + SE_DRAW_TRANSFORMS_TEXTURE_UNIT);
+            glBindTexture(GL_TEXTURE_BUFFER, draw_list->transform_texture);
+            glActiveTexture(GL_TEXTURE0 + SE_TEXTURE_SCRATCH_UNIT);
+            glUniform1i(loc_transforms, SE_DRAW_TRANSFORMS_TEXTURE_UNIT);
+            const GLint loc_vp = glGetUniformLocation(shader->program, "u_view_projection");
+            if (loc_vp >= 0) {
+                glUniformMatrix4fv(loc_vp, 1, GL_FALSE, draw_list->view_projection.m);
+            }
+
+            if (se_gl_caps.multi_draw_indirect) {
+                glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(commands_offset + run_start * sizeof(se_draw_command)), run_count, 0);
+            } else {
+                for (sz i = 0; i < run_count; i++) {
+                    glVertexAttribI1ui(3, commands[i].base_instance);
+                    glDrawElementsBaseVertex(GL_TRIANGLES, commands[i].count, GL_UNSIGNED_INT, (void*)(commands[i].first_index * sizeof(u32)), commands[i].base_vertex);
+                }
+            }
+        } else {
+            // per draw uniforms for shaders that only know u_mvp/u_model
+            const GLint loc_mvp = glGetUniformLocation(shader->program, "u_mvp");
+            const GLint loc_model = glGetUniformLocation(shader->program, "u_model");
+            for (sz i = 0; i < run_count; i++) {
+                const se_mat4* model_matrix = &draw_list->transforms[commands[i].base_instance - transform_base];
+                if (loc_mvp >= 0) {
+                    const se_mat4 mvp = mat4_mul(draw_list->view_projection, *model_matrix);
+                    glUniformMatrix4fv(loc_mvp, 1, GL_FALSE, mvp.m);
+                }
+                if (loc_model >= 0) {
+                    glUniformMatrix4fv(loc_model, 1, GL_FALSE, model_matrix->m);
+                }
+                glDrawElementsBaseVertex(GL_TRIANGLES, commands[i].count, GL_UNSIGNED_INT, (void*)(commands[i].first_index * sizeof(u32)), commands[i].base_vertex);
+            }
+        }
+        run_start = run_end;
+    }
+
+    // the ring can reuse what these draws read once they're done
+    se_ring_buffer_fence(ring);
+
+    // unbind
+    if (se_gl_caps.multi_draw_indirect) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    glBindVertexArray(0);
+    glUseProgram(0);
+    draw_list->item_count = 0;
+    draw_list->transform_count = 0;
+}
+
+void se_draw_list_cleanup(se_draw_list* draw_list) {
+    if (draw_list->transform_texture) {
+        glDeleteTextures(1, &draw_list->transform_texture);
+        draw_list->transform_texture = 0;
+    }
+    free(draw_list->items);
+    free(draw_list->commands);
+    free(draw_list->transforms);
+    memset(draw_list, 0, sizeof(se_draw_list));
+}
+
 // camera functions
 se_camera* se_camera_create(se_render_handle* render_handle) {
     se_camera* camera = se_cameras_increment(&render_handle->cameras);
@@ -590,39 +3814,201 @@ void se_camera_destroy(se_render_handle* render_handle, se_camera* camera) {
     se_cameras_remove(&render_handle->cameras, camera);
 }
  
-// Framebuffer functions
-se_framebuffer* se_framebuffer_create(se_render_handle* render_handle, const se_vec2* size) {
-    se_framebuffer* framebuffer = se_framebuffers_increment(&render_handle->framebuffers);
-    framebuffer->size = *size;
+// Render target functions
+
+static void se_target_format_get_gl(const se_target_format format, GLenum* out_internal_format, GLenum* out_format, GLenum* out_type, u32* out_bytes) {
+    switch (format) {
+        case SE_TARGET_FORMAT_R8:
+            *out_internal_format = GL_R8; *out_format = GL_RED; *out_type = GL_UNSIGNED_BYTE; *out_bytes = 1;
+            return;
+        case SE_TARGET_FORMAT_RG16F:
+            *out_internal_format = GL_RG16F; *out_format = GL_RG; *out_type = GL_HALF_FLOAT; *out_bytes = 4;
+            return;
+        case SE_TARGET_FORMAT_RGBA16F:
+            *out_internal_format = GL_RGBA16F; *out_format = GL_RGBA; *out_type = GL_HALF_FLOAT; *out_bytes = 8;
+            return;
+        case SE_TARGET_FORMAT_R11G11B10F:
+            *out_internal_format = GL_R11F_G11F_B10F; *out_format = GL_RGB; *out_type = GL_HALF_FLOAT; *out_bytes = 4;
+            return;
+        case SE_TARGET_FORMAT_RGBA8:
+        default:
+            *out_internal_format = GL_RGBA8; *out_format = GL_RGBA; *out_type = GL_UNSIGNED_BYTE; *out_bytes = 4;
+            return;
+    }
+}
+
+static u32 se_render_target_color_count(const se_render_target_desc* desc) {
+    return desc->color_count == 0 ? 1 : min(desc->color_count, (u32)SE_MAX_TARGET_ATTACHMENTS);
+}
+
+b8 se_render_target_desc_match(const se_render_target_desc* a, const se_render_target_desc* b) {
+    const u32 color_count = se_render_target_color_count(a);
+    if (a->size.x != b->size.x || a->size.y != b->size.y || a->depth != b->depth || color_count != se_render_target_color_count(b)) {
+        return false;
+    }
+    for (u32 i = 0; i < color_count; i++) {
+        if (a->color_formats[i] != b->color_formats[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+sz se_render_target_desc_get_size(const se_render_target_desc* desc) {
+    sz pixel_size = desc->depth == SE_TARGET_DEPTH_NONE ? 0 : 4;
+    for (u32 i = 0; i < se_render_target_color_count(desc); i++) {
+        GLenum internal_format, format, type;
+        u32 bytes = 0;
+        se_target_format_get_gl(desc->color_formats[i], &internal_format, &format, &type, &bytes);
+        pixel_size += bytes;
+    }
+    return (sz)desc->size.x * (sz)desc->size.y * pixel_size;
+}
+
+static GLuint se_render_target_create_depth(const se_render_target_desc* desc) {
+    if (desc->depth == SE_TARGET_DEPTH_NONE) {
+        return 0;
+    }
+    GLuint depth_buffer = 0;
+    glGenRenderbuffers(1, &depth_buffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_buffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, desc->depth == SE_TARGET_DEPTH_STENCIL ? GL_DEPTH24_STENCIL8 : GL_DEPTH_COMPONENT24, desc->size.x, desc->size.y);
+    return depth_buffer;
+}
+
+// To the bound framebuffer
+static void se_render_target_attach_depth(const se_target_depth depth, const GLuint depth_buffer) {
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, depth == SE_TARGET_DEPTH_STENCIL ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_buffer);
+}
+
+static void se_render_target_free(se_render_target* target) {
+    if (target->framebuffer) {
+        glDeleteFramebuffers(1, &target->framebuffer);
+        target->framebuffer = 0;
+    }
+    glDeleteTextures(SE_MAX_TARGET_ATTACHMENTS, target->textures); // unused slots are 0, which is ignored
+    memset(target->textures, 0, sizeof(target->textures));
+    if (target->depth_buffer) {
+        glDeleteRenderbuffers(1, &target->depth_buffer);
+        target->depth_buffer = 0;
+    }
+}
+
+// Allocates the attachments of target->desc, the new framebuffer is left bound
+static b8 se_render_target_build(se_render_target* target) {
+    const se_render_target_desc* desc = &target->desc;
+    const u32 color_count = se_render_target_color_count(desc);
+    GLenum draw_buffers[SE_MAX_TARGET_ATTACHMENTS];
+
+    glGenFramebuffers(1, &target->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+    glGenTextures(color_count, target->textures);
+    for (u32 i = 0; i < color_count; i++) {
+        GLenum internal_format, format, type;
+        u32 bytes = 0;
+        se_target_format_get_gl(desc->color_formats[i], &internal_format, &format, &type, &bytes);
+        glBindTexture(GL_TEXTURE_2D, target->textures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, desc->size.x, desc->size.y, 0, format, type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, target->textures[i], 0);
+        draw_buffers[i] = GL_COLOR_ATTACHMENT0 + i;
+    }
+    if (color_count > 1) {
+        glDrawBuffers(color_count, draw_buffers);
+    }
+    target->depth_buffer = se_render_target_create_depth(desc);
+    if (target->depth_buffer) {
+        se_render_target_attach_depth(desc->depth, target->depth_buffer);
+    }
 
-    // Create framebuffer
-    glGenFramebuffers(1, &framebuffer->framebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer->framebuffer);
-    
-    // Create color texture
-    glGenTextures(1, &framebuffer->texture);
-    glBindTexture(GL_TEXTURE_2D, framebuffer->texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size->x, size->y, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, framebuffer->texture, 0);
-    
-    // Create depth buffer
-    glGenRenderbuffers(1, &framebuffer->depth_buffer);
-    glBindRenderbuffer(GL_RENDERBUFFER, framebuffer->depth_buffer);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, size->x, size->y);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, framebuffer->depth_buffer);
-   
-    // Check framebuffer completeness
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        fprintf(stderr, "Framebuffer not complete!\n");
-        se_framebuffer_cleanup(framebuffer);
+        fprintf(stderr, "se_render_target_build :: framebuffer not complete, %.0fx%.0f with %u color attachments\n", desc->size.x, desc->size.y, color_count);
+        se_render_target_free(target);
         return false;
     }
-    
+    return true;
+}
+
+// Released targets stay allocated for SE_RENDER_TARGET_IDLE_FRAMES and are handed out again for a matching desc
+se_render_target* se_render_target_acquire(se_render_handle* render_handle, const se_render_target_desc* desc) {
+    se_render_target* empty = NULL;
+    se_foreach(se_render_targets, render_handle->render_targets, i) {
+        se_render_target* target = se_render_targets_get(&render_handle->render_targets, i);
+        if (target->in_use) {
+            continue;
+        }
+        if (target->framebuffer && se_render_target_desc_match(&target->desc, desc)) {
+            target->in_use = true;
+            target->last_used_frame = render_handle->frame;
+            return target;
+        }
+        if (target->framebuffer == 0 && empty == NULL) {
+            empty = target;
+        }
+    }
+    if (empty == NULL) {
+        empty = se_render_targets_increment(&render_handle->render_targets);
+    }
+    if (empty == NULL) {
+        fprintf(stderr, "se_render_target_acquire :: too many targets, max is %d\n", SE_MAX_RENDER_TARGETS);
+        return NULL;
+    }
+
+    se_render_handle_reset_texture_bindings(render_handle);
+    memset(empty, 0, sizeof(se_render_target));
+    empty->desc = *desc;
+    GLint framebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    const b8 built = se_render_target_build(empty);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    if (!built) {
+        return NULL; // the slot stays free
+    }
+    empty->in_use = true;
+    empty->last_used_frame = render_handle->frame;
+    return empty;
+}
+
+void se_render_target_release(se_render_handle* render_handle, se_render_target* target) {
+    target->in_use = false;
+    target->last_used_frame = render_handle->frame;
+}
+
+static void se_render_handle_trim_render_targets(se_render_handle* render_handle) {
+    se_foreach(se_render_targets, render_handle->render_targets, i) {
+        se_render_target* target = se_render_targets_get(&render_handle->render_targets, i);
+        if (!target->in_use && target->framebuffer && render_handle->frame - target->last_used_frame > SE_RENDER_TARGET_IDLE_FRAMES) {
+            se_render_target_free(target);
+        }
+    }
+}
+
+// Framebuffer functions
+se_framebuffer* se_framebuffer_create(se_render_handle* render_handle, const se_vec2* size) {
+    const se_render_target_desc desc = { .size = *size, .depth = SE_TARGET_DEPTH };
+    return se_framebuffer_create_desc(render_handle, &desc);
+}
+
+se_framebuffer* se_framebuffer_create_desc(se_render_handle* render_handle, const se_render_target_desc* desc) {
+    se_render_handle_reset_texture_bindings(render_handle);
+    se_framebuffer* framebuffer = se_framebuffers_increment(&render_handle->framebuffers);
+    memset(framebuffer, 0, sizeof(se_framebuffer));
+
+    se_render_target target = { .desc = *desc };
+    const b8 built = se_render_target_build(&target);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!built) {
+        return NULL;
+    }
+    framebuffer->framebuffer = target.framebuffer;
+    framebuffer->texture = target.textures[0];
+    framebuffer->depth_buffer = target.depth_buffer;
+    framebuffer->size = desc->size;
+    memcpy(framebuffer->textures, target.textures, sizeof(framebuffer->textures));
+    framebuffer->desc = *desc;
     return framebuffer;
 }
 
@@ -647,10 +4033,9 @@ void se_framebuffer_cleanup(se_framebuffer* framebuffer) {
         glDeleteFramebuffers(1, &framebuffer->framebuffer);
         framebuffer->framebuffer = 0;
     }
-    if (framebuffer->texture) {
-        glDeleteTextures(1, &framebuffer->texture);
-        framebuffer->texture = 0;
-    }
+    glDeleteTextures(SE_MAX_TARGET_ATTACHMENTS, framebuffer->textures);
+    memset(framebuffer->textures, 0, sizeof(framebuffer->textures));
+    framebuffer->texture = 0;
     if (framebuffer->depth_buffer) {
         glDeleteRenderbuffers(1, &framebuffer->depth_buffer);
         framebuffer->depth_buffer = 0;
@@ -658,78 +4043,85 @@ void se_framebuffer_cleanup(se_framebuffer* framebuffer) {
 }
 
 // Render buffer functions
+
+static void se_render_buffer_sync(se_render_buffer* buffer) {
+    buffer->framebuffer = buffer->target.framebuffer;
+    buffer->texture = buffer->target.textures[0];
+    buffer->prev_framebuffer = buffer->prev_target.framebuffer;
+    buffer->prev_texture = buffer->prev_target.textures[0];
+}
+
+// Both sets of color attachments share the buffer's depth
+static b8 se_render_buffer_build_target(se_render_buffer* buffer, se_render_target* target) {
+    memset(target, 0, sizeof(se_render_target));
+    target->desc = buffer->desc;
+    target->desc.depth = SE_TARGET_DEPTH_NONE;
+    if (!se_render_target_build(target)) {
+        return false;
+    }
+    if (buffer->depth_buffer) {
+        se_render_target_attach_depth(buffer->desc.depth, buffer->depth_buffer);
+    }
+    return true;
+}
+
+// The second set only exists while the shader reads u_prev
+static void se_render_buffer_update_history(se_render_buffer* buffer) {
+    if (buffer->history && buffer->prev_target.framebuffer == 0 && buffer->target.framebuffer) {
+        GLint framebuffer = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+        if (se_render_buffer_build_target(buffer, &buffer->prev_target)) {
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    } else if (!buffer->history && buffer->prev_target.framebuffer) {
+        se_render_target_free(&buffer->prev_target);
+    }
+    se_render_buffer_sync(buffer);
+}
+
+static b8 se_render_buffer_shader_reads_prev(const se_shader* shader) {
+    return shader && shader->program && glGetUniformLocation(shader->program, "u_prev") != -1;
+}
+
 se_render_buffer* se_render_buffer_create(se_render_handle* render_handle, const u32 width, const u32 height, const c8* fragment_shader_path) {
+    const se_render_target_desc desc = { .size = se_vec(2, width, height), .depth = SE_TARGET_DEPTH };
+    return se_render_buffer_create_desc(render_handle, &desc, fragment_shader_path);
+}
+
+se_render_buffer* se_render_buffer_create_desc(se_render_handle* render_handle, const se_render_target_desc* desc, const c8* fragment_shader_path) {
+    se_render_handle_reset_texture_bindings(render_handle);
     se_render_buffer* buffer = se_render_buffers_increment(&render_handle->render_buffers);
-   
-    buffer->texture_size = se_vec(2, width, height);
+    memset(buffer, 0, sizeof(se_render_buffer));
+    buffer->desc = *desc;
+    buffer->texture_size = desc->size;
     buffer->scale = se_vec(2, 1., 1.);
     buffer->position = se_vec(2, 0., 0.);
+    buffer->frame = &render_handle->frame;
+    buffer->swap_frame = UINT64_MAX;
 
-    // Create framebuffer
-    glGenFramebuffers(1, &buffer->framebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, buffer->framebuffer);
-    
-    // Create color texture
-    glGenTextures(1, &buffer->texture);
-    glBindTexture(GL_TEXTURE_2D, buffer->texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, buffer->texture, 0);
-    
-    // Create depth buffer
-    glGenRenderbuffers(1, &buffer->depth_buffer);
-    glBindRenderbuffer(GL_RENDERBUFFER, buffer->depth_buffer);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width, height);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, buffer->depth_buffer);
-    
-    // Create previous texture
-    glGenTextures(1, &buffer->prev_texture);
-    glBindTexture(GL_TEXTURE_2D, buffer->prev_texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-   
-    // Create framebuffer for previous frame (for easy copying)
-    glGenFramebuffers(1, &buffer->prev_framebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, buffer->prev_framebuffer);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, buffer->prev_texture, 0);
+    buffer->depth_buffer = se_render_target_create_depth(desc);
+    if (!se_render_buffer_build_target(buffer, &buffer->target)) {
+        se_render_buffer_cleanup(buffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return NULL;
+    }
+    se_render_buffer_sync(buffer);
 
     buffer->shader = se_shader_load(render_handle, "shaders/render_buffer_vert.glsl", fragment_shader_path);
+    buffer->history = desc->history || se_render_buffer_shader_reads_prev(buffer->shader);
+    se_render_buffer_update_history(buffer);
 
-    // Check framebuffer completeness
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        fprintf(stderr, "Framebuffer not complete!\n");
-        se_render_buffer_cleanup(buffer);
-        return false;
-    }
-    
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     return buffer;
 }
 
-void se_render_buffer_copy_to_previous(se_render_buffer* buffer) {
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, buffer->framebuffer);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, buffer->prev_framebuffer);
-    
-    glBlitFramebuffer(
-        0, 0, buffer->texture_size.x, buffer->texture_size.y,  // Source rectangle
-        0, 0, buffer->texture_size.x, buffer->texture_size.y,  // Destination rectangle
-        GL_COLOR_BUFFER_BIT,                  // Copy color buffer
-        GL_NEAREST                            // Use nearest filtering for exact copy
-    );
-    
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-}
-
 void se_render_buffer_set_shader(se_render_buffer* buffer, se_shader* shader) {
     se_assert(buffer && shader);
     buffer->shader = shader;
+    buffer->history = buffer->desc.history || se_render_buffer_shader_reads_prev(shader);
+    se_render_buffer_update_history(buffer);
 }
 
 void se_render_buffer_unset_shader(se_render_buffer* buffer) {
@@ -737,11 +4129,28 @@ void se_render_buffer_unset_shader(se_render_buffer* buffer) {
     buffer->shader = NULL;
 }
 
+void se_render_buffer_set_history(se_render_buffer* buffer, const b8 history) {
+    buffer->history = history;
+    se_render_buffer_update_history(buffer);
+}
+
 void se_render_buffer_bind(se_render_buffer* buffer) {
-    se_render_buffer_copy_to_previous(buffer);
+    if (buffer->prev_framebuffer && buffer->swap_frame != *buffer->frame) {
+        // last frame's output becomes u_prev and this frame draws over the older one, later binds keep drawing into it
+        buffer->swap_frame = *buffer->frame;
+        const se_render_target target = buffer->target;
+        buffer->target = buffer->prev_target;
+        buffer->prev_target = target;
+        se_render_buffer_sync(buffer);
+    }
     glBindFramebuffer(GL_FRAMEBUFFER, buffer->framebuffer);
     glViewport(0, 0, buffer->texture_size.x, buffer->texture_size.y);
-    se_shader_set_texture(buffer->shader, "u_prev", buffer->prev_texture);
+    if (buffer->shader == NULL) {
+        return;
+    }
+    if (buffer->prev_framebuffer) {
+        se_shader_set_texture(buffer->shader, "u_prev", buffer->prev_texture);
+    }
     se_shader_set_vec2(buffer->shader, "u_scale", &buffer->scale);
     se_shader_set_vec2(buffer->shader, "u_position", &buffer->position);
     se_shader_set_vec2(buffer->shader, "u_texture_size", &buffer->texture_size);
@@ -760,18 +4169,14 @@ void se_render_buffer_set_position(se_render_buffer* buffer, const se_vec2* posi
 }
 
 void se_render_buffer_cleanup(se_render_buffer* buffer) {
-    if (buffer->framebuffer) {
-        glDeleteFramebuffers(1, &buffer->framebuffer);
-        buffer->framebuffer = 0;
-    }
-    if (buffer->texture) {
-        glDeleteTextures(1, &buffer->texture);
-        buffer->texture = 0;
-    }
+    se_render_target_free(&buffer->target);
+    se_render_target_free(&buffer->prev_target);
     if (buffer->depth_buffer) {
         glDeleteRenderbuffers(1, &buffer->depth_buffer);
         buffer->depth_buffer = 0;
     }
+    buffer->history = false;
+    se_render_buffer_sync(buffer);
 }
 
 // Uniform functions
@@ -850,30 +4255,122 @@ void se_uniform_set_int(se_uniforms* uniforms, const char* name, i32 value) {
     new_uniform->value.i = value;
 }
 
-void se_uniform_set_texture(se_uniforms* uniforms, const char* name, GLuint texture) {
+static void se_uniform_set_sampled(se_uniforms* uniforms, const char* name, const se_uniform_type type, GLuint texture, GLuint sampler) {
     // TODO: IMPORTANT: SEG FAULT HERE in 2025-08-24, audio_example.c:45
     se_foreach(se_uniforms, *uniforms, i) {
         se_uniform* found_uniform = se_uniforms_get(uniforms, i);
         if (found_uniform && strcmp(found_uniform->name, name) == 0) {
-            found_uniform->type = SE_UNIFORM_TEXTURE;
+            found_uniform->type = type;
             found_uniform->value.texture = texture;
+            found_uniform->sampler = sampler;
             return;
             
         }
     }
     se_uniform* new_uniform = se_uniforms_increment(uniforms);
     strncpy(new_uniform->name, name, sizeof(new_uniform->name) - 1);
-    new_uniform->type = SE_UNIFORM_TEXTURE;
+    new_uniform->type = type;
     new_uniform->value.texture = texture;
+    new_uniform->sampler = sampler;
 }
 
+void se_uniform_set_texture(se_uniforms* uniforms, const char* name, GLuint texture) {
+    se_uniform_set_sampled(uniforms, name, SE_UNIFORM_TEXTURE, texture, 0);
+}
+
+// Resolved at apply: async loads and streaming replace the id, atlas packing the rect, binding marks the texture used
+static void se_uniform_set_texture_asset(se_uniforms* uniforms, const char* name, const se_uniform_type type, se_texture* texture) {
+    se_uniform* uniform = NULL;
+    se_foreach(se_uniforms, *uniforms, i) {
+        se_uniform* found_uniform = se_uniforms_get(uniforms, i);
+        if (found_uniform && strcmp(found_uniform->name, name) == 0) {
+            uniform = found_uniform;
+            break;
+        }
+    }
+    if (uniform == NULL) {
+        uniform = se_uniforms_increment(uniforms);
+        strncpy(uniform->name, name, sizeof(uniform->name) - 1);
+    }
+    uniform->type = type;
+    uniform->value.texture_asset = texture;
+    uniform->sampler = 0;
+}
+
+void se_uniform_set_texture_ref(se_uniforms* uniforms, const char* name, se_texture* texture) {
+    se_uniform_set_texture_asset(uniforms, name, SE_UNIFORM_TEXTURE_REF, texture);
+}
+
+void se_uniform_set_texture_region(se_uniforms* uniforms, const char* name, se_texture* texture) {
+    c8 rect_name[SE_MAX_NAME_LENGTH];
+    snprintf(rect_name, sizeof(rect_name), "%s_rect", name);
+    se_uniform_set_texture_asset(uniforms, name, SE_UNIFORM_TEXTURE_REF, texture);
+    se_uniform_set_texture_asset(uniforms, rect_name, SE_UNIFORM_TEXTURE_RECT, texture);
+}
+
+void se_uniform_set_texture_array(se_uniforms* uniforms, const char* name, const se_texture_array* array) {
+    se_uniform_set_sampled(uniforms, name, SE_UNIFORM_TEXTURE_ARRAY, array->id, array->sampler);
+}
+
+// Resolved at apply, the buffer's texture changes with every bind that swaps in its history
 void se_uniform_set_buffer_texture(se_uniforms* uniforms, const char* name, se_render_buffer* buffer) {
-    se_uniform_set_texture(uniforms, name, buffer->texture);
+    se_foreach(se_uniforms, *uniforms, i) {
+        se_uniform* found_uniform = se_uniforms_get(uniforms, i);
+        if (found_uniform && strcmp(found_uniform->name, name) == 0) {
+            found_uniform->type = SE_UNIFORM_BUFFER_TEXTURE;
+            found_uniform->value.texture_ref = &buffer->texture;
+            found_uniform->sampler = 0;
+            return;
+        }
+    }
+    se_uniform* new_uniform = se_uniforms_increment(uniforms);
+    strncpy(new_uniform->name, name, sizeof(new_uniform->name) - 1);
+    new_uniform->type = SE_UNIFORM_BUFFER_TEXTURE;
+    new_uniform->value.texture_ref = &buffer->texture;
+    new_uniform->sampler = 0;
+}
+
+// Sets every uniform of src on dst, keeping the ones only dst has
+void se_uniform_copy(se_uniforms* dst, const se_uniforms* src) {
+    for (sz i = 0; i < src->size; i++) {
+        const se_uniform* uniform = &src->data[i];
+        se_uniform* found_uniform = NULL;
+        se_foreach(se_uniforms, *dst, j) {
+            se_uniform* candidate = se_uniforms_get(dst, j);
+            if (strcmp(candidate->name, uniform->name) == 0) {
+                found_uniform = candidate;
+                break;
+            }
+        }
+        if (found_uniform == NULL) {
+            found_uniform = se_uniforms_increment(dst);
+            if (found_uniform == NULL) {
+                return;
+            }
+        }
+        *found_uniform = *uniform;
+    }
+}
+
+static b8 se_uniform_bind_texture(se_render_handle* render_handle, const se_uniform* uniform, const u32 texture_unit) {
+    switch (uniform->type) {
+        case SE_UNIFORM_TEXTURE_ARRAY:
+            return se_render_handle_bind_texture(render_handle, texture_unit, GL_TEXTURE_2D_ARRAY, uniform->value.texture, uniform->sampler);
+        case SE_UNIFORM_BUFFER_TEXTURE:
+            return se_render_handle_bind_texture(render_handle, texture_unit, GL_TEXTURE_2D, *uniform->value.texture_ref, uniform->sampler);
+        case SE_UNIFORM_TEXTURE_REF: {
+            se_texture* texture = uniform->value.texture_asset;
+            return se_render_handle_bind_texture(render_handle, texture_unit, GL_TEXTURE_2D, se_texture_use(render_handle, texture), texture->sampler);
+        }
+        default:
+            return se_render_handle_bind_texture(render_handle, texture_unit, GL_TEXTURE_2D, uniform->value.texture, uniform->sampler);
+    }
 }
 
 void se_uniform_apply(se_render_handle* render_handle, se_shader* shader, const b8 update_global_uniforms) {
     glUseProgram(shader->program);
     u32 texture_unit = 0;
+    b8 unit_changed = false;
     se_foreach(se_uniforms, shader->uniforms, i) {
         se_uniform* uniform = se_uniforms_get(&shader->uniforms, i);
         GLint location = glGetUniformLocation(shader->program, uniform->name); 
@@ -896,9 +4393,14 @@ void se_uniform_apply(se_render_handle* render_handle, se_shader* shader, const
             case SE_UNIFORM_INT:
                 glUniform1i(location, uniform->value.i);
                 break;
+            case SE_UNIFORM_TEXTURE_RECT:
+                glUniform4fv(location, 1, &uniform->value.texture_asset->uv_rect.x);
+                break;
             case SE_UNIFORM_TEXTURE:
-                glActiveTexture(GL_TEXTURE0 + texture_unit);
-                glBindTexture(GL_TEXTURE_2D, uniform->value.texture);
+            case SE_UNIFORM_TEXTURE_ARRAY:
+            case SE_UNIFORM_BUFFER_TEXTURE:
+            case SE_UNIFORM_TEXTURE_REF:
+                unit_changed |= se_uniform_bind_texture(render_handle, uniform, texture_unit);
                 glUniform1i(location, texture_unit);
                 texture_unit++;
                 break;
@@ -906,6 +4408,9 @@ void se_uniform_apply(se_render_handle* render_handle, se_shader* shader, const
     }
    
     if (!update_global_uniforms) {
+        if (unit_changed) {
+            glActiveTexture(GL_TEXTURE0 + SE_TEXTURE_SCRATCH_UNIT);
+        }
         return;
     }
 
@@ -933,14 +4438,22 @@ void se_uniform_apply(se_render_handle* render_handle, se_shader* shader, const
             case SE_UNIFORM_INT:
                 glUniform1i(location, uniform->value.i);
                 break;
+            case SE_UNIFORM_TEXTURE_RECT:
+                glUniform4fv(location, 1, &uniform->value.texture_asset->uv_rect.x);
+                break;
             case SE_UNIFORM_TEXTURE:
-                glActiveTexture(GL_TEXTURE0 + texture_unit);
-                glBindTexture(GL_TEXTURE_2D, uniform->value.texture);
+            case SE_UNIFORM_TEXTURE_ARRAY:
+            case SE_UNIFORM_BUFFER_TEXTURE:
+            case SE_UNIFORM_TEXTURE_REF:
+                unit_changed |= se_uniform_bind_texture(render_handle, uniform, texture_unit);
                 glUniform1i(location, texture_unit);
                 texture_unit++;
                 break;
         }
     }
+    if (unit_changed) {
+        glActiveTexture(GL_TEXTURE0 + SE_TEXTURE_SCRATCH_UNIT);
+    }
 }
 
 time_t get_file_mtime(const char* path) {
@@ -951,6 +4464,14 @@ time_t get_file_mtime(const char* path) {
     return 0;
 }
 
+b8 se_cache_get_path(c8* out_path, const u64 key, const c8* extension) {
+    if (mkdir(SE_CACHE_DIR, 0755) != 0 && errno != EEXIST) {
+        return false;
+    }
+    snprintf(out_path, MAX_PATH_LENGTH, "%s%016llx.%s", SE_CACHE_DIR, (unsigned long long)key, extension);
+    return true;
+}
+
 char* load_file(const char* path) {
     FILE* file = fopen(path, "rb");
     if (!file) {
@@ -975,52 +4496,272 @@ char* load_file(const char* path) {
     return buffer;
 }
 
+// The status isn't queried here, so drivers can compile in the background, se_program_finish reports errors
 static GLuint compile_shader(const char* source, GLenum type) {
     GLuint shader = glCreateShader(type);
     glShaderSource(shader, 1, &source, NULL);
     glCompileShader(shader);
+    return shader;
+}
 
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+static b8 se_shader_stage_check(const se_shader_stage* stage) {
+    GLint success = GL_FALSE;
+    glGetShaderiv(stage->id, GL_COMPILE_STATUS, &success);
     if (!success) {
         char info_log[512];
-        glGetShaderInfoLog(shader, 512, NULL, info_log);
+        glGetShaderInfoLog(stage->id, 512, NULL, info_log);
         fprintf(stderr, "Shader compilation failed: %s\n", info_log);
-        glDeleteShader(shader);
-        return 0;
     }
-    
-    return shader;
+    return success;
+}
+
+// Program binary cache, keyed by both sources, the driver strings and SE_PROGRAM_CACHE_VERSION
+#define SE_PROGRAM_CACHE_MAGIC 0x42504553 // "SEPB"
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u64 key;
+    u32 binary_format;
+    u32 binary_size;
+} se_program_cache_header;
+
+static se_program_cache_stats program_cache_stats = {0};
+
+se_program_cache_stats se_program_cache_get_stats() {
+    return program_cache_stats;
 }
 
-static GLuint create_shader_program(const char* vertex_source, const char* fragment_source) {
-    GLuint vertex_shader = compile_shader(vertex_source, GL_VERTEX_SHADER);
-    GLuint fragment_shader = compile_shader(fragment_source, GL_FRAGMENT_SHADER);
-    if (!vertex_shader || !fragment_shader) {
-        if (vertex_shader) glDeleteShader(vertex_shader);
-        if (fragment_shader) glDeleteShader(fragment_shader);
-        printf("Failed to create shader program, vertex or fragment shaders are invalid\n");
+static u64 se_program_cache_key(const c8* vertex_source, const c8* fragment_source) {
+    // a driver update invalidates every binary, so it is part of the key
+    const GLenum driver_strings[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    const u32 version = SE_PROGRAM_CACHE_VERSION;
+    u64 key = se_hash(&version, sizeof(version), SE_HASH_SEED);
+    for (u32 i = 0; i < 3; i++) {
+        const c8* value = (const c8*)glGetString(driver_strings[i]);
+        if (value) {
+            key = se_hash(value, strlen(value), key);
+        }
+    }
+    key = se_hash(vertex_source, strlen(vertex_source), key);
+    return se_hash(fragment_source, strlen(fragment_source), key);
+}
+
+static GLuint se_program_cache_load(const c8* cache_path, const u64 key) {
+    sz size = 0;
+    u8* data = se_map_file(cache_path, &size);
+    if (data == NULL) {
+        program_cache_stats.misses++;
+        return 0;
+    }
+    const se_program_cache_header* header = (const se_program_cache_header*)data;
+    // truncated, corrupt or written for other sources: nothing the driver could refuse
+    if (size <= sizeof(se_program_cache_header) || header->magic != SE_PROGRAM_CACHE_MAGIC || header->version != SE_PROGRAM_CACHE_VERSION ||
+        header->key != key || header->binary_size != size - sizeof(se_program_cache_header)) {
+        munmap(data, size);
+        program_cache_stats.misses++;
         return 0;
     }
-    
     GLuint program = glCreateProgram();
-    glAttachShader(program, vertex_shader);
-    glAttachShader(program, fragment_shader);
-    glLinkProgram(program);
-    
-    GLint success;
+    glProgramBinary(program, header->binary_format, data + sizeof(se_program_cache_header), (GLsizei)header->binary_size);
+    munmap(data, size);
+    GLint success = GL_FALSE;
     glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success) {
-        char info_log[512];
-        glGetProgramInfoLog(program, 512, NULL, info_log);
-        fprintf(stderr, "Shader program linking failed: %s\n", info_log);
         glDeleteProgram(program);
-        program = 0;
+        program_cache_stats.rejected++;
+        return 0;
     }
-    
-    glDeleteShader(vertex_shader);
-    glDeleteShader(fragment_shader);
-    
+    program_cache_stats.hits++;
     return program;
 }
 
+static void se_program_cache_save(const c8* cache_path, const u64 key, const GLuint program) {
+    GLint binary_size = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_size);
+    if (binary_size <= 0) {
+        return;
+    }
+    u8* data = malloc(sizeof(se_program_cache_header) + binary_size);
+    se_program_cache_header* header = (se_program_cache_header*)data;
+    GLenum binary_format = 0;
+    GLsizei length = 0;
+    glGetProgramBinary(program, binary_size, &length, &binary_format, data + sizeof(se_program_cache_header));
+    header->magic = SE_PROGRAM_CACHE_MAGIC;
+    header->version = SE_PROGRAM_CACHE_VERSION;
+    header->key = key;
+    header->binary_format = binary_format;
+    header->binary_size = (u32)length;
+
+    FILE* file = length > 0 ? fopen(cache_path, "wb") : NULL;
+    if (file) {
+        const b8 written = fwrite(data, sizeof(se_program_cache_header) + length, 1, file) == 1;
+        if (fclose(file) == 0 && written) {
+            program_cache_stats.saved++;
+        } else {
+            remove(cache_path);
+        }
+    }
+    free(data);
+}
+
+static se_shader_stage* se_shader_stage_acquire(se_program_pool* pool, const c8* source, const GLenum type) {
+    const u64 key = se_hash(source, strlen(source), se_hash(&type, sizeof(type), SE_HASH_SEED));
+    se_shader_stage* free_stage = NULL;
+    se_foreach(se_shader_stages, pool->stages, i) {
+        se_shader_stage* stage = se_shader_stages_get(&pool->stages, i);
+        if (stage->ref_count > 0 && stage->key == key) {
+            stage->ref_count++;
+            return stage;
+        }
+        if (stage->ref_count == 0 && free_stage == NULL) {
+            free_stage = stage;
+        }
+    }
+    if (free_stage == NULL) {
+        free_stage = se_shader_stages_increment(&pool->stages);
+        if (free_stage == NULL) {
+            fprintf(stderr, "se_shader_stage_acquire :: too many shader stages, max is %d\n", SE_MAX_SHADER_STAGES);
+            return NULL;
+        }
+    }
+    const GLuint id = compile_shader(source, type);
+    if (!id) {
+        return NULL;
+    }
+    free_stage->id = id;
+    free_stage->type = type;
+    free_stage->key = key;
+    free_stage->ref_count = 1;
+    return free_stage;
+}
+
+static void se_shader_stage_release(se_shader_stage* stage) {
+    if (stage == NULL || stage->ref_count == 0 || --stage->ref_count > 0) {
+        return;
+    }
+    glDeleteShader(stage->id);
+    stage->id = 0;
+}
+
+// Returns the program already linked from the same sources, or builds one from a program binary or the (shared) stages
+static se_program* se_program_acquire(se_program_pool* pool, const c8* vertex_source, const c8* fragment_source, b8* out_cached) {
+    *out_cached = false;
+    const u64 key = se_hash(fragment_source, strlen(fragment_source), se_hash(vertex_source, strlen(vertex_source), SE_HASH_SEED));
+    se_program* free_program = NULL;
+    se_foreach(se_programs, pool->programs, i) {
+        se_program* program = se_programs_get(&pool->programs, i);
+        if (program->ref_count > 0 && program->key == key) {
+            program->ref_count++;
+            *out_cached = true;
+            return program;
+        }
+        if (program->ref_count == 0 && free_program == NULL) {
+            free_program = program;
+        }
+    }
+    if (free_program == NULL) {
+        free_program = se_programs_increment(&pool->programs);
+        if (free_program == NULL) {
+            fprintf(stderr, "se_program_acquire :: too many programs, max is %d\n", SE_MAX_PROGRAMS);
+            return NULL;
+        }
+    }
+
+    c8 cache_path[MAX_PATH_LENGTH] = {0};
+    u64 cache_key = 0;
+    if (se_gl_caps.program_binary) {
+        cache_key = se_program_cache_key(vertex_source, fragment_source);
+        if (!se_cache_get_path(cache_path, cache_key, "seprog")) {
+            cache_key = 0;
+        } else {
+            const GLuint cached_program = se_program_cache_load(cache_path, cache_key);
+            if (cached_program) {
+                *free_program = (se_program){ cached_program, key, NULL, NULL, 1, 0, false };
+                *out_cached = true;
+                return free_program;
+            }
+        }
+    }
+
+    se_shader_stage* vertex_stage = se_shader_stage_acquire(pool, vertex_source, GL_VERTEX_SHADER);
+    se_shader_stage* fragment_stage = vertex_stage ? se_shader_stage_acquire(pool, fragment_source, GL_FRAGMENT_SHADER) : NULL;
+    if (!vertex_stage || !fragment_stage) {
+        se_shader_stage_release(vertex_stage);
+        return NULL;
+    }
+    
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex_stage->id);
+    glAttachShader(program, fragment_stage->id);
+    if (cache_key) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(program);
+    *free_program = (se_program){ program, key, vertex_stage, fragment_stage, 1, cache_key, true };
+    return free_program;
+}
+
+// Builds are left alone for the frame they were issued in, so the driver links while it draws. Without parallel shader
+// compile there is nothing to poll after that, the status query blocks until the link is done
+static b8 se_program_is_complete(se_program* program, const u64 frame) {
+    if (!program->linking) {
+        return true;
+    }
+    if (program->poll_frame == 0 || program->poll_frame == frame) {
+        program->poll_frame = frame;
+        return false;
+    }
+    if (!se_gl_caps.parallel_shader_compile) {
+        return true;
+    }
+    GLint complete = GL_FALSE;
+    glGetProgramiv(program->id, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete;
+}
+
+// Waits for the link if still running, a program that failed keeps id 0 until released
+static b8 se_program_finish(se_program* program) {
+    if (!program->linking) {
+        return program->id != 0;
+    }
+    program->linking = false;
+    GLint success = GL_FALSE;
+    glGetProgramiv(program->id, GL_LINK_STATUS, &success);
+    if (!success) {
+        const b8 compiled = se_shader_stage_check(program->vertex_stage) & se_shader_stage_check(program->fragment_stage);
+        if (compiled) {
+            char info_log[512];
+            glGetProgramInfoLog(program->id, 512, NULL, info_log);
+            fprintf(stderr, "Shader program linking failed: %s\n", info_log);
+        } else {
+            printf("Failed to create shader program, vertex or fragment shaders are invalid\n");
+        }
+        glDeleteProgram(program->id);
+        program->id = 0;
+        return false;
+    }
+    if (program->binary_key) {
+        c8 cache_path[MAX_PATH_LENGTH] = {0};
+        if (se_cache_get_path(cache_path, program->binary_key, "seprog")) {
+            se_program_cache_save(cache_path, program->binary_key, program->id);
+        }
+    }
+    return true;
+}
+
+static void se_program_release(se_program* program) {
+    if (program->ref_count == 0 || --program->ref_count > 0) {
+        return;
+    }
+    if (program->id) {
+        glDeleteProgram(program->id);
+        program->id = 0;
+    }
+    program->linking = false;
+    se_shader_stage_release(program->vertex_stage);
+    se_shader_stage_release(program->fragment_stage);
+    program->vertex_stage = NULL;
+    program->fragment_stage = NULL;
+}
+
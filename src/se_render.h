@@ -5,6 +5,11 @@
 
 #include "se_math.h"
 #include "se_array.h"
+#include "se_worker.h"
+#include "se_upload.h"
+#include "se_ring_buffer.h"
+#include "se_file_watch.h"
+#include "se_glsl.h"
 #include <GLFW/glfw3.h>
 #include <time.h>
 #include <assert.h>
@@ -12,16 +17,48 @@
 
 #define SE_MAX_RENDER_BUFFERS 16
 #define SE_MAX_FRAMEBUFFERS 16
+#define SE_MAX_RENDER_TARGETS 32 // pooled
+#define SE_MAX_TARGET_ATTACHMENTS 4
+#define SE_RENDER_TARGET_IDLE_FRAMES 120 // pooled targets released this long ago are freed
 #define SE_MAX_UNIFORMS 32
 #define SE_MAX_TEXTURES 128
 #define SE_MAX_SHADERS 64
+#define SE_MAX_PROGRAMS 64
+#define SE_MAX_SHADER_STAGES 128
+#define SE_MAX_SHADER_VARIANTS 16 // per se_shader
+#define SE_MAX_SHADER_DEFINES_LENGTH 128
+#define SE_MAX_CHANGED_FILES 64 // taken from the file watch per frame, the rest waits for the next one
 #define SE_MAX_MESHES 64
 #define SE_MAX_MODELS 1024
-#define SE_MAX_VERTICES 65536
+#define SE_MAX_VERTICES 65536 // initial import capacity, grows as needed
 #define SE_MAX_INDICES 65536
 #define SE_MAX_NAME_LENGTH 64
 #define SE_MAX_PATH_LENGTH 256
 #define SE_MAX_CAMERAS 32 
+#define SE_MAX_DRAWS 8192
+#define SE_MAX_DRAW_IDS (SE_RING_BUFFER_SIZE / sizeof(se_mat4)) // one per transform the dynamic ring can hold
+#define SE_MAX_POOL_RANGES 1024
+#define SE_MESH_POOL_MIN_VERTICES 65536
+#define SE_MESH_POOL_MIN_INDICES 196608
+#define SE_DRAW_TRANSFORMS_TEXTURE_UNIT 15
+#define SE_TEXTURE_SCRATCH_UNIT 14 // active outside se_uniform_apply, so creating and updating textures never disturbs the cached bindings
+#define SE_MAX_TEXTURE_UNITS 14 // units se_uniform_apply binds to
+#define SE_MAX_SAMPLERS 32
+#define SE_MAX_TEXTURE_ARRAYS 16
+#define SE_MAX_MESH_LODS 4
+#define SE_LOD_PIXEL_ERROR 1.0f   // switch to a coarser level while its error stays under this many pixels
+#define SE_LOD_HYSTERESIS 0.25f   // relative band around the threshold to avoid popping back and forth
+#define SE_MESH_CACHE_VERSION 2
+#define SE_TEXTURE_CACHE_VERSION 3
+#define SE_PROGRAM_CACHE_VERSION 1 // bump when the engine changes how programs are built
+#define SE_TEXTURE_ATLAS_SIZE 2048
+#define SE_TEXTURE_ATLAS_MAX_PAGES 4
+#define SE_TEXTURE_ATLAS_MAX_IMAGE_SIZE 128 // clamped images up to this size get packed when atlasing is on
+#define SE_TEXTURE_ATLAS_PADDING 8 // gutter around every image, also the placement grid
+#define SE_TEXTURE_ATLAS_LEVELS 4 // mips the gutter keeps clean, 8 >> 3 = 1 texel
+#define SE_TEXTURE_ATLAS_MAX_NODES 256
+#define SE_TEXTURE_MIP_TAIL_SIZE 64 // levels this size and smaller stay resident, the ones above stream in and out
+#define SE_LOAD_FRAME_BUDGET_MS 2.0 // time spent finishing async loads per frame
 
 
 typedef struct {
@@ -30,13 +67,24 @@ typedef struct {
     se_vec2 uv;
 } se_vertex;
 
+// Async loads hand out the slot right away, it stays usable (placeholder) while pending
+typedef enum {
+    SE_ASSET_READY,
+    SE_ASSET_PENDING,
+    SE_ASSET_FAILED
+} se_asset_state;
+
 typedef enum {
     SE_UNIFORM_FLOAT,
     SE_UNIFORM_VEC2,
     SE_UNIFORM_VEC3,
     SE_UNIFORM_VEC4,
     SE_UNIFORM_INT,
-    SE_UNIFORM_TEXTURE
+    SE_UNIFORM_TEXTURE,
+    SE_UNIFORM_TEXTURE_ARRAY,
+    SE_UNIFORM_BUFFER_TEXTURE, // follows a render buffer's current texture
+    SE_UNIFORM_TEXTURE_REF, // follows an se_texture, marks it used when bound so its levels stay resident
+    SE_UNIFORM_TEXTURE_RECT // uv_rect of an se_texture, async loads only know it once packed
 } se_uniform_type;
 
 typedef struct {
@@ -49,51 +97,230 @@ typedef struct {
         se_vec4 vec4;
         i32 i;
         GLuint texture;
+        const GLuint* texture_ref;
+        struct se_texture* texture_asset;
     } value;
+    GLuint sampler; // textures only, 0 samples with the texture's own parameters
 } se_uniform;
 SE_DEFINE_ARRAY(se_uniform, se_uniforms, SE_MAX_UNIFORMS);
 
+// Compiled stage, shared by every program linked from the same source
+typedef struct {
+    GLuint id;
+    GLenum type;
+    u64 key; // type and source
+    u32 ref_count; // programs linked from it
+} se_shader_stage;
+SE_DEFINE_ARRAY(se_shader_stage, se_shader_stages, SE_MAX_SHADER_STAGES);
+
+// Linked program, shared by every se_shader built from the same sources
+typedef struct {
+    GLuint id;
+    u64 key; // both sources
+    se_shader_stage* vertex_stage; // NULL when restored from a program binary
+    se_shader_stage* fragment_stage;
+    u32 ref_count; // se_shaders using it
+    u64 binary_key; // saved to the program binary cache once linked, 0 to skip
+    b8 linking; // link issued, status not queried yet
+    u64 poll_frame; // frame its build was first seen in, 0 before, the status is only queried in a later frame
+} se_program;
+SE_DEFINE_ARRAY(se_program, se_programs, SE_MAX_PROGRAMS);
+
+typedef struct {
+    se_shader_stages stages;
+    se_programs programs;
+} se_program_pool;
+
+// Program binary cache counters, see se_program_cache_get_stats
 typedef struct {
-    GLuint program;
-    GLuint vertex_shader;
-    GLuint fragment_shader;
+    u32 hits;
+    u32 misses; // no usable binary (none yet, truncated or stale), compiled from source
+    u32 rejected; // binary found but the driver refused it, compiled from source
+    u32 saved;
+} se_program_cache_stats;
+
+// Program built with a list of #defines in front of both sources
+typedef struct {
+    u64 key; // defines
+    se_program* program;
+} se_shader_variant;
+
+// One instance, uniforms are its own while the GL program is shared through the pool
+typedef struct {
+    GLuint program; // shared_program->id, or the selected variant's
+    se_program* shared_program;
+    se_program* pending_program; // compiling in the background, replaces shared_program once linked
+    se_program_pool* pool;
+    se_shader_variant variants[SE_MAX_SHADER_VARIANTS]; // built on first selection, dropped when the sources change
+    u32 variant_count;
+    c8 variant_defines[SE_MAX_SHADER_DEFINES_LENGTH]; // selected variant, empty for the base program
+    se_shader_variant pending_variant; // selected variant rebuilt from new sources, program NULL when none
+    se_program* previous_variant; // selected variant of the previous sources, drawn until pending_variant has linked
     c8 vertex_path[SE_MAX_PATH_LENGTH];
     c8 fragment_path[SE_MAX_PATH_LENGTH];
+    se_glsl_dependencies dependencies; // files included by either stage
+    b8 watch_dependencies; // dependencies not registered with the file watch yet
     time_t vertex_mtime;
     time_t fragment_mtime;
+    time_t dependency_mtimes[SE_GLSL_MAX_DEPENDENCIES];
     se_uniforms uniforms;
     b8 needs_reload;
+    u32 ref_count; // fused shaders only, users sharing it, the slot is reused once it drops to 0
+    se_asset_state state;
 } se_shader;
 SE_DEFINE_ARRAY(se_shader, se_shaders, SE_MAX_SHADERS);
 typedef se_shader* se_shader_ptr;
 SE_DEFINE_ARRAY(se_shader_ptr, se_shaders_ptr, SE_MAX_SHADERS);
 
+typedef enum { SE_REPEAT, SE_CLAMP } se_texture_wrap;
+
+typedef enum { SE_FILTER_NEAREST, SE_FILTER_LINEAR } se_texture_filter;
+
+// Sampler objects are shared by every texture sampled the same way
+typedef struct {
+    se_texture_filter filter;
+    se_texture_wrap wrap;
+    f32 anisotropy; // 1 for none
+} se_sampler_desc;
+
+typedef struct {
+    se_sampler_desc desc;
+    GLuint id;
+} se_sampler;
+SE_DEFINE_ARRAY(se_sampler, se_samplers, SE_MAX_SAMPLERS);
+
+typedef struct { i32 x, y, width; } se_skyline_node;
+
+// Shared page small clamped textures are packed into
+typedef struct se_texture_atlas_page {
+    GLuint id;
+    se_skyline_node skyline[SE_TEXTURE_ATLAS_MAX_NODES];
+    u32 node_count;
+    u32 texture_count;
+    b8 dirty; // mips are regenerated by se_render_handle_process_loads, or before a texture on it is bound
+} se_texture_atlas_page;
+
+// Loads are deduplicated by path and by content, the GL texture lives until the last reference is cleaned up
 typedef struct se_texture {
     char path[SE_MAX_PATH_LENGTH];
+    u64 path_hash;
+    u64 content_hash; // read from the cooked container, 0 while pending
+    se_texture_wrap wrap;
+    u32 ref_count;
     GLuint id;
+    se_vec4 uv_rect; // xy offset and zw size of the image inside id, (0, 0, 1, 1) unless packed
+    se_texture_atlas_page* atlas_page;
+    GLuint sampler;
     i32 width;
     i32 height;
     i32 channels;
+    GLenum format; // internal format
+    b8 compressed;
+    u32 level_count;
+    u32 tail_level; // first level of the mip tail
+    u32 resident_level; // GL_TEXTURE_BASE_LEVEL, 0 once fully streamed in
+    b8 streaming; // a level is on its way
+    u64 last_used_frame;
+    c8 cache_path[SE_MAX_PATH_LENGTH]; // cooked container levels stream from, empty if they can't
+    u32 generation; // bumped by hot reloads, levels streamed for an older one are dropped
+    se_asset_state state;
 } se_texture;
 SE_DEFINE_ARRAY(se_texture, se_textures, SE_MAX_TEXTURES);
 typedef se_texture* se_texture_ptr;
 SE_DEFINE_ARRAY(se_texture_ptr, se_textures_ptr, SE_MAX_TEXTURES);
 
+// Another path whose content matched a loaded texture, later loads of it share that texture and edits to it reload it
+typedef struct {
+    char path[SE_MAX_PATH_LENGTH];
+    u64 path_hash;
+    se_texture* texture;
+    u64 texture_path_hash; // of texture when added, stale once its slot is released or reused for another path
+} se_texture_alias;
+SE_DEFINE_ARRAY(se_texture_alias, se_texture_aliases, SE_MAX_TEXTURES);
+
+// Same size textures as layers of one GL_TEXTURE_2D_ARRAY, materials pick theirs by index instead of rebinding
+typedef struct {
+    GLuint id;
+    i32 width;
+    i32 height;
+    u32 level_count;
+    u32 layer_count;
+    u32 layer_capacity;
+    GLuint sampler;
+} se_texture_array;
+SE_DEFINE_ARRAY(se_texture_array, se_texture_arrays, SE_MAX_TEXTURE_ARRAYS);
+
+typedef struct {
+    u32 offset;
+    u32 count;
+} se_pool_range;
+SE_DEFINE_ARRAY(se_pool_range, se_pool_ranges, SE_MAX_POOL_RANGES);
+
+// Shared vertex/index storage for all meshes, so they can be drawn with a single VAO (and a single multi draw)
+typedef struct {
+    GLuint vao;
+    GLuint vbo;
+    GLuint ebo;
+    GLuint draw_id_buffer;
+    u32 vertex_capacity;
+    u32 index_capacity;
+    u32 vertex_count; // high-water marks
+    u32 index_count;
+    se_pool_ranges free_vertices;
+    se_pool_ranges free_indices;
+} se_mesh_pool;
+
+// Contiguous index range of a large mesh with its own bounds and normal cone, used for per cluster culling
+typedef struct {
+    u32 first_index; // relative to the mesh
+    u32 index_count;
+    se_vec3 center;
+    f32 radius;
+    se_vec3 cone_axis;
+    f32 cone_cutoff;
+} se_mesh_cluster;
+
+// Index range of one level of detail, error is the object space distance to the full detail mesh
+typedef struct {
+    u32 first_index; // relative to the mesh
+    u32 index_count;
+    f32 error;
+} se_mesh_lod;
+
 typedef struct {
     se_vertex* vertices;
     u32* indices;
     u32 vertex_count;
-    u32 index_count;
+    u32 index_count; // every level of detail, see lods
     GLuint vao;
-    GLuint vbo;
-    GLuint ebo;
+    u32 base_vertex;
+    u32 first_index;
+    se_mesh_pool* pool;
+    se_vec3 bounds_center;
+    f32 bounds_radius;
+    se_mesh_cluster* clusters; // split of the first level of detail
+    u32 cluster_count;
+    se_mesh_lod* lods; // lod_count levels, at least the full detail one
+    u32 lod_count;
+    u32 current_lod;
     se_shader* shader;
     se_mat4 matrix;
 } se_mesh;
 SE_DEFINE_ARRAY(se_mesh, se_meshes, SE_MAX_MESHES);
 
+// What happens to the CPU side mesh copies after upload, the GPU copy in the mesh pool is always there
+typedef enum {
+    SE_MODEL_GPU_ONLY,   // dropped after upload, se_model_fetch_cpu_data brings them back on demand
+    SE_MODEL_CPU_ACCESS  // kept, for picking, collision, ...
+} se_model_residency;
+
 typedef struct {
     se_meshes meshes;
+    se_model_residency residency;
+    c8 path[SE_MAX_PATH_LENGTH]; // .obj source, hot reloaded when it changes, empty for glTF
+    c8 cache_path[SE_MAX_PATH_LENGTH]; // cooked file the CPU copies can be read back from, empty if none
+    struct se_model_stream* stream; // queued uploads of the meshes, NULL once they have landed
+    se_asset_state state;
 } se_model;
 SE_DEFINE_ARRAY(se_model, se_models, SE_MAX_MODELS);
 typedef se_model* se_model_ptr;
@@ -113,39 +340,144 @@ SE_DEFINE_ARRAY(se_camera, se_cameras, SE_MAX_CAMERAS);
 typedef se_camera* se_camera_ptr;
 SE_DEFINE_ARRAY(se_camera_ptr, se_cameras_ptr, SE_MAX_CAMERAS);
 
+typedef enum {
+    SE_TARGET_FORMAT_RGBA8,
+    SE_TARGET_FORMAT_R8,
+    SE_TARGET_FORMAT_RG16F,
+    SE_TARGET_FORMAT_RGBA16F,
+    SE_TARGET_FORMAT_R11G11B10F
+} se_target_format;
+
+typedef enum {
+    SE_TARGET_DEPTH_NONE,
+    SE_TARGET_DEPTH,
+    SE_TARGET_DEPTH_STENCIL
+} se_target_depth;
+
+// Zeroed fields describe a single RGBA8 color attachment without depth
+typedef struct {
+    se_vec2 size;
+    se_target_format color_formats[SE_MAX_TARGET_ATTACHMENTS];
+    u32 color_count; // attachments drawn at once, 0 is read as 1
+    se_target_depth depth;
+    b8 history; // render buffers only, u_prev is kept even when the shader doesn't declare it
+} se_render_target_desc;
+
+typedef struct {
+    se_render_target_desc desc;
+    GLuint framebuffer;
+    GLuint textures[SE_MAX_TARGET_ATTACHMENTS];
+    GLuint depth_buffer;
+    b8 in_use; // pooled targets only
+    u64 last_used_frame;
+} se_render_target;
+SE_DEFINE_ARRAY(se_render_target, se_render_targets, SE_MAX_RENDER_TARGETS);
+
 typedef struct {
     GLuint framebuffer;
-    GLuint texture;
+    GLuint texture; // textures[0]
     GLuint depth_buffer;
     se_vec2 size;
+    GLuint textures[SE_MAX_TARGET_ATTACHMENTS];
+    se_render_target_desc desc;
 } se_framebuffer;
 SE_DEFINE_ARRAY(se_framebuffer, se_framebuffers, SE_MAX_FRAMEBUFFERS);
 typedef se_framebuffer* se_framebuffer_ptr;
 SE_DEFINE_ARRAY(se_framebuffer_ptr, se_framebuffers_ptr, SE_MAX_FRAMEBUFFERS);
 
+// Two sets of color attachments trade places at the first bind of a frame, last frame's output is sampled as u_prev without a copy
 typedef struct {
-    GLuint framebuffer;
-    GLuint texture;
-    GLuint prev_framebuffer;
+    GLuint framebuffer; // target's, drawn into after the bind
+    GLuint texture; // target's first color attachment
+    GLuint prev_framebuffer; // 0 without history
     GLuint prev_texture;
-    GLuint depth_buffer;
+    GLuint depth_buffer; // attached to both
+    se_render_target target;
+    se_render_target prev_target;
+    se_render_target_desc desc;
     se_vec2 texture_size;
     se_vec2 scale;
     se_vec2 position;
     se_shader_ptr shader;
+    b8 history; // shader samples u_prev
+    const u64* frame; // the render handle's, counted by se_render_handle_process_loads
+    u64 swap_frame; // frame the attachments last traded places in
 } se_render_buffer;
 SE_DEFINE_ARRAY(se_render_buffer, se_render_buffers, SE_MAX_RENDER_BUFFERS);
 typedef se_render_buffer* se_render_buffer_ptr;
 SE_DEFINE_ARRAY(se_render_buffer_ptr, se_render_buffers_ptr, SE_MAX_RENDER_BUFFERS);
 
+// Layout matches the GL indirect command, base_instance is used as draw id (index into the transforms buffer)
+typedef struct {
+    u32 count;
+    u32 instance_count;
+    u32 first_index;
+    i32 base_vertex;
+    u32 base_instance;
+} se_draw_command;
+
+typedef struct {
+    se_shader* shader;
+    u32 first_index;
+    u32 index_count;
+    i32 base_vertex;
+    u32 transform_index;
+} se_draw_item;
+
+// Arrays grow with the scene up to SE_MAX_DRAWS
+typedef struct {
+    se_draw_item* items;
+    se_draw_command* commands; // one per item
+    u32 item_count;
+    u32 item_capacity;
+    se_mat4* transforms;
+    u32 transform_count;
+    u32 transform_capacity;
+
+    se_mat4 view;
+    se_mat4 projection;
+    se_mat4 view_projection;
+    se_frustum frustum;
+    se_vec3 camera_position;
+    f32 lod_pixel_scale; // world size at distance 1 to pixels
+
+    GLuint transform_texture; // over the whole dynamic ring, draws index it by base instance
+} se_draw_list;
+
+// Several MB, too large for the stack: get one from se_render_handle_create
 typedef struct {
     se_framebuffers framebuffers;
     se_render_buffers render_buffers;
+    se_render_targets render_targets; // pool, recycled between matching descs
     se_textures textures;
+    se_texture_aliases texture_aliases;
+    se_texture_arrays texture_arrays;
+    se_samplers samplers;
     se_shaders shaders;
+    se_program_pool program_pool; // programs and stages deduplicated by source
     se_uniforms global_uniforms;
     se_cameras cameras;
     se_models models;
+    se_mesh_pool mesh_pool;
+    se_draw_list draw_list;
+    se_model_residency model_residency; // applied to models loaded from now on
+    se_worker_pool* loader; // created on the first async load
+    GLuint placeholder_texture;
+    f64 load_budget_ms;
+    se_upload_queue uploads; // async loads stream through it
+    se_ring_buffer dynamic_data; // per frame transforms, draw commands and uniform blocks
+    b8 texture_compression; // cook textures to BC1/BC3 when the driver supports S3TC
+    se_texture_atlas_page atlas_pages[SE_TEXTURE_ATLAS_MAX_PAGES];
+    u32 atlas_page_count;
+    b8 texture_atlasing; // pack small clamped textures into shared pages
+    f32 texture_anisotropy; // for textures loaded from now on
+    // what se_uniform_apply last bound per unit, ~0 when unknown
+    GLuint bound_textures[SE_MAX_TEXTURE_UNITS];
+    GLenum bound_targets[SE_MAX_TEXTURE_UNITS];
+    GLuint bound_samplers[SE_MAX_TEXTURE_UNITS];
+    sz texture_budget; // bytes of texture levels kept resident, 0 for no limit
+    u64 frame; // counted by se_render_handle_process_loads
+    se_file_watch* file_watch; // started by the first se_render_handle_reload_changed_assets
 
     se_shader* render_quad_shader;
 } se_render_handle;
@@ -160,18 +492,38 @@ extern void se_render_set_background_color(const se_vec4 color);
 // render_handle functions
 extern se_render_handle* se_render_handle_create();
 extern void se_render_handle_cleanup(se_render_handle* render_handle);
-extern void se_render_handle_reload_changed_shaders(se_render_handle* render_handle);
+extern b8 se_render_handle_reload_changed_assets(se_render_handle* render_handle); // reloads the shaders, textures and models the file watch reported, call once per frame. True when a frame should show the result
+extern void se_render_handle_process_loads(se_render_handle* render_handle); // finishes async loads within load_budget_ms and streams uploads, call once per frame
+extern b8 se_render_handle_loads_pending(se_render_handle* render_handle);
+extern void se_render_handle_set_texture_budget(se_render_handle* render_handle, const sz bytes); // textures unused for a frame drop to their mip tail above it
+extern sz se_render_handle_get_texture_memory(se_render_handle* render_handle);
+extern void se_render_handle_set_texture_anisotropy(se_render_handle* render_handle, const f32 anisotropy); // clamped to se_gl_caps.max_anisotropy
+extern GLuint se_render_handle_get_sampler(se_render_handle* render_handle, const se_sampler_desc* desc);
+extern void se_render_handle_reset_texture_bindings(se_render_handle* render_handle); // after binding textures to units outside se_uniform_apply
+extern void se_render_handle_set_texture_atlasing(se_render_handle* render_handle, const b8 enabled);
+extern void se_render_handle_set_texture_compression(se_render_handle* render_handle, const b8 enabled);
+extern void se_render_handle_set_upload_budget(se_render_handle* render_handle, const u32 bytes_per_frame);
 extern se_uniforms* se_render_handle_get_global_uniforms(se_render_handle* render_handle);
 
 // Texture functions
-typedef enum { SE_REPEAT, SE_CLAMP } se_texture_wrap;
 extern se_texture* se_texture_load(se_render_handle* render_handle, const char* path, const se_texture_wrap wrap);
-extern void se_texture_cleanup(se_texture* texture);
+extern se_texture* se_texture_load_async(se_render_handle* render_handle, const char* path, const se_texture_wrap wrap); // id changes once loaded, bind with se_shader_set_texture_ref/region
+extern GLuint se_texture_use(se_render_handle* render_handle, se_texture* texture); // marks it used this frame so its levels stream in, returns the id to bind
+extern void se_texture_cleanup(se_texture* texture); // releases one reference
+
+// Texture array functions
+extern se_texture_array* se_texture_array_create(se_render_handle* render_handle, const i32 width, const i32 height, const u32 layers, const se_sampler_desc* sampler);
+extern i32 se_texture_array_add(se_render_handle* render_handle, se_texture_array* array, const char* path); // layer index, -1 on failure
+extern void se_texture_array_cleanup(se_texture_array* array);
 
 // Shader functions
 extern se_shader* se_shader_load(se_render_handle* render_handle, const char* vertex_file_path, const char* fragment_file_path);
+extern se_shader* se_shader_load_async(se_render_handle* render_handle, const char* vertex_file_path, const char* fragment_file_path);
 extern se_shader* se_shader_load_from_memory(se_render_handle* render_handle, const char* vertex_data, const char* fragment_data);
-extern b8 se_shader_reload_if_changed(se_shader* shader);
+extern se_shader* se_shader_load_fused(se_render_handle* render_handle, se_shader** stages, const u32 count); // pointwise stages in one pass, vertex stage of the first
+extern void se_shader_release_fused(se_shader* shader); // once per se_shader_load_fused, no-op for other shaders
+extern b8 se_shader_reload_if_changed(se_shader* shader); // true if a rebuild was issued, it is swapped in by se_render_handle_process_loads
+extern b8 se_shader_set_variant(se_shader* shader, const c8* defines); // space separated NAME or NAME=VALUE, NULL or "" for the base program
 extern void se_shader_use(se_render_handle* render_handle, se_shader* shader, const b8 update_uniforms, const b8 update_global_uniforms);
 extern void se_shader_cleanup(se_shader* shader);
 extern GLuint se_shader_get_uniform_location(se_shader* shader, const char* name);
@@ -181,7 +533,12 @@ extern void se_shader_set_vec3(se_shader* shader, const char* name, const se_vec
 extern void se_shader_set_vec4(se_shader* shader, const char* name, const se_vec4* value);
 extern void se_shader_set_int(se_shader* shader, const char* name, i32 value);
 extern void se_shader_set_texture(se_shader* shader, const char* name, GLuint texture);
+extern void se_shader_set_texture_ref(se_shader* shader, const char* name, se_texture* texture); // id resolved when applied
+extern void se_shader_set_texture_region(se_shader* shader, const char* name, se_texture* texture); // sampler name and vec4 name_rect
+extern void se_shader_set_texture_array(se_shader* shader, const char* name, const se_texture_array* array);
+extern b8 se_shader_bind_uniform_block(se_render_handle* render_handle, se_shader* shader, const char* name, const u32 binding, const void* data, const sz size); // copied to the dynamic ring, bound right away for the next draws
 extern void se_shader_set_buffer_texture(se_shader* shader, const char* name, se_render_buffer* buffer);
+extern se_program_cache_stats se_program_cache_get_stats(); // linked programs are kept in SE_CACHE_DIR when the driver supports program binaries
 
 // Mesh functions
 extern void se_mesh_translate(se_mesh* mesh, const se_vec3* v);
@@ -190,11 +547,25 @@ extern void se_mesh_scale(se_mesh* mesh, const se_vec3* v);
 
 // Model functions
 extern se_model* se_model_load_obj(se_render_handle* render_handle, const char* path, se_shaders_ptr* shaders);
+extern se_model* se_model_load_obj_async(se_render_handle* render_handle, const char* path, se_shaders_ptr* shaders);
+extern se_model* se_model_load_gltf(se_render_handle* render_handle, const char* path, se_shaders_ptr* shaders); // .gltf or .glb
 extern void se_model_render(se_render_handle* render_handle, se_model* model, se_camera* camera);
 extern void se_model_cleanup(se_model* model);
 extern void se_model_translate(se_model* model, const se_vec3* v);
 extern void se_model_rotate(se_model* model, const se_vec3* v);
 extern void se_model_scale(se_model* model, const se_vec3* v);
+extern void se_model_set_residency(se_model* model, const se_model_residency residency);
+extern b8 se_model_fetch_cpu_data(se_model* model); // fills mesh->vertices/indices from the cooked cache, or reads them back from the GPU
+extern void se_model_release_cpu_data(se_model* model);
+
+// Draw list functions (collects visible meshes and submits them sorted by shader, using multi draw indirect when available)
+extern void se_draw_list_begin(se_render_handle* render_handle, se_camera* camera);
+extern void se_draw_list_add_model(se_render_handle* render_handle, se_model* model);
+extern void se_draw_list_submit(se_render_handle* render_handle);
+extern void se_draw_list_cleanup(se_draw_list* draw_list);
+
+// Mesh pool functions
+extern void se_mesh_pool_cleanup(se_mesh_pool* pool);
 
 // camera functions
 extern se_camera* se_camera_create(se_render_handle* render_handle); 
@@ -204,17 +575,26 @@ extern void se_camera_set_aspect(se_camera* camera, const f32 width, const f32 h
 extern void se_camera_destroy(se_render_handle* render_handle, se_camera* camera);
 
 // Framebuffer functions
-extern se_framebuffer* se_framebuffer_create(se_render_handle* render_handle, const se_vec2* size);
+extern se_framebuffer* se_framebuffer_create(se_render_handle* render_handle, const se_vec2* size); // RGBA8 and depth
+extern se_framebuffer* se_framebuffer_create_desc(se_render_handle* render_handle, const se_render_target_desc* desc);
 extern void se_framebuffer_bind(se_framebuffer* framebuffer);
 extern void se_framebuffer_unbind(se_framebuffer* framebuffer);
 extern void se_framebuffer_use_quad_shader(se_framebuffer* framebuffer, se_render_handle* render_handle);
 extern void se_framebuffer_cleanup(se_framebuffer* framebuffer);
 
+// render target pool functions
+extern se_render_target* se_render_target_acquire(se_render_handle* render_handle, const se_render_target_desc* desc);
+extern void se_render_target_release(se_render_handle* render_handle, se_render_target* target);
+extern b8 se_render_target_desc_match(const se_render_target_desc* a, const se_render_target_desc* b);
+extern sz se_render_target_desc_get_size(const se_render_target_desc* desc); // bytes of all attachments
+
 // Render buffer functions
-extern se_render_buffer* se_render_buffer_create(se_render_handle* render_handle, const u32 width, const u32 height, const c8* fragment_shader_path);
+extern se_render_buffer* se_render_buffer_create(se_render_handle* render_handle, const u32 width, const u32 height, const c8* fragment_shader_path); // RGBA8 and depth
+extern se_render_buffer* se_render_buffer_create_desc(se_render_handle* render_handle, const se_render_target_desc* desc, const c8* fragment_shader_path);
 extern void se_render_buffer_set_shader(se_render_buffer* buffer, se_shader* shader);
 extern void se_render_buffer_unset_shader(se_render_buffer* buffer);
-extern void se_render_buffer_bind(se_render_buffer* buffer);
+extern void se_render_buffer_set_history(se_render_buffer* buffer, const b8 history); // set from the shader's u_prev, overrides it
+extern void se_render_buffer_bind(se_render_buffer* buffer); // with history, only the first bind of a frame swaps in last frame's output
 extern void se_render_buffer_unbind(se_render_buffer* buf);
 extern void se_render_buffer_set_scale(se_render_buffer* buffer, const se_vec2* scale);
 extern void se_render_buffer_set_position(se_render_buffer* buffer, const se_vec2* position);
@@ -227,12 +607,17 @@ extern void se_uniform_set_vec3     (se_uniforms* uniforms, const char* name, co
 extern void se_uniform_set_vec4     (se_uniforms* uniforms, const char* name, const se_vec4* value);
 extern void se_uniform_set_int      (se_uniforms* uniforms, const char* name, i32 value);
 extern void se_uniform_set_texture  (se_uniforms* uniforms, const char* name, GLuint texture);
+extern void se_uniform_set_texture_ref(se_uniforms* uniforms, const char* name, se_texture* texture); // id resolved when applied
+extern void se_uniform_set_texture_region(se_uniforms* uniforms, const char* name, se_texture* texture); // sampler name and vec4 name_rect
+extern void se_uniform_set_texture_array(se_uniforms* uniforms, const char* name, const se_texture_array* array);
 extern void se_uniform_set_buffer_texture(se_uniforms* uniforms, const char* name, se_render_buffer* buffer);
+extern void se_uniform_copy(se_uniforms* dst, const se_uniforms* src);
 extern void se_uniform_apply(se_render_handle* render_handle, se_shader* shader, const b8 update_global_uniforms);
 
 
 // Utility functions
 extern time_t get_file_mtime(const char* path);
+extern b8 se_cache_get_path(c8* out_path, const u64 key, const c8* extension);
 extern char* load_file(const char* path);
 
 #endif // SE_RENDER_H
@@ -0,0 +1,342 @@
+// Syphax-Engine - Ougi Washi
+
+#include "se_render_graph.h"
+#include "se_gl.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SE_RENDER_GRAPH_ALIVE (~0u) // last use of outputs, never handed to another resource
+
+se_render_graph* se_render_graph_create(se_render_handle* render_handle) {
+    se_render_graph* graph = malloc(sizeof(se_render_graph));
+    memset(graph, 0, sizeof(se_render_graph));
+    graph->render_handle = render_handle;
+    return graph;
+}
+
+static void se_render_graph_release_targets(se_render_graph* graph) {
+    se_foreach(se_render_graph_targets, graph->targets, i) {
+        se_render_target_release(graph->render_handle, se_render_graph_targets_get(&graph->targets, i)->target);
+    }
+    se_render_graph_targets_clear(&graph->targets);
+}
+
+void se_render_graph_destroy(se_render_graph* graph) {
+    se_render_graph_release_targets(graph);
+    free(graph);
+}
+
+static i32 se_render_graph_add_resource(se_render_graph* graph, const c8* name, const se_render_graph_resource_type type, const se_vec2* size) {
+    se_render_graph_resource* resource = se_render_graph_resources_increment(&graph->resources);
+    if (resource == NULL) {
+        fprintf(stderr, "se_render_graph_add_resource :: too many resources, max is %d\n", SE_RENDER_GRAPH_MAX_RESOURCES);
+        return -1;
+    }
+    memset(resource, 0, sizeof(se_render_graph_resource));
+    strncpy(resource->name, name, SE_MAX_NAME_LENGTH - 1);
+    resource->type = type;
+    resource->size = *size;
+    resource->producer = -1;
+    resource->target = -1;
+    graph->compiled = false;
+    return (i32)se_render_graph_resources_get_size(&graph->resources) - 1;
+}
+
+i32 se_render_graph_add_target(se_render_graph* graph, const c8* name, const se_render_target_desc* desc) {
+    const i32 index = se_render_graph_add_resource(graph, name, SE_RENDER_GRAPH_TRANSIENT, &desc->size);
+    if (index >= 0) {
+        se_render_graph_resources_get(&graph->resources, index)->desc = *desc;
+    }
+    return index;
+}
+
+i32 se_render_graph_import_texture(se_render_graph* graph, const c8* name, const GLuint texture, const se_vec2* size) {
+    const i32 index = se_render_graph_add_resource(graph, name, SE_RENDER_GRAPH_TEXTURE, size);
+    if (index >= 0) {
+        se_render_graph_resources_get(&graph->resources, index)->texture = texture;
+    }
+    return index;
+}
+
+i32 se_render_graph_import_framebuffer(se_render_graph* graph, const c8* name, se_framebuffer* framebuffer, const se_vec2* size) {
+    const i32 index = se_render_graph_add_resource(graph, name, SE_RENDER_GRAPH_FRAMEBUFFER, framebuffer ? &framebuffer->size : size);
+    if (index >= 0) {
+        se_render_graph_resources_get(&graph->resources, index)->framebuffer = framebuffer;
+    }
+    return index;
+}
+
+i32 se_render_graph_import_render_buffer(se_render_graph* graph, const c8* name, se_render_buffer* buffer) {
+    const i32 index = se_render_graph_add_resource(graph, name, SE_RENDER_GRAPH_RENDER_BUFFER, &buffer->texture_size);
+    if (index >= 0) {
+        se_render_graph_resources_get(&graph->resources, index)->render_buffer = buffer;
+    }
+    return index;
+}
+
+static b8 se_render_graph_is_resource(se_render_graph* graph, const i32 resource) {
+    return resource >= 0 && resource < (i32)se_render_graph_resources_get_size(&graph->resources);
+}
+
+void se_render_graph_set_output(se_render_graph* graph, const i32 resource) {
+    if (se_render_graph_is_resource(graph, resource)) {
+        se_render_graph_resources_get(&graph->resources, resource)->output = true;
+        graph->compiled = false;
+    }
+}
+
+i32 se_render_graph_add_pass(se_render_graph* graph, const c8* name, se_shader* shader, const i32 output) {
+    if (!se_render_graph_is_resource(graph, output) || shader == NULL) {
+        fprintf(stderr, "se_render_graph_add_pass :: %s needs a shader and an output\n", name);
+        return -1;
+    }
+    se_render_graph_pass* pass = se_render_graph_passes_increment(&graph->passes);
+    if (pass == NULL) {
+        fprintf(stderr, "se_render_graph_add_pass :: too many passes, max is %d\n", SE_RENDER_GRAPH_MAX_PASSES);
+        return -1;
+    }
+    memset(pass, 0, sizeof(se_render_graph_pass));
+    strncpy(pass->name, name, SE_MAX_NAME_LENGTH - 1);
+    pass->shader = shader;
+    pass->output = output;
+    graph->compiled = false;
+    return (i32)se_render_graph_passes_get_size(&graph->passes) - 1;
+}
+
+b8 se_render_graph_pass_read(se_render_graph* graph, const i32 pass_index, const i32 resource, const c8* uniform_name) {
+    return se_render_graph_pass_read_attachment(graph, pass_index, resource, 0, uniform_name);
+}
+
+b8 se_render_graph_pass_read_attachment(se_render_graph* graph, const i32 pass_index, const i32 resource, const u32 attachment, const c8* uniform_name) {
+    if (attachment >= SE_MAX_TARGET_ATTACHMENTS || pass_index < 0 || pass_index >= (i32)se_render_graph_passes_get_size(&graph->passes) || !se_render_graph_is_resource(graph, resource)) {
+        fprintf(stderr, "se_render_graph_pass_read :: invalid pass or resource\n");
+        return false;
+    }
+    se_render_graph_pass* pass = se_render_graph_passes_get(&graph->passes, pass_index);
+    if (pass->input_count == SE_RENDER_GRAPH_MAX_INPUTS) {
+        fprintf(stderr, "se_render_graph_pass_read :: too many inputs for %s, max is %d\n", pass->name, SE_RENDER_GRAPH_MAX_INPUTS);
+        return false;
+    }
+    pass->inputs[pass->input_count] = resource;
+    pass->input_attachments[pass->input_count] = attachment;
+    strncpy(pass->input_uniforms[pass->input_count], uniform_name, SE_MAX_NAME_LENGTH - 1);
+    pass->input_count++;
+    graph->compiled = false;
+    return true;
+}
+
+static b8 se_render_graph_is_output(const se_render_graph_resource* resource) {
+    return resource->output || resource->type == SE_RENDER_GRAPH_FRAMEBUFFER || resource->type == SE_RENDER_GRAPH_RENDER_BUFFER;
+}
+
+// Depth first, producers of the inputs are scheduled before the pass reading them
+static b8 se_render_graph_visit(se_render_graph* graph, const u32 pass_index, u8* state) {
+    se_render_graph_pass* pass = se_render_graph_passes_get(&graph->passes, pass_index);
+    if (state[pass_index] == 2) {
+        return true;
+    }
+    if (state[pass_index] == 1) {
+        fprintf(stderr, "se_render_graph_compile :: %s depends on its own output\n", pass->name);
+        return false;
+    }
+    state[pass_index] = 1;
+    for (u32 i = 0; i < pass->input_count; i++) {
+        se_render_graph_resource* input = se_render_graph_resources_get(&graph->resources, pass->inputs[i]);
+        if (input->producer >= 0) {
+            if (!se_render_graph_visit(graph, input->producer, state)) {
+                return false;
+            }
+        } else if (input->type == SE_RENDER_GRAPH_TRANSIENT) {
+            fprintf(stderr, "se_render_graph_compile :: %s reads %s which no pass writes\n", pass->name, input->name);
+            return false;
+        }
+    }
+    state[pass_index] = 2;
+    graph->schedule[graph->schedule_count++] = pass_index;
+    return true;
+}
+
+static i32 se_render_graph_create_target(se_render_graph* graph, const se_render_target_desc* desc) {
+    se_render_graph_target* target = se_render_graph_targets_increment(&graph->targets);
+    if (target == NULL) {
+        fprintf(stderr, "se_render_graph_compile :: too many targets, max is %d\n", SE_RENDER_GRAPH_MAX_TARGETS);
+        return -1;
+    }
+    target->target = se_render_target_acquire(graph->render_handle, desc);
+    target->free_after = 0;
+    if (target->target == NULL) {
+        se_render_graph_targets_remove_at(&graph->targets, se_render_graph_targets_get_size(&graph->targets) - 1);
+        return -1;
+    }
+    return (i32)se_render_graph_targets_get_size(&graph->targets) - 1;
+}
+
+b8 se_render_graph_compile(se_render_graph* graph) {
+    graph->compiled = true;
+    graph->failed = true;
+    graph->schedule_count = 0;
+    se_render_graph_release_targets(graph);
+
+    se_foreach(se_render_graph_resources, graph->resources, i) {
+        se_render_graph_resource* resource = se_render_graph_resources_get(&graph->resources, i);
+        resource->producer = -1;
+        resource->target = -1;
+        resource->first_use = 0;
+        resource->last_use = 0;
+    }
+    se_foreach(se_render_graph_passes, graph->passes, i) {
+        se_render_graph_pass* pass = se_render_graph_passes_get(&graph->passes, i);
+        se_render_graph_resource* output = se_render_graph_resources_get(&graph->resources, pass->output);
+        if (output->type == SE_RENDER_GRAPH_TEXTURE) {
+            fprintf(stderr, "se_render_graph_compile :: %s writes the read only texture %s\n", pass->name, output->name);
+            return false;
+        }
+        if (output->producer >= 0) {
+            fprintf(stderr, "se_render_graph_compile :: %s is written by %s and %s\n", output->name,
+                    se_render_graph_passes_get(&graph->passes, output->producer)->name, pass->name);
+            return false;
+        }
+        output->producer = (i32)i;
+        pass->culled = true;
+    }
+
+    // walk back from the outputs, whatever isn't reached is culled
+    u32 stack[SE_RENDER_GRAPH_MAX_PASSES];
+    u32 stack_count = 0;
+    se_foreach(se_render_graph_resources, graph->resources, i) {
+        se_render_graph_resource* resource = se_render_graph_resources_get(&graph->resources, i);
+        if (se_render_graph_is_output(resource) && resource->producer >= 0) {
+            se_render_graph_passes_get(&graph->passes, resource->producer)->culled = false;
+            stack[stack_count++] = resource->producer;
+        }
+    }
+    while (stack_count > 0) {
+        se_render_graph_pass* pass = se_render_graph_passes_get(&graph->passes, stack[--stack_count]);
+        for (u32 i = 0; i < pass->input_count; i++) {
+            const i32 producer = se_render_graph_resources_get(&graph->resources, pass->inputs[i])->producer;
+            if (producer >= 0 && se_render_graph_passes_get(&graph->passes, producer)->culled) {
+                se_render_graph_passes_get(&graph->passes, producer)->culled = false;
+                stack[stack_count++] = producer;
+            }
+        }
+    }
+
+    u8 state[SE_RENDER_GRAPH_MAX_PASSES] = {0};
+    se_foreach(se_render_graph_passes, graph->passes, i) {
+        if (!se_render_graph_passes_get(&graph->passes, i)->culled && !se_render_graph_visit(graph, i, state)) {
+            return false;
+        }
+    }
+
+    // lifetimes in schedule positions, a resource lives from its write to its last read
+    for (u32 position = 0; position < graph->schedule_count; position++) {
+        se_render_graph_pass* pass = se_render_graph_passes_get(&graph->passes, graph->schedule[position]);
+        se_render_graph_resource* output = se_render_graph_resources_get(&graph->resources, pass->output);
+        output->first_use = position;
+        output->last_use = se_render_graph_is_output(output) ? SE_RENDER_GRAPH_ALIVE : position;
+        for (u32 i = 0; i < pass->input_count; i++) {
+            se_render_graph_resource* input = se_render_graph_resources_get(&graph->resources, pass->inputs[i]);
+            if (input->last_use < position) {
+                input->last_use = position;
+            }
+        }
+    }
+
+    // transients take any target of their desc that nothing reads anymore
+    u32 transient_count = 0;
+    sz transient_size = 0;
+    for (u32 position = 0; position < graph->schedule_count; position++) {
+        se_render_graph_pass* pass = se_render_graph_passes_get(&graph->passes, graph->schedule[position]);
+        se_render_graph_resource* output = se_render_graph_resources_get(&graph->resources, pass->output);
+        if (output->type != SE_RENDER_GRAPH_TRANSIENT) {
+            continue;
+        }
+        transient_count++;
+        transient_size += se_render_target_desc_get_size(&output->desc);
+        se_foreach(se_render_graph_targets, graph->targets, i) {
+            se_render_graph_target* target = se_render_graph_targets_get(&graph->targets, i);
+            if (target->free_after < position && se_render_target_desc_match(&target->target->desc, &output->desc)) {
+                output->target = (i32)i;
+                break;
+            }
+        }
+        if (output->target < 0) {
+            output->target = se_render_graph_create_target(graph, &output->desc);
+            if (output->target < 0) {
+                return false;
+            }
+        }
+        se_render_graph_targets_get(&graph->targets, output->target)->free_after = output->last_use;
+    }
+
+    sz target_size = 0;
+    se_foreach(se_render_graph_targets, graph->targets, i) {
+        target_size += se_render_target_desc_get_size(&se_render_graph_targets_get(&graph->targets, i)->target->desc);
+    }
+    graph->failed = false;
+    printf("Render graph - %u passes scheduled, %u culled, %u targets (%zu KB) for %u transient resources (%zu KB)\n", graph->schedule_count,
+           (u32)se_render_graph_passes_get_size(&graph->passes) - graph->schedule_count, (u32)se_render_graph_targets_get_size(&graph->targets),
+           target_size / 1024, transient_count, transient_size / 1024);
+    return true;
+}
+
+GLuint se_render_graph_get_texture(se_render_graph* graph, const i32 resource_index, const u32 attachment) {
+    if (!se_render_graph_is_resource(graph, resource_index) || attachment >= SE_MAX_TARGET_ATTACHMENTS) {
+        return 0;
+    }
+    se_render_graph_resource* resource = se_render_graph_resources_get(&graph->resources, resource_index);
+    switch (resource->type) {
+        case SE_RENDER_GRAPH_TRANSIENT:
+            return resource->target >= 0 ? se_render_graph_targets_get(&graph->targets, resource->target)->target->textures[attachment] : 0;
+        case SE_RENDER_GRAPH_TEXTURE:
+            return attachment == 0 ? resource->texture : 0;
+        case SE_RENDER_GRAPH_FRAMEBUFFER:
+            return resource->framebuffer ? resource->framebuffer->textures[attachment] : 0;
+        case SE_RENDER_GRAPH_RENDER_BUFFER:
+            return resource->render_buffer->target.textures[attachment];
+    }
+    return 0;
+}
+
+void se_render_graph_execute(se_render_graph* graph, se_render_handle* render_handle, se_window* window) {
+    if (!graph->compiled) {
+        se_render_graph_compile(graph);
+    }
+    if (graph->failed) {
+        return;
+    }
+    // full screen passes: outputs with a depth attachment (render buffers) are never cleared, so the quad must not be depth tested
+    const GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean depth_write = GL_TRUE;
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depth_write);
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    for (u32 position = 0; position < graph->schedule_count; position++) {
+        se_render_graph_pass* pass = se_render_graph_passes_get(&graph->passes, graph->schedule[position]);
+        se_render_graph_resource* output = se_render_graph_resources_get(&graph->resources, pass->output);
+        switch (output->type) {
+            case SE_RENDER_GRAPH_TRANSIENT:
+                glBindFramebuffer(GL_FRAMEBUFFER, se_render_graph_targets_get(&graph->targets, output->target)->target->framebuffer);
+                break;
+            case SE_RENDER_GRAPH_FRAMEBUFFER:
+                glBindFramebuffer(GL_FRAMEBUFFER, output->framebuffer ? output->framebuffer->framebuffer : 0);
+                break;
+            case SE_RENDER_GRAPH_RENDER_BUFFER:
+                se_render_buffer_bind(output->render_buffer); // swaps in its history first
+                break;
+            case SE_RENDER_GRAPH_TEXTURE:
+                break;
+        }
+        glViewport(0, 0, output->size.x, output->size.y);
+        for (u32 i = 0; i < pass->input_count; i++) {
+            se_shader_set_texture(pass->shader, pass->input_uniforms[i], se_render_graph_get_texture(graph, pass->inputs[i], pass->input_attachments[i]));
+        }
+        se_shader_use(render_handle, pass->shader, true, true);
+        se_window_render_quad(window);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDepthMask(depth_write);
+    if (depth_test) {
+        glEnable(GL_DEPTH_TEST);
+    }
+}
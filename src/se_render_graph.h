@@ -0,0 +1,92 @@
+// Syphax-Engine - Ougi Washi
+
+// Render graph for full-screen pass chains. Passes declare the resources they read and the one they write, the
+// graph is compiled once into a schedule: passes that don't contribute to an output are culled, the rest run after
+// their producers, and transient targets whose lifetimes don't overlap share the same render target from the pool.
+
+#ifndef SE_RENDER_GRAPH_H
+#define SE_RENDER_GRAPH_H
+
+#include "se_render.h"
+#include "se_window.h"
+
+#define SE_RENDER_GRAPH_MAX_PASSES 32
+#define SE_RENDER_GRAPH_MAX_RESOURCES 32
+#define SE_RENDER_GRAPH_MAX_TARGETS 16 // acquired from the render handle's pool
+#define SE_RENDER_GRAPH_MAX_INPUTS 4
+
+typedef enum {
+    SE_RENDER_GRAPH_TRANSIENT, // owned by the graph, contents only live until the last pass reading them
+    SE_RENDER_GRAPH_TEXTURE, // external, read only
+    SE_RENDER_GRAPH_FRAMEBUFFER, // external, NULL framebuffer for the window
+    SE_RENDER_GRAPH_RENDER_BUFFER // external, bound through se_render_buffer_bind so it keeps its history
+} se_render_graph_resource_type;
+
+typedef struct {
+    c8 name[SE_MAX_NAME_LENGTH];
+    se_render_graph_resource_type type;
+    se_vec2 size;
+    se_render_target_desc desc; // SE_RENDER_GRAPH_TRANSIENT
+    GLuint texture; // SE_RENDER_GRAPH_TEXTURE
+    se_framebuffer* framebuffer;
+    se_render_buffer* render_buffer;
+    b8 output; // read after the graph ran, external writable resources always are
+
+    // compiled
+    i32 producer; // pass writing it, -1 for none
+    i32 target; // transient target, -1 for none
+    u32 first_use; // schedule positions
+    u32 last_use;
+} se_render_graph_resource;
+SE_DEFINE_ARRAY(se_render_graph_resource, se_render_graph_resources, SE_RENDER_GRAPH_MAX_RESOURCES);
+
+typedef struct {
+    c8 name[SE_MAX_NAME_LENGTH];
+    se_shader* shader;
+    u32 inputs[SE_RENDER_GRAPH_MAX_INPUTS];
+    c8 input_uniforms[SE_RENDER_GRAPH_MAX_INPUTS][SE_MAX_NAME_LENGTH]; // sampler each input is bound to
+    u32 input_attachments[SE_RENDER_GRAPH_MAX_INPUTS]; // color attachment sampled
+    u32 input_count;
+    u32 output;
+    b8 culled;
+} se_render_graph_pass;
+SE_DEFINE_ARRAY(se_render_graph_pass, se_render_graph_passes, SE_RENDER_GRAPH_MAX_PASSES);
+
+// Physical storage transient resources are aliased onto
+typedef struct {
+    se_render_target* target;
+    u32 free_after; // schedule position of the last read of its current resource
+} se_render_graph_target;
+SE_DEFINE_ARRAY(se_render_graph_target, se_render_graph_targets, SE_RENDER_GRAPH_MAX_TARGETS);
+
+typedef struct {
+    se_render_handle* render_handle;
+    se_render_graph_passes passes;
+    se_render_graph_resources resources;
+    se_render_graph_targets targets;
+    u32 schedule[SE_RENDER_GRAPH_MAX_PASSES];
+    u32 schedule_count;
+    b8 compiled; // cleared by any change, se_render_graph_execute compiles again
+    b8 failed; // last compile failed, nothing runs until the graph changes
+} se_render_graph;
+
+extern se_render_graph* se_render_graph_create(se_render_handle* render_handle);
+extern void se_render_graph_destroy(se_render_graph* graph);
+
+// Resources, each returns its index or -1
+extern i32 se_render_graph_add_target(se_render_graph* graph, const c8* name, const se_render_target_desc* desc);
+extern i32 se_render_graph_import_texture(se_render_graph* graph, const c8* name, const GLuint texture, const se_vec2* size);
+extern i32 se_render_graph_import_framebuffer(se_render_graph* graph, const c8* name, se_framebuffer* framebuffer, const se_vec2* size); // size is only used for the window
+extern i32 se_render_graph_import_render_buffer(se_render_graph* graph, const c8* name, se_render_buffer* buffer);
+extern void se_render_graph_set_output(se_render_graph* graph, const i32 resource); // keeps a transient alive after the graph
+
+// Passes draw a full-screen quad with shader into output, each resource is written by one pass at most
+extern i32 se_render_graph_add_pass(se_render_graph* graph, const c8* name, se_shader* shader, const i32 output);
+extern b8 se_render_graph_pass_read(se_render_graph* graph, const i32 pass, const i32 resource, const c8* uniform_name);
+extern b8 se_render_graph_pass_read_attachment(se_render_graph* graph, const i32 pass, const i32 resource, const u32 attachment, const c8* uniform_name);
+
+extern b8 se_render_graph_compile(se_render_graph* graph);
+extern void se_render_graph_execute(se_render_graph* graph, se_render_handle* render_handle, se_window* window);
+extern GLuint se_render_graph_get_texture(se_render_graph* graph, const i32 resource, const u32 attachment); // 0 for the window
+
+#endif // SE_RENDER_GRAPH_H
@@ -0,0 +1,145 @@
+// Syphax-Engine - Ougi Washi
+
+#include "se_ring_buffer.h"
+#include "se_math.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void se_ring_buffer_init(se_ring_buffer* ring, const sz size) {
+    memset(ring, 0, sizeof(se_ring_buffer));
+    ring->size = size;
+    glGenBuffers(1, &ring->buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ring->buffer);
+    if (se_gl_caps.buffer_storage) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, size, NULL, flags);
+        ring->mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+    }
+    if (!ring->mapped) {
+        glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, GL_STREAM_DRAW);
+        ring->shadow = malloc(size);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+static void se_ring_buffer_pop_fence(se_ring_buffer* ring, const b8 wait) {
+    se_ring_fence* fence = &ring->fences[ring->fence_first];
+    if (wait) {
+        glClientWaitSync(fence->sync, GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
+    }
+    glDeleteSync(fence->sync);
+    ring->retired = fence->position;
+    ring->fence_first = (ring->fence_first + 1) % SE_RING_BUFFER_MAX_FENCES;
+    ring->fence_count--;
+}
+
+// Blocks until the GPU is done with everything before position
+static void se_ring_buffer_wait(se_ring_buffer* ring, const u64 position) {
+    while (ring->retired < position) {
+        if (ring->fence_count == 0) {
+            // nothing fenced the data in the way, finish has to do it
+            glFinish();
+            ring->retired = ring->head;
+            return;
+        }
+        se_ring_buffer_pop_fence(ring, true);
+    }
+}
+
+// Copies a range of the shadow, split where it wraps. Ranges are never in use by the GPU
+// (the storage is orphaned before the ring comes back to them), so no synchronization is needed
+static void se_ring_buffer_upload(se_ring_buffer* ring, const u64 start, const u64 end) {
+    u64 position = start;
+    while (position < end) {
+        const sz offset = position % ring->size;
+        const sz size = (sz)min(end - position, (u64)(ring->size - offset));
+        void* out = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (out) {
+            memcpy(out, ring->shadow + offset, size);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        }
+        position += size;
+    }
+}
+
+void* se_ring_buffer_alloc(se_ring_buffer* ring, const sz size, const sz alignment, sz* out_offset) {
+    if (size == 0 || size > ring->size) {
+        fprintf(stderr, "se_ring_buffer_alloc :: %zu bytes don't fit in the ring (%zu)\n", size, ring->size);
+        return NULL;
+    }
+    sz offset = ring->head % ring->size;
+    u64 position = ring->head;
+    const sz aligned = (offset + alignment - 1) / alignment * alignment;
+    if (aligned + size > ring->size) {
+        // wrap, the tail of the ring stays unused
+        position += ring->size - offset;
+        offset = 0;
+        if (ring->shadow) {
+            // fresh storage, in flight commands keep the old one and the current batch is copied again
+            glBindBuffer(GL_COPY_WRITE_BUFFER, ring->buffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, ring->size, NULL, GL_STREAM_DRAW);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            ring->flushed = max(ring->batch_start, position - ring->size);
+        }
+    } else {
+        position += aligned - offset;
+        offset = aligned;
+    }
+
+    if (ring->mapped && position + size > ring->size) {
+        se_ring_buffer_wait(ring, position + size - ring->size);
+    }
+    ring->head = position + size;
+    *out_offset = offset;
+    return (ring->mapped ? ring->mapped : ring->shadow) + offset;
+}
+
+void se_ring_buffer_flush(se_ring_buffer* ring) {
+    // the persistent mapping is coherent, writes are visible to commands issued after them
+    if (!ring->shadow || ring->flushed == ring->head) {
+        return;
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ring->buffer);
+    se_ring_buffer_upload(ring, max(ring->flushed, ring->head > ring->size ? ring->head - ring->size : 0), ring->head);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    ring->flushed = ring->head;
+}
+
+void se_ring_buffer_fence(se_ring_buffer* ring) {
+    if (ring->shadow) {
+        ring->batch_start = ring->head;
+        return;
+    }
+    if (ring->fence_count == SE_RING_BUFFER_MAX_FENCES) {
+        se_ring_buffer_pop_fence(ring, true);
+    }
+    // the ones that signaled already can go
+    while (ring->fence_count > 0) {
+        const GLenum result = glClientWaitSync(ring->fences[ring->fence_first].sync, 0, 0);
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        se_ring_buffer_pop_fence(ring, false);
+    }
+    se_ring_fence* fence = &ring->fences[(ring->fence_first + ring->fence_count) % SE_RING_BUFFER_MAX_FENCES];
+    fence->sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    fence->position = ring->head;
+    ring->fence_count++;
+}
+
+void se_ring_buffer_cleanup(se_ring_buffer* ring) {
+    while (ring->fence_count > 0) {
+        se_ring_buffer_pop_fence(ring, false);
+    }
+    if (ring->mapped) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ring->buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    if (ring->buffer) {
+        glDeleteBuffers(1, &ring->buffer);
+    }
+    free(ring->shadow);
+    memset(ring, 0, sizeof(se_ring_buffer));
+}
@@ -0,0 +1,43 @@
+// Syphax-Engine - Ougi Washi
+
+// Ring allocator for data rewritten every frame (transforms, draw commands, uniform blocks).
+// With buffer storage the ring is mapped once, persistently, and allocations are written in place;
+// fences mark how far the GPU got so the ring never overwrites data still being read.
+// Without it allocations go to a CPU shadow, se_ring_buffer_flush copies them over and the buffer is
+// orphaned every time the ring wraps.
+
+#ifndef SE_RING_BUFFER_H
+#define SE_RING_BUFFER_H
+
+#include "se_types.h"
+#include "se_gl.h"
+
+#define SE_RING_BUFFER_SIZE (4 * 1024 * 1024)
+#define SE_RING_BUFFER_MAX_FENCES 32
+
+typedef struct {
+    GLsync sync;
+    u64 position; // everything allocated before it is free once signaled
+} se_ring_fence;
+
+typedef struct {
+    GLuint buffer;
+    sz size;
+    u8* mapped; // persistent mapping, NULL when orphaning
+    u8* shadow; // orphaning only
+    u64 head; // bytes allocated so far, wrapped into the ring
+    u64 flushed; // orphaning only, copied up to here
+    u64 batch_start; // orphaning only, first position since the last fence
+    u64 retired; // persistent only, the GPU is done with everything before it
+    se_ring_fence fences[SE_RING_BUFFER_MAX_FENCES];
+    u32 fence_first;
+    u32 fence_count;
+} se_ring_buffer;
+
+extern void se_ring_buffer_init(se_ring_buffer* ring, const sz size);
+extern void* se_ring_buffer_alloc(se_ring_buffer* ring, const sz size, const sz alignment, sz* out_offset); // NULL if it can't fit
+extern void se_ring_buffer_flush(se_ring_buffer* ring); // before the GPU reads what was allocated
+extern void se_ring_buffer_fence(se_ring_buffer* ring); // after the commands reading it were issued
+extern void se_ring_buffer_cleanup(se_ring_buffer* ring);
+
+#endif // SE_RING_BUFFER_H
@@ -2,6 +2,7 @@
 
 #include "se_scene.h"
 #include <stdlib.h>
+#include <math.h>
 
 // Scene handle is not responsible for allocating memory
 // It is only used for referencing the scenes and use rendering handle to render the objects in the scenes or such.
@@ -31,10 +32,16 @@ se_object_2d* se_object_2d_create(se_scene_handle* scene_handle, const c8* fragm
     se_object_2d* new_object = se_objects_2d_increment(&scene_handle->objects_2d);
     new_object->position = *position;
     new_object->scale = *scale;
+    new_object->shader = NULL;
     if (scene_handle->render_handle) {
+        // objects with the same fragment shader share the instance, uniforms are set right before each draw
+        c8 vertex_path[SE_MAX_PATH_LENGTH] = {0};
+        c8 fragment_path[SE_MAX_PATH_LENGTH] = {0};
+        snprintf(vertex_path, SE_MAX_PATH_LENGTH, "%s%s", RESOURCES_DIR, SE_OBJECT_2D_VERTEX_SHADER_PATH);
+        snprintf(fragment_path, SE_MAX_PATH_LENGTH, "%s%s", RESOURCES_DIR, fragment_shader_path);
         se_foreach(se_shaders, scene_handle->render_handle->shaders, i) {
             se_shader* curr_shader = se_shaders_get(&scene_handle->render_handle->shaders, i);
-            if (curr_shader && strcmp(curr_shader->fragment_path, fragment_shader_path) == 0) {
+            if (curr_shader && strcmp(curr_shader->vertex_path, vertex_path) == 0 && strcmp(curr_shader->fragment_path, fragment_path) == 0) {
                 new_object->shader = curr_shader;
                 break;
             }
@@ -78,11 +85,16 @@ se_scene_2d* se_scene_2d_create(se_scene_handle* scene_handle, const se_vec2* si
     printf("Creating scene 2D\n");
     se_scene_2d* new_scene = se_scenes_2d_increment(&scene_handle->scenes_2d);
     if (scene_handle->render_handle) {
-        new_scene->output = se_framebuffer_create(scene_handle->render_handle, size);
+        // objects are blended in order, no depth
+        const se_render_target_desc desc = { .size = *size };
+        new_scene->output = se_framebuffer_create_desc(scene_handle->render_handle, &desc);
     }
     else {
         new_scene->output = NULL;
     }
+    new_scene->dirty_count = 0;
+    new_scene->animation_fps = 0;
+    se_scene_2d_invalidate(new_scene);
     return new_scene;
 }
 
@@ -91,26 +103,163 @@ void se_scene_2d_destroy(se_scene_handle* scene_handle, se_scene_2d* scene) {
     se_scenes_2d_remove(&scene_handle->scenes_2d, scene);
 }
 
+static b8 se_dirty_rect_is_empty(const se_dirty_rect* rect) {
+    return rect->min_x >= rect->max_x || rect->min_y >= rect->max_y;
+}
+
+static b8 se_dirty_rect_overlaps(const se_dirty_rect* a, const se_dirty_rect* b) {
+    return a->min_x < b->max_x && b->min_x < a->max_x && a->min_y < b->max_y && b->min_y < a->max_y;
+}
+
+static se_dirty_rect se_dirty_rect_union(const se_dirty_rect* a, const se_dirty_rect* b) {
+    return (se_dirty_rect){
+        .min_x = a->min_x < b->min_x ? a->min_x : b->min_x,
+        .min_y = a->min_y < b->min_y ? a->min_y : b->min_y,
+        .max_x = a->max_x > b->max_x ? a->max_x : b->max_x,
+        .max_y = a->max_y > b->max_y ? a->max_y : b->max_y
+    };
+}
+
+// The quad spans -1 to 1 before u_scale and u_position, a pixel of margin covers filtering at the edges
+static se_dirty_rect se_object_2d_get_bounds(const se_object_2d* object, const se_vec2* size) {
+    const f32 half_x = fabsf(object->scale.x);
+    const f32 half_y = fabsf(object->scale.y);
+    se_dirty_rect rect = {
+        .min_x = (i32)floorf((object->position.x - half_x + 1.0f) * 0.5f * size->x) - 1,
+        .min_y = (i32)floorf((object->position.y - half_y + 1.0f) * 0.5f * size->y) - 1,
+        .max_x = (i32)ceilf((object->position.x + half_x + 1.0f) * 0.5f * size->x) + 1,
+        .max_y = (i32)ceilf((object->position.y + half_y + 1.0f) * 0.5f * size->y) + 1
+    };
+    rect.min_x = rect.min_x < 0 ? 0 : rect.min_x;
+    rect.min_y = rect.min_y < 0 ? 0 : rect.min_y;
+    rect.max_x = rect.max_x > (i32)size->x ? (i32)size->x : rect.max_x;
+    rect.max_y = rect.max_y > (i32)size->y ? (i32)size->y : rect.max_y;
+    return rect;
+}
+
+// Everything that changes how the object looks, placement uniforms are left out as every draw sets them
+static u64 se_object_2d_hash(const se_object_2d* object) {
+    u64 hash = se_hash(&object->position, sizeof(se_vec2), SE_HASH_SEED);
+    hash = se_hash(&object->scale, sizeof(se_vec2), hash);
+    hash = se_hash(&object->shader, sizeof(se_shader*), hash);
+    if (object->shader == NULL) {
+        return hash;
+    }
+    hash = se_hash(&object->shader->program, sizeof(GLuint), hash);
+    se_foreach(se_uniforms, object->shader->uniforms, i) {
+        const se_uniform* uniform = se_uniforms_get(&object->shader->uniforms, i);
+        if (strcmp(uniform->name, "u_position") == 0 || strcmp(uniform->name, "u_scale") == 0) {
+            continue;
+        }
+        hash = se_hash(uniform->name, strlen(uniform->name), hash);
+        hash = se_hash(&uniform->type, sizeof(se_uniform_type), hash);
+        switch (uniform->type) {
+            case SE_UNIFORM_FLOAT: hash = se_hash(&uniform->value.f, sizeof(f32), hash); break;
+            case SE_UNIFORM_VEC2: hash = se_hash(&uniform->value.vec2, sizeof(se_vec2), hash); break;
+            case SE_UNIFORM_VEC3: hash = se_hash(&uniform->value.vec3, sizeof(se_vec3), hash); break;
+            case SE_UNIFORM_VEC4: hash = se_hash(&uniform->value.vec4, sizeof(se_vec4), hash); break;
+            case SE_UNIFORM_INT: hash = se_hash(&uniform->value.i, sizeof(i32), hash); break;
+            case SE_UNIFORM_TEXTURE:
+            case SE_UNIFORM_TEXTURE_ARRAY:
+                hash = se_hash(&uniform->value.texture, sizeof(GLuint), hash);
+                hash = se_hash(&uniform->sampler, sizeof(GLuint), hash);
+                break;
+            case SE_UNIFORM_BUFFER_TEXTURE: hash = se_hash(uniform->value.texture_ref, sizeof(GLuint), hash); break;
+            case SE_UNIFORM_TEXTURE_REF:
+                hash = se_hash(&uniform->value.texture_asset->id, sizeof(GLuint), hash);
+                hash = se_hash(&uniform->value.texture_asset->sampler, sizeof(GLuint), hash);
+                break;
+            case SE_UNIFORM_TEXTURE_RECT: hash = se_hash(&uniform->value.texture_asset->uv_rect, sizeof(se_vec4), hash); break;
+        }
+    }
+    return hash;
+}
+
+// Overlapping rects are merged, a full list folds the new one into its last
+static void se_scene_2d_mark_dirty(se_scene_2d* scene, se_dirty_rect rect) {
+    if (se_dirty_rect_is_empty(&rect)) {
+        return;
+    }
+    for (u32 i = 0; i < scene->dirty_count;) {
+        if (se_dirty_rect_overlaps(&scene->dirty[i], &rect)) {
+            rect = se_dirty_rect_union(&scene->dirty[i], &rect);
+            scene->dirty[i] = scene->dirty[--scene->dirty_count];
+            i = 0;
+        } else {
+            i++;
+        }
+    }
+    if (scene->dirty_count == SE_MAX_DIRTY_RECTS) {
+        rect = se_dirty_rect_union(&scene->dirty[--scene->dirty_count], &rect);
+        se_scene_2d_mark_dirty(scene, rect);
+        return;
+    }
+    scene->dirty[scene->dirty_count++] = rect;
+}
+
+// Every frame of an animated scene changes, the whole output is redrawn and the window keeps the rate on demand
+void se_scene_2d_set_animation_rate(se_scene_2d* scene, const f32 fps) {
+    scene->animation_fps = fps;
+}
+
+void se_scene_2d_invalidate(se_scene_2d* scene) {
+    if (scene->output == NULL) {
+        return;
+    }
+    scene->dirty_count = 0;
+    se_scene_2d_mark_dirty(scene, (se_dirty_rect){ 0, 0, (i32)scene->output->size.x, (i32)scene->output->size.y });
+}
+
+// Nothing is drawn when no object changed, otherwise each dirty rect is cleared under a scissor and the objects
+// overlapping it are drawn again in order
 void se_scene_2d_render(se_scene_2d* scene, se_render_handle* render_handle, se_window* window) {
     if (render_handle == NULL) {
         return;
     }
+    if (scene->animation_fps > 0) {
+        se_window_schedule_frame(window, scene->animation_fps);
+        se_scene_2d_invalidate(scene);
+    }
 
-    se_framebuffer_bind(scene->output);
-    se_render_clear();
-    se_enable_blending();
-    
     se_foreach(se_objects_2d_ptr, scene->objects, i) {
-        se_object_2d_ptr* object_ptr = se_objects_2d_ptr_get(&scene->objects, i);
-        if (object_ptr == NULL) {
-            printf("Warning: se_scene_2d_render :: object_ptr is null\n");
+        se_object_2d* current_object = *se_objects_2d_ptr_get(&scene->objects, i);
+        se_object_2d_drawn* drawn = &scene->drawn[i];
+        const u64 hash = se_object_2d_hash(current_object);
+        const se_dirty_rect bounds = se_object_2d_get_bounds(current_object, &scene->output->size);
+        if (drawn->drawn && drawn->hash == hash && memcmp(&drawn->bounds, &bounds, sizeof(se_dirty_rect)) == 0) {
             continue;
         }
-        se_object_2d* current_object = *object_ptr;
-        se_object_2d_update_uniforms(current_object);
-        se_shader_use(render_handle, current_object->shader, true, true);
-        se_window_render_quad(window);
+        if (drawn->drawn) {
+            se_scene_2d_mark_dirty(scene, drawn->bounds);
+        }
+        se_scene_2d_mark_dirty(scene, bounds);
+        drawn->hash = hash;
+        drawn->bounds = bounds;
+        drawn->drawn = true;
     }
+    if (scene->dirty_count == 0) {
+        return;
+    }
+
+    se_framebuffer_bind(scene->output);
+    se_enable_blending();
+    glEnable(GL_SCISSOR_TEST);
+    for (u32 rect = 0; rect < scene->dirty_count; rect++) {
+        const se_dirty_rect* dirty = &scene->dirty[rect];
+        glScissor(dirty->min_x, dirty->min_y, dirty->max_x - dirty->min_x, dirty->max_y - dirty->min_y);
+        se_render_clear();
+        se_foreach(se_objects_2d_ptr, scene->objects, i) {
+            se_object_2d* current_object = *se_objects_2d_ptr_get(&scene->objects, i);
+            if (current_object->shader == NULL || !se_dirty_rect_overlaps(&scene->drawn[i].bounds, dirty)) {
+                continue;
+            }
+            se_object_2d_update_uniforms(current_object);
+            se_shader_use(render_handle, current_object->shader, true, true);
+            se_window_render_quad(window);
+        }
+    }
+    glDisable(GL_SCISSOR_TEST);
+    scene->dirty_count = 0;
     se_disable_blending();
     se_framebuffer_unbind(scene->output);
 
@@ -161,17 +310,36 @@ void se_scene_2d_render_to_screen(se_scene_2d* scene, se_render_handle* render_h
 void se_scene_2d_add_object(se_scene_2d* scene, se_object_2d* object) {
     se_assertf(scene, "se_scene_2d_add_object :: scene is null");
     se_assertf(object, "se_scene_2d_add_object :: object is null");
-    se_objects_2d_ptr_add(&scene->objects, object);
+    se_object_2d_ptr* added = se_objects_2d_ptr_add(&scene->objects, object);
+    if (added) {
+        scene->drawn[se_objects_2d_ptr_get_size(&scene->objects) - 1].drawn = false;
+    }
 }
 
 void se_scene_2d_remove_object(se_scene_2d* scene, se_object_2d* object) {
     se_assertf(scene, "se_scene_2d_remove_object :: scene is null");
     se_assertf(object, "se_scene_2d_remove_object :: object is null");
-    se_objects_2d_ptr_remove(&scene->objects, &object);
+    // what it left in the output is cleared on the next render
+    se_foreach(se_objects_2d_ptr, scene->objects, i) {
+        if (*se_objects_2d_ptr_get(&scene->objects, i) != object) {
+            continue;
+        }
+        if (scene->drawn[i].drawn) {
+            se_scene_2d_mark_dirty(scene, scene->drawn[i].bounds);
+        }
+        memmove(&scene->drawn[i], &scene->drawn[i + 1], sizeof(se_object_2d_drawn) * (se_objects_2d_ptr_get_size(&scene->objects) - i - 1));
+        se_objects_2d_ptr_remove_at(&scene->objects, i);
+        return;
+    }
 }
 
 se_scene_3d* se_scene_3d_create(se_scene_handle* scene_handle, const se_vec2* size) {
     se_scene_3d* new_scene = se_scenes_3d_increment(&scene_handle->scenes_3d);
+    new_scene->size = *size;
+    new_scene->post_process_graph = NULL;
+    memset(new_scene->post_process_shaders, 0, sizeof(new_scene->post_process_shaders));
+    new_scene->color = NULL;
+    new_scene->animation_fps = 0;
     if (scene_handle->render_handle) {
         new_scene->camera = se_camera_create(scene_handle->render_handle);
     }
@@ -181,34 +349,158 @@ se_scene_3d* se_scene_3d_create(se_scene_handle* scene_handle, const se_vec2* si
     return new_scene;
 }
 
+static void se_scene_3d_invalidate_post_process(se_scene_3d* scene) {
+    if (scene->post_process_graph) {
+        se_render_graph_destroy(scene->post_process_graph);
+        scene->post_process_graph = NULL;
+    }
+    // a fused run repeats its shader for every buffer of the run
+    for (u32 i = 0; i < SE_MAX_RENDER_BUFFERS; i++) {
+        se_shader* shader = scene->post_process_shaders[i];
+        if (shader && (i == 0 || shader != scene->post_process_shaders[i - 1])) {
+            se_shader_release_fused(shader);
+        }
+    }
+    memset(scene->post_process_shaders, 0, sizeof(scene->post_process_shaders));
+}
+
 void se_scene_3d_destroy(se_scene_handle* scene_handle, se_scene_3d* scene) {
+    se_scene_3d_invalidate_post_process(scene);
     se_scenes_3d_remove(&scene_handle->scenes_3d, scene);
 }
 
-void se_scene_3d_render(se_scene_3d* scene, se_render_handle* render_handle) {
+// Pointwise buffers without history and with the same targets draw as one pass
+static b8 se_scene_3d_can_fuse(se_render_buffer* a, se_render_buffer* b) {
+    return a->shader && b->shader && !a->history && !b->history && se_render_target_desc_match(&a->desc, &b->desc) &&
+        se_glsl_is_pointwise(a->shader->fragment_path) && se_glsl_is_pointwise(b->shader->fragment_path);
+}
+
+// Each buffer's shader reads the stage before it as u_texture and the last one draws to the window. Buffers reading
+// u_prev draw to their own attachments to keep their history, the others to transient targets shared along the chain.
+// Runs of consecutive pointwise buffers are fused into one pass, placed like the first buffer of the run
+static void se_scene_3d_build_post_process(se_scene_3d* scene, se_render_handle* render_handle) {
+    se_render_graph* graph = se_render_graph_create(render_handle);
+    i32 previous = se_render_graph_import_framebuffer(graph, "scene", scene->color, NULL);
+    sz last = 0;
+    se_foreach(se_render_buffers_ptr, scene->post_process, i) {
+        if ((*se_render_buffers_ptr_get(&scene->post_process, i))->shader) {
+            last = i;
+        }
+    }
+    b8 last_has_history = false;
+    const sz count = se_render_buffers_ptr_get_size(&scene->post_process);
+    for (sz i = 0; i < count; i++) {
+        se_render_buffer* buffer = *se_render_buffers_ptr_get(&scene->post_process, i);
+        scene->post_process_shaders[i] = buffer->shader;
+        if (buffer->shader == NULL) {
+            continue;
+        }
+        se_shader* stages[SE_GLSL_MAX_FUSED_STAGES] = { buffer->shader };
+        u32 stage_count = 1;
+        while (i + stage_count < count && stage_count < SE_GLSL_MAX_FUSED_STAGES &&
+            se_scene_3d_can_fuse(buffer, *se_render_buffers_ptr_get(&scene->post_process, i + stage_count))) {
+            stages[stage_count] = (*se_render_buffers_ptr_get(&scene->post_process, i + stage_count))->shader;
+            stage_count++;
+        }
+        se_shader* shader = stage_count > 1 ? se_shader_load_fused(render_handle, stages, stage_count) : buffer->shader;
+        if (shader == NULL) {
+            // drawn one by one
+            shader = buffer->shader;
+            stage_count = 1;
+        }
+        for (u32 stage = 0; stage < stage_count; stage++) {
+            scene->post_process_shaders[i + stage] = shader;
+        }
+        const sz first = i;
+        i += stage_count - 1;
+
+        c8 name[SE_MAX_NAME_LENGTH] = {0};
+        snprintf(name, SE_MAX_NAME_LENGTH, "post_process_%zu", first);
+        i32 output = -1;
+        if (buffer->history) {
+            output = se_render_graph_import_render_buffer(graph, name, buffer);
+        } else if (i == last) {
+            output = se_render_graph_import_framebuffer(graph, "window", NULL, &scene->size);
+        } else {
+            // same formats as the buffer, a full-screen pass needs neither its depth nor a history
+            se_render_target_desc desc = buffer->desc;
+            desc.depth = SE_TARGET_DEPTH_NONE;
+            desc.history = false;
+            output = se_render_graph_add_target(graph, name, &desc);
+        }
+        const i32 pass = se_render_graph_add_pass(graph, name, shader, output);
+        se_render_graph_pass_read(graph, pass, previous, "u_texture");
+        previous = output;
+        last_has_history = buffer->history;
+    }
+    if (last_has_history) {
+        const i32 window = se_render_graph_import_framebuffer(graph, "window", NULL, &scene->size);
+        const i32 pass = se_render_graph_add_pass(graph, "present", render_handle->render_quad_shader, window);
+        se_render_graph_pass_read(graph, pass, previous, "u_texture");
+    }
+    scene->post_process_graph = graph;
+}
+
+void se_scene_3d_render(se_scene_3d* scene, se_render_handle* render_handle, se_window* window) {
     if (render_handle == NULL) {
         return;
     }
+    if (scene->animation_fps > 0) {
+        se_window_schedule_frame(window, scene->animation_fps);
+    }
+
+    const b8 post_process = se_render_buffers_ptr_get_size(&scene->post_process) > 0;
+    if (post_process) {
+        if (scene->color == NULL) {
+            scene->color = se_framebuffer_create(render_handle, &scene->size);
+        }
+        se_framebuffer_bind(scene->color);
+        se_render_clear();
+    }
 
+    // collect every visible mesh first, then submit them in as few draws as possible
+    se_draw_list_begin(render_handle, scene->camera);
     se_foreach(se_models_ptr, scene->models, i) {
         se_model_ptr* model_ptr = se_models_ptr_get(&scene->models, i);
         if (model_ptr == NULL) {
             continue;
         }
         
-        se_model_render(render_handle, *model_ptr, scene->camera);
+        se_draw_list_add_model(render_handle, *model_ptr);
     }
-    
+    se_draw_list_submit(render_handle);
+    if (!post_process) {
+        return;
+    }
+    se_framebuffer_unbind(scene->color);
+
+    if (scene->post_process_graph == NULL) {
+        se_scene_3d_build_post_process(scene, render_handle);
+    }
+    // placement uniforms the buffers' shaders expect, se_render_buffer_bind only sets them for buffers with history.
+    // Fused passes take the uniforms of every stage and the placement of the first
+    se_foreach(se_render_buffers_ptr, scene->post_process, i) {
+        se_render_buffer* buffer = *se_render_buffers_ptr_get(&scene->post_process, i);
+        se_shader* shader = scene->post_process_shaders[i];
+        if (buffer->shader && shader && shader != buffer->shader) {
+            se_uniform_copy(&shader->uniforms, &buffer->shader->uniforms);
+        }
+    }
+    se_shader* previous_shader = NULL;
     se_foreach(se_render_buffers_ptr, scene->post_process, i) {
-        se_render_buffer_ptr* buffer_ptr = se_render_buffers_ptr_get(&scene->post_process, i);
-        if (buffer_ptr == NULL) {
+        se_render_buffer* buffer = *se_render_buffers_ptr_get(&scene->post_process, i);
+        se_shader* shader = scene->post_process_shaders[i];
+        if (buffer->shader == NULL || shader == NULL) {
             continue;
         }
-        
-        se_render_buffer_bind(*buffer_ptr);
-        se_render_clear();
-        se_render_buffer_unbind(*buffer_ptr);
+        if (shader != previous_shader) {
+            se_shader_set_vec2(shader, "u_scale", &buffer->scale);
+            se_shader_set_vec2(shader, "u_position", &buffer->position);
+            se_shader_set_vec2(shader, "u_texture_size", &buffer->texture_size);
+        }
+        previous_shader = shader;
     }
+    se_render_graph_execute(scene->post_process_graph, render_handle, window);
 }
 
 void se_scene_3d_add_model(se_scene_3d* scene, se_model* model) {
@@ -216,18 +508,35 @@ void se_scene_3d_add_model(se_scene_3d* scene, se_model* model) {
 }
 
 void se_scene_3d_remove_model(se_scene_3d* scene, se_model* model) {
-    se_models_ptr_remove(&scene->models, &model);
+    // the array removes by slot address, the slot holding model has to be found first
+    se_foreach(se_models_ptr, scene->models, i) {
+        if (*se_models_ptr_get(&scene->models, i) == model) {
+            se_models_ptr_remove_at(&scene->models, i);
+            return;
+        }
+    }
 }
 
 void se_scene_3d_set_camera(se_scene_3d* scene, se_camera* camera) {
     scene->camera = camera;
 }
 
+void se_scene_3d_set_animation_rate(se_scene_3d* scene, const f32 fps) {
+    scene->animation_fps = fps;
+}
+
 void se_scene_3d_add_post_process_buffer(se_scene_3d* scene, se_render_buffer* buffer) {
     se_render_buffers_ptr_add(&scene->post_process, buffer);
+    se_scene_3d_invalidate_post_process(scene);
 }
 
 void se_scene_3d_remove_post_process_buffer(se_scene_3d* scene, se_render_buffer* buffer) {
-    se_render_buffers_ptr_remove(&scene->post_process, &buffer);
+    se_foreach(se_render_buffers_ptr, scene->post_process, i) {
+        if (*se_render_buffers_ptr_get(&scene->post_process, i) == buffer) {
+            se_render_buffers_ptr_remove_at(&scene->post_process, i);
+            se_scene_3d_invalidate_post_process(scene);
+            return;
+        }
+    }
 }
 
@@ -8,10 +8,12 @@
 #define SE_SCENE_H
 
 #include "se_render.h"
+#include "se_render_graph.h"
 #include "se_window.h"
 
 #define SE_MAX_SCENES 128
 #define SE_MAX_2D_OBJECTS 1024
+#define SE_MAX_DIRTY_RECTS 16
 #define SE_MAX_3D_OBJECTS 1024
 
 typedef struct {
@@ -31,9 +33,29 @@ SE_DEFINE_ARRAY(se_object_3d, se_objects_3d, SE_MAX_3D_OBJECTS);
 typedef se_object_3d* se_object_3d_ptr;
 SE_DEFINE_ARRAY(se_object_3d_ptr, se_objects_3d_ptr, SE_MAX_3D_OBJECTS);
 
+// Pixels of a scene output, origin bottom left, max exclusive
+typedef struct {
+    i32 min_x;
+    i32 min_y;
+    i32 max_x;
+    i32 max_y;
+} se_dirty_rect;
+
+// What a scene output holds of an object
+typedef struct {
+    u64 hash; // placement, program and shader uniforms
+    se_dirty_rect bounds;
+    b8 drawn;
+} se_object_2d_drawn;
+
+// Output keeps its contents between renders, only regions of objects that changed since are cleared and redrawn
 typedef struct {
     se_objects_2d_ptr objects;
     se_framebuffer_ptr output;
+    se_object_2d_drawn drawn[SE_MAX_2D_OBJECTS]; // same order as objects
+    se_dirty_rect dirty[SE_MAX_DIRTY_RECTS]; // pending, merged when they overlap
+    u32 dirty_count;
+    f32 animation_fps; // time based shaders, redrawn at this rate, 0 when static
 } se_scene_2d;
 SE_DEFINE_ARRAY(se_scene_2d, se_scenes_2d, SE_MAX_SCENES);
 typedef se_scene_2d* se_scene_2d_ptr;
@@ -43,6 +65,11 @@ typedef struct {
     se_models_ptr models;
     se_camera_ptr camera;
     se_render_buffers_ptr post_process;
+    se_render_graph* post_process_graph; // built from post_process on the next render after it changes
+    se_shader_ptr post_process_shaders[SE_MAX_RENDER_BUFFERS]; // pass drawing each buffer, fused pointwise runs share one
+    se_framebuffer_ptr color; // models render here when there is post processing
+    se_vec2 size;
+    f32 animation_fps; // time based shaders, frames keep coming at this rate when rendering on demand, 0 when static
     
     se_shader_ptr output_shader;
     se_render_buffer_ptr output;
@@ -78,14 +105,17 @@ extern void se_scene_2d_render(se_scene_2d* scene, se_render_handle* render_hand
 extern void se_scene_2d_render_to_screen(se_scene_2d* scene, se_render_handle* render_handle, se_window* window);
 extern void se_scene_2d_add_object(se_scene_2d* scene, se_object_2d* object);
 extern void se_scene_2d_remove_object(se_scene_2d* scene, se_object_2d* object);
+extern void se_scene_2d_set_animation_rate(se_scene_2d* scene, const f32 fps);
+extern void se_scene_2d_invalidate(se_scene_2d* scene); // redraws everything, for changes objects don't show (global uniforms, texture contents)
 
 // 3D scene functions
 extern se_scene_3d* se_scene_3d_create(se_scene_handle* scene_handle, const se_vec2* size);
 extern void se_scene_3d_destroy(se_scene_handle *scene_handle, se_scene_3d* scene);
-extern void se_scene_3d_render(se_scene_3d* scene, se_render_handle* render_handle);
+extern void se_scene_3d_render(se_scene_3d* scene, se_render_handle* render_handle, se_window* window);
 extern void se_scene_3d_add_model(se_scene_3d* scene, se_model* model);
 extern void se_scene_3d_remove_model(se_scene_3d* scene, se_model* model);
 extern void se_scene_3d_set_camera(se_scene_3d* scene, se_camera* camera);
+extern void se_scene_3d_set_animation_rate(se_scene_3d* scene, const f32 fps);
 extern void se_scene_3d_add_post_process_buffer(se_scene_3d* scene, se_render_buffer* buffer);
 extern void se_scene_3d_remove_post_process_buffer(se_scene_3d* scene, se_render_buffer* buffer);
 
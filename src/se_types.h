@@ -28,8 +28,23 @@ typedef size_t sz;
 #  error "RESOURCES_DIR not defined!"
 #endif
 
+#ifndef SE_CACHE_DIR
+#  define SE_CACHE_DIR RESOURCES_DIR ".cache/"
+#endif
+
 #define MAX_PATH_LENGTH 256
 
+// FNV-1a, used to key caches (chain calls by passing the previous hash)
+#define SE_HASH_SEED 14695981039346656037ull
+static u64 se_hash(const void* data, const sz size, u64 hash) {
+    const u8* bytes = (const u8*)data;
+    for (sz i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
 #define se_assert(expr) if (!(expr)) { fprintf(stderr, "Assertion failed: %s\n", #expr); assert(0); }
 #define se_assertf(expr, ...) if (!(expr)) { fprintf(stderr, "Assertion failed: %s\n", #expr); fprintf(stderr, __VA_ARGS__); assert(0); }
 
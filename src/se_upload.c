@@ -0,0 +1,284 @@
+// Syphax-Engine - Ougi Washi
+
+#include "se_upload.h"
+#include "se_math.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    se_upload* upload;
+    sz ring_offset;
+    sz source_offset;
+    sz size;
+} se_upload_chunk;
+
+static void se_upload_push(se_upload** head, se_upload** tail, se_upload* upload) {
+    upload->next = NULL;
+    if (*tail) {
+        (*tail)->next = upload;
+    } else {
+        *head = upload;
+    }
+    *tail = upload;
+}
+
+static void se_upload_release_data(se_upload* upload) {
+    if (upload->free_data) {
+        upload->free_data((void*)upload->data);
+        upload->free_data = NULL;
+    }
+    upload->data = NULL;
+}
+
+static se_upload* se_upload_create(se_upload_queue* queue, const se_upload_type type, const void* data, const sz size,
+                                   se_upload_free free_data, se_upload_complete complete, void* user_data) {
+    se_upload* upload = malloc(sizeof(se_upload));
+    memset(upload, 0, sizeof(se_upload));
+    upload->type = type;
+    upload->data = data;
+    upload->size = size;
+    upload->free_data = free_data;
+    upload->complete = complete;
+    upload->user_data = user_data;
+    se_upload_push(&queue->pending_head, &queue->pending_tail, upload);
+    return upload;
+}
+
+void se_upload_buffer(se_upload_queue* queue, const GLuint* buffer, const sz buffer_offset, const void* data, const sz size,
+                      se_upload_free free_data, se_upload_complete complete, void* user_data) {
+    se_upload* upload = se_upload_create(queue, SE_UPLOAD_BUFFER, data, size, free_data, complete, user_data);
+    upload->buffer = buffer;
+    upload->buffer_offset = buffer_offset;
+}
+
+void se_upload_texture(se_upload_queue* queue, const se_upload_texture_desc* desc, const void* pixels,
+                       se_upload_free free_data, se_upload_complete complete, void* user_data) {
+    u32 row_size = 0;
+    u32 row_height = 1;
+    if (desc->compressed) {
+        const u32 block_size = desc->format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || desc->format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT ? 8 : 16;
+        row_size = (u32)((desc->width + 3) / 4) * block_size;
+        row_height = 4;
+    } else {
+        row_size = (u32)desc->width * (desc->format == GL_RGBA ? 4 : desc->format == GL_RGB ? 3 : desc->format == GL_RG ? 2 : 1);
+    }
+    const u32 rows = (u32)(desc->height + row_height - 1) / row_height;
+    se_upload* upload = se_upload_create(queue, SE_UPLOAD_TEXTURE, pixels, (sz)row_size * rows, free_data, complete, user_data);
+    upload->texture = desc->texture;
+    upload->level = desc->level;
+    upload->width = desc->width;
+    upload->height = desc->height;
+    upload->format = desc->format;
+    upload->compressed = desc->compressed;
+    upload->row_size = row_size;
+    upload->row_height = row_height;
+    upload->generate_mipmaps = desc->generate_mipmaps;
+}
+
+static void se_upload_texture_rows(const se_upload* upload, const sz source_offset, const sz size, const void* data) {
+    const i32 first_row = (i32)(source_offset / upload->row_size) * upload->row_height;
+    const i32 rows = (i32)(size / upload->row_size) * upload->row_height;
+    const i32 height = min(rows, upload->height - first_row);
+    if (se_gl_caps.direct_state_access) {
+        if (upload->compressed) {
+            glCompressedTextureSubImage2D(upload->texture, upload->level, 0, first_row, upload->width, height, upload->format, (GLsizei)size, data);
+        } else {
+            glTextureSubImage2D(upload->texture, upload->level, 0, first_row, upload->width, height, upload->format, GL_UNSIGNED_BYTE, data);
+        }
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, upload->texture);
+    if (upload->compressed) {
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, upload->level, 0, first_row, upload->width, height, upload->format, (GLsizei)size, data);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, upload->level, 0, first_row, upload->width, height, upload->format, GL_UNSIGNED_BYTE, data);
+    }
+}
+
+static b8 se_upload_frame_done(se_upload_queue* queue, const u64 frame) {
+    // a reused segment was waited on before reuse
+    if (frame + SE_UPLOAD_RING_FRAMES < queue->frame) {
+        return true;
+    }
+    GLsync fence = queue->fences[frame % SE_UPLOAD_RING_FRAMES];
+    if (fence == NULL) {
+        return true;
+    }
+    const GLenum result = glClientWaitSync(fence, 0, 0);
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+static void se_upload_wait_fence(se_upload_queue* queue, const u32 segment) {
+    if (queue->fences[segment]) {
+        glClientWaitSync(queue->fences[segment], GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
+        glDeleteSync(queue->fences[segment]);
+        queue->fences[segment] = NULL;
+    }
+}
+
+static void se_upload_retire(se_upload_queue* queue) {
+    while (queue->issued_head && se_upload_frame_done(queue, queue->issued_head->frame)) {
+        se_upload* upload = queue->issued_head;
+        queue->issued_head = upload->next;
+        if (queue->issued_head == NULL) {
+            queue->issued_tail = NULL;
+        }
+        if (upload->complete) {
+            upload->complete(upload->user_data, false);
+        }
+        free(upload);
+    }
+}
+
+static void se_upload_destroy_ring(se_upload_queue* queue) {
+    for (u32 i = 0; i < SE_UPLOAD_RING_FRAMES; i++) {
+        se_upload_wait_fence(queue, i);
+    }
+    if (queue->ring) {
+        glDeleteBuffers(1, &queue->ring);
+        queue->ring = 0;
+    }
+}
+
+void se_upload_queue_set_budget(se_upload_queue* queue, const u32 bytes_per_frame) {
+    queue->budget = bytes_per_frame;
+}
+
+static void se_upload_generate_mipmaps(const se_upload* upload) {
+    if (se_gl_caps.direct_state_access) {
+        glGenerateTextureMipmap(upload->texture);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, upload->texture);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+}
+
+// Texture rows wider than the whole budget can't be staged, they go straight from client memory
+static void se_upload_texture_rows_direct(se_upload* upload) {
+    se_upload_texture_rows(upload, upload->offset, upload->row_size, upload->data + upload->offset);
+    upload->offset += upload->row_size;
+    if (upload->generate_mipmaps && upload->offset >= upload->size) {
+        se_upload_generate_mipmaps(upload);
+    }
+}
+
+void se_upload_queue_process(se_upload_queue* queue) {
+    if (queue->budget == 0) {
+        queue->budget = SE_UPLOAD_FRAME_BUDGET;
+    }
+    se_upload_retire(queue);
+    if (queue->pending_head == NULL) {
+        return;
+    }
+
+    if (queue->ring && queue->ring_budget != queue->budget) {
+        se_upload_destroy_ring(queue);
+    }
+    if (queue->ring == 0) {
+        glGenBuffers(1, &queue->ring);
+        glBindBuffer(GL_COPY_READ_BUFFER, queue->ring);
+        glBufferData(GL_COPY_READ_BUFFER, (GLsizeiptr)queue->budget * SE_UPLOAD_RING_FRAMES, NULL, GL_STREAM_DRAW);
+        queue->ring_budget = queue->budget;
+    }
+
+    // the segment was last used SE_UPLOAD_RING_FRAMES frames ago, its fence has normally signaled already
+    const u32 segment = queue->frame % SE_UPLOAD_RING_FRAMES;
+    se_upload_wait_fence(queue, segment);
+    const sz segment_offset = (sz)segment * queue->budget;
+    glBindBuffer(GL_COPY_READ_BUFFER, queue->ring);
+    u8* staging = glMapBufferRange(GL_COPY_READ_BUFFER, segment_offset, queue->budget,
+                                   GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (staging == NULL) {
+        fprintf(stderr, "se_upload_queue_process :: failed to map the staging ring\n");
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        return;
+    }
+
+    // stage
+    se_upload_chunk chunks[SE_UPLOAD_MAX_CHUNKS];
+    u32 chunk_count = 0;
+    sz used = 0;
+    while (queue->pending_head && chunk_count < SE_UPLOAD_MAX_CHUNKS) {
+        se_upload* upload = queue->pending_head;
+        used = (used + 15) & ~(sz)15;
+        const sz available = used < queue->budget ? queue->budget - used : 0;
+        sz size = upload->size - upload->offset < available ? upload->size - upload->offset : available;
+        if (upload->type == SE_UPLOAD_TEXTURE) {
+            size -= size % upload->row_size; // whole rows only
+            if (size == 0 && used == 0) {
+                se_upload_texture_rows_direct(upload);
+            }
+        }
+        if (size > 0) {
+            memcpy(staging + used, upload->data + upload->offset, size);
+            chunks[chunk_count++] = (se_upload_chunk){ upload, segment_offset + used, upload->offset, size };
+            upload->offset += size;
+            used += size;
+        }
+        if (upload->offset < upload->size) {
+            if (size == 0) {
+                break; // out of budget
+            }
+            continue;
+        }
+        queue->pending_head = upload->next;
+        if (queue->pending_head == NULL) {
+            queue->pending_tail = NULL;
+        }
+        se_upload_release_data(upload);
+        upload->frame = queue->frame;
+        se_upload_push(&queue->issued_head, &queue->issued_tail, upload);
+    }
+    glUnmapBuffer(GL_COPY_READ_BUFFER);
+
+    // issue the copies out of the ring
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, queue->ring);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (u32 i = 0; i < chunk_count; i++) {
+        const se_upload_chunk* chunk = &chunks[i];
+        se_upload* upload = chunk->upload;
+        if (upload->type == SE_UPLOAD_BUFFER && se_gl_caps.direct_state_access) {
+            glCopyNamedBufferSubData(queue->ring, *upload->buffer, chunk->ring_offset, upload->buffer_offset + chunk->source_offset, chunk->size);
+        } else if (upload->type == SE_UPLOAD_BUFFER) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, *upload->buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, chunk->ring_offset, upload->buffer_offset + chunk->source_offset, chunk->size);
+        } else {
+            se_upload_texture_rows(upload, chunk->source_offset, chunk->size, (const void*)chunk->ring_offset);
+            if (upload->generate_mipmaps && chunk->source_offset + chunk->size == upload->size) {
+                se_upload_generate_mipmaps(upload);
+            }
+        }
+        queue->bytes_uploaded += chunk->size;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    queue->fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    queue->frame++;
+}
+
+b8 se_upload_queue_is_idle(const se_upload_queue* queue) {
+    return queue->pending_head == NULL && queue->issued_head == NULL;
+}
+
+void se_upload_queue_cleanup(se_upload_queue* queue) {
+    // waits for every fence, so issued uploads are complete
+    se_upload_destroy_ring(queue);
+    se_upload* lists[2] = { queue->issued_head, queue->pending_head };
+    for (u32 i = 0; i < 2; i++) {
+        se_upload* upload = lists[i];
+        while (upload) {
+            se_upload* next = upload->next;
+            se_upload_release_data(upload);
+            if (upload->complete) {
+                upload->complete(upload->user_data, i == 1);
+            }
+            free(upload);
+            upload = next;
+        }
+    }
+    memset(queue, 0, sizeof(se_upload_queue));
+}
@@ -0,0 +1,81 @@
+// Syphax-Engine - Ougi Washi
+
+// Upload scheduler. Buffer and texture uploads are queued and copied through a staging ring,
+// at most budget bytes per frame, so streaming doesn't spike the frame it lands in.
+// Uploads complete once the fence of the frame that issued their last chunk has signaled.
+
+#ifndef SE_UPLOAD_H
+#define SE_UPLOAD_H
+
+#include "se_types.h"
+#include "se_gl.h"
+
+#define SE_UPLOAD_FRAME_BUDGET (2 * 1024 * 1024) // staging bytes per frame
+#define SE_UPLOAD_RING_FRAMES 3 // frames in flight, the ring holds one budget per frame
+#define SE_UPLOAD_MAX_CHUNKS 64 // copies issued per frame
+
+typedef void (*se_upload_complete)(void* user_data, const b8 cancelled);
+typedef void (*se_upload_free)(void* data);
+
+typedef enum {
+    SE_UPLOAD_BUFFER,
+    SE_UPLOAD_TEXTURE
+} se_upload_type;
+
+typedef struct se_upload {
+    se_upload_type type;
+    const u8* data;
+    sz size;
+    sz offset; // bytes staged so far
+    se_upload_free free_data; // called once everything is staged, NULL if the data isn't owned
+    const GLuint* buffer; // read at every chunk, the destination buffer may be reallocated meanwhile
+    sz buffer_offset;
+    GLuint texture; // split in rows (rows of 4x4 blocks when compressed)
+    i32 level;
+    i32 width;
+    i32 height;
+    GLenum format;
+    b8 compressed;
+    u32 row_size;
+    u32 row_height;
+    b8 generate_mipmaps;
+    se_upload_complete complete;
+    void* user_data;
+    u64 frame; // frame that issued the last chunk
+    struct se_upload* next;
+} se_upload;
+
+typedef struct {
+    GLuint texture;
+    i32 level;
+    i32 width;
+    i32 height;
+    GLenum format; // GL_RGB/GL_RGBA, or the internal format when compressed
+    b8 compressed; // BC1/BC3, 8/16 bytes per 4x4 block
+    b8 generate_mipmaps; // after this level has landed
+} se_upload_texture_desc;
+
+typedef struct {
+    GLuint ring;
+    u32 budget;
+    u32 ring_budget; // budget the ring was created with
+    GLsync fences[SE_UPLOAD_RING_FRAMES];
+    u64 frame;
+    se_upload* pending_head;
+    se_upload* pending_tail;
+    se_upload* issued_head;
+    se_upload* issued_tail;
+    u64 bytes_uploaded;
+} se_upload_queue;
+
+extern void se_upload_buffer(se_upload_queue* queue, const GLuint* buffer, const sz buffer_offset, const void* data, const sz size,
+                             se_upload_free free_data, se_upload_complete complete, void* user_data);
+// the level storage has to exist already (glTexImage2D/glCompressedTexImage2D with NULL data)
+extern void se_upload_texture(se_upload_queue* queue, const se_upload_texture_desc* desc, const void* pixels,
+                              se_upload_free free_data, se_upload_complete complete, void* user_data);
+extern void se_upload_queue_set_budget(se_upload_queue* queue, const u32 bytes_per_frame);
+extern void se_upload_queue_process(se_upload_queue* queue); // once per frame on the context thread
+extern b8 se_upload_queue_is_idle(const se_upload_queue* queue);
+extern void se_upload_queue_cleanup(se_upload_queue* queue); // cancels everything still queued
+
+#endif // SE_UPLOAD_H
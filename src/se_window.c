@@ -8,8 +8,15 @@
 
 static se_windows windows_container = { 0 };
 
+// Callbacks run inside glfwPollEvents/glfwWaitEvents, which return by themselves, so no empty event is posted
+static void se_window_mark_redraw(se_window* window) {
+    __atomic_store_n(&window->redraw_requested, true, __ATOMIC_RELEASE);
+}
+
+// every input asks for a frame, the application may react to it
 static void key_callback(GLFWwindow* glfw_handle, i32 key, i32 scancode, i32 action, i32 mods) {
     se_window* window = (se_window*)glfwGetWindowUserPointer(glfw_handle);
+    se_window_mark_redraw(window);
     if (key >= 0 && key < 1024) {
         if (action == GLFW_PRESS) {
             window->keys[key] = true;
@@ -21,6 +28,7 @@ static void key_callback(GLFWwindow* glfw_handle, i32 key, i32 scancode, i32 act
 
 static void mouse_callback(GLFWwindow* glfw_handle, double xpos, double ypos) {
     se_window* window = (se_window*)glfwGetWindowUserPointer(glfw_handle);
+    se_window_mark_redraw(window);
     window->mouse_dx = xpos - window->mouse_x;
     window->mouse_dy = ypos - window->mouse_y;
     window->mouse_x = xpos;
@@ -29,6 +37,7 @@ static void mouse_callback(GLFWwindow* glfw_handle, double xpos, double ypos) {
 
 static void mouse_button_callback(GLFWwindow* glfw_handle, i32 button, i32 action, i32 mods) {
     se_window* window = (se_window*)glfwGetWindowUserPointer(glfw_handle);
+    se_window_mark_redraw(window);
     if (button >= 0 && button < 8) {
         if (action == GLFW_PRESS) {
             window->mouse_buttons[button] = true;
@@ -43,6 +52,12 @@ static void framebuffer_size_callback(GLFWwindow* glfw_handle, i32 width, i32 he
     window->width = width;
     window->height = height;
     glViewport(0, 0, width, height);
+    se_window_mark_redraw(window);
+}
+
+// exposed again after being covered or restored
+static void refresh_callback(GLFWwindow* glfw_handle) {
+    se_window_mark_redraw((se_window*)glfwGetWindowUserPointer(glfw_handle));
 }
 
 // TODO: move to opengl.c or such later on
@@ -101,15 +116,22 @@ se_window* se_window_create(const char* title, const u32 width, const u32 height
         printf("Failed to create window\n");
         return NULL;
     }
-    // Set OpenGL version
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    // Ask for the newest core context first, newer paths are picked at runtime and 3.3 stays the baseline
+    static const i32 gl_versions[][2] = { { 4, 6 }, { 4, 5 }, { 4, 4 }, { 4, 3 }, { 4, 1 }, { 3, 3 } };
+    const sz gl_version_count = sizeof(gl_versions) / sizeof(gl_versions[0]);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
-   
-    new_window->handle = glfwCreateWindow(width, height, title, NULL, NULL);
+    new_window->handle = NULL;
+    for (sz i = 0; i < gl_version_count && new_window->handle == NULL; i++) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, gl_versions[i][0]);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, gl_versions[i][1]);
+        // unsupported versions are expected to fail, only report the last attempt
+        glfwSetErrorCallback(i + 1 < gl_version_count ? NULL : gl_error_callback);
+        new_window->handle = glfwCreateWindow(width, height, title, NULL, NULL);
+    }
+    glfwSetErrorCallback(gl_error_callback);
     se_assertf(new_window->handle, "Failed to create GLFW window");
     
     // TODO: figure out why this is causing errors (GLFW Error 65538: Cannot set swap interval without a current OpenGL or OpenGL ES context)
@@ -126,8 +148,14 @@ se_window* se_window_create(const char* title, const u32 width, const u32 height
     glfwSetCursorPosCallback(new_window->handle, mouse_callback);
     glfwSetMouseButtonCallback(new_window->handle, mouse_button_callback);
     glfwSetFramebufferSizeCallback(new_window->handle, framebuffer_size_callback);
+    glfwSetWindowRefreshCallback(new_window->handle, refresh_callback);
     
-    se_init_opengl();
+    if (!se_init_opengl()) {
+        fprintf(stderr, "se_window_create :: OpenGL 3.3 core is required\n");
+        glfwDestroyWindow(new_window->handle);
+        se_windows_remove(&windows_container, new_window);
+        return NULL;
+    }
     
     glEnable(GL_DEPTH_TEST);
     
@@ -138,6 +166,9 @@ se_window* se_window_create(const char* title, const u32 width, const u32 height
     new_window->time.delta = 0;
     new_window->frame_count = 0;
     new_window->target_fps = 60;
+    new_window->render_on_demand = false;
+    new_window->redraw_requested = true;
+    new_window->next_frame_time = 0;
     printf("Created window %p\n", new_window);
     return new_window;
 }
@@ -156,7 +187,8 @@ void se_window_render_quad(se_window* window) {
 }
 
 void se_window_render_screen(se_window* window) {
-    f64 time_left = 1. / window->target_fps - window->time.delta;
+    // on demand the frames are paced by se_window_wait_events
+    f64 time_left = window->render_on_demand ? 0 : 1. / window->target_fps - window->time.delta;
     if (time_left > 0) {
         usleep(time_left * 1000000);
     }
@@ -200,6 +232,59 @@ void se_window_set_target_fps(se_window* window, const u16 fps) {
     window->target_fps = fps;
 }
 
+void se_window_set_render_on_demand(se_window* window, const b8 enabled) {
+    window->render_on_demand = enabled;
+    window->next_frame_time = 0;
+    se_window_mark_redraw(window);
+}
+
+// Blocks in glfwWaitEvents until input, an empty event posted by se_window_request_redraw or the next scheduled frame
+void se_window_wait_events(se_window* window) {
+    if (!window->render_on_demand || __atomic_load_n(&window->redraw_requested, __ATOMIC_ACQUIRE)) {
+        glfwPollEvents();
+        return;
+    }
+    if (window->next_frame_time > 0) {
+        const f64 timeout = window->next_frame_time - glfwGetTime();
+        if (timeout > 0) {
+            glfwWaitEventsTimeout(timeout);
+        } else {
+            glfwPollEvents();
+        }
+        return;
+    }
+    glfwWaitEvents();
+}
+
+b8 se_window_should_render(se_window* window) {
+    if (!window->render_on_demand) {
+        return true;
+    }
+    const b8 requested = __atomic_exchange_n(&window->redraw_requested, false, __ATOMIC_ACQ_REL);
+    const b8 scheduled = window->next_frame_time > 0 && glfwGetTime() >= window->next_frame_time;
+    if (!requested && !scheduled) {
+        return false;
+    }
+    // animated content schedules the next one while drawing this frame
+    window->next_frame_time = 0;
+    return true;
+}
+
+void se_window_request_redraw(se_window* window) {
+    __atomic_store_n(&window->redraw_requested, true, __ATOMIC_RELEASE);
+    glfwPostEmptyEvent();
+}
+
+void se_window_schedule_frame(se_window* window, const f32 fps) {
+    if (fps <= 0) {
+        return;
+    }
+    const f64 frame_time = glfwGetTime() + 1.0 / fps;
+    if (window->next_frame_time == 0 || frame_time < window->next_frame_time) {
+        window->next_frame_time = frame_time;
+    }
+}
+
 
 void se_window_destroy(se_window* window) {
     se_assertf(window, "se_window_destroy :: window is null");
@@ -33,6 +33,11 @@ typedef struct {
     u16 target_fps;
     se_time time;
     u64 frame_count;
+
+    // render on demand: frames only run for input, a redraw request or a scheduled animation frame
+    b8 render_on_demand;
+    b8 redraw_requested; // accessed atomically, any thread can request one
+    f64 next_frame_time; // scheduled animation frame, 0 for none
 } se_window;
 
 SE_DEFINE_ARRAY(se_window, se_windows, SE_MAX_WINDOWS);
@@ -49,6 +54,11 @@ extern void se_window_check_exit_keys(se_window* window, key_combo* keys);
 extern f64 se_window_get_delta_time(se_window* window);
 extern f64 se_window_get_time(se_window* window);
 extern void se_window_set_target_fps(se_window* window, const u16 fps);
+extern void se_window_set_render_on_demand(se_window* window, const b8 enabled);
+extern void se_window_wait_events(se_window* window); // polls, or sleeps until a frame is due when rendering on demand
+extern b8 se_window_should_render(se_window* window); // always true unless rendering on demand, takes the pending request
+extern void se_window_request_redraw(se_window* window); // thread safe, wakes se_window_wait_events
+extern void se_window_schedule_frame(se_window* window, const f32 fps); // another frame after 1 / fps, for animated content
 extern void se_window_destroy(se_window* window);
 extern void se_window_destroy_all();
 
@@ -0,0 +1,133 @@
+// Syphax-Engine - Ougi Washi
+
+#include "se_worker.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static f64 se_worker_time() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static void se_job_list_push(se_job** head, se_job** tail, se_job* job) {
+    job->next = NULL;
+    if (*tail) {
+        (*tail)->next = job;
+    } else {
+        *head = job;
+    }
+    *tail = job;
+}
+
+static se_job* se_job_list_pop(se_job** head, se_job** tail) {
+    se_job* job = *head;
+    if (job) {
+        *head = job->next;
+        if (*head == NULL) {
+            *tail = NULL;
+        }
+    }
+    return job;
+}
+
+static void* se_worker_main(void* data) {
+    se_worker_pool* pool = data;
+    pthread_mutex_lock(&pool->mutex);
+    while (true) {
+        while (!pool->stop && pool->pending_head == NULL) {
+            pthread_cond_wait(&pool->has_jobs, &pool->mutex);
+        }
+        if (pool->stop) {
+            break;
+        }
+        se_job* job = se_job_list_pop(&pool->pending_head, &pool->pending_tail);
+        pool->running++;
+        pthread_mutex_unlock(&pool->mutex);
+
+        job->run(job);
+
+        pthread_mutex_lock(&pool->mutex);
+        pool->running--;
+        se_job_list_push(&pool->done_head, &pool->done_tail, job);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+se_worker_pool* se_worker_pool_create(const u32 thread_count) {
+    se_worker_pool* pool = malloc(sizeof(se_worker_pool));
+    memset(pool, 0, sizeof(se_worker_pool));
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->has_jobs, NULL);
+
+    u32 count = thread_count;
+    if (count == 0) {
+        const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        count = cores > 1 ? (u32)cores - 1 : 1;
+    }
+    count = count < SE_MAX_WORKERS ? count : SE_MAX_WORKERS;
+    for (u32 i = 0; i < count; i++) {
+        if (pthread_create(&pool->threads[pool->thread_count], NULL, se_worker_main, pool) != 0) {
+            fprintf(stderr, "se_worker_pool_create :: failed to start worker %u\n", i);
+            break;
+        }
+        pool->thread_count++;
+    }
+    se_assertf(pool->thread_count > 0, "se_worker_pool_create :: no worker could be started\n");
+    printf("Worker pool - started %u workers\n", pool->thread_count);
+    return pool;
+}
+
+void se_worker_pool_destroy(se_worker_pool* pool) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->has_jobs);
+    pthread_mutex_unlock(&pool->mutex);
+    for (u32 i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    se_job* job = NULL;
+    while ((job = se_job_list_pop(&pool->pending_head, &pool->pending_tail))) {
+        job->finish(job, true);
+    }
+    while ((job = se_job_list_pop(&pool->done_head, &pool->done_tail))) {
+        job->finish(job, true);
+    }
+    pthread_cond_destroy(&pool->has_jobs);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool);
+}
+
+void se_worker_pool_submit(se_worker_pool* pool, se_job* job) {
+    pthread_mutex_lock(&pool->mutex);
+    se_job_list_push(&pool->pending_head, &pool->pending_tail, job);
+    pthread_cond_signal(&pool->has_jobs);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+u32 se_worker_pool_finish(se_worker_pool* pool, const f64 budget_seconds) {
+    const f64 start = se_worker_time();
+    u32 finished = 0;
+    do {
+        pthread_mutex_lock(&pool->mutex);
+        se_job* job = se_job_list_pop(&pool->done_head, &pool->done_tail);
+        pthread_mutex_unlock(&pool->mutex);
+        if (job == NULL) {
+            break;
+        }
+        job->finish(job, false);
+        finished++;
+    } while (se_worker_time() - start < budget_seconds);
+    return finished;
+}
+
+b8 se_worker_pool_is_idle(se_worker_pool* pool) {
+    pthread_mutex_lock(&pool->mutex);
+    const b8 idle = pool->pending_head == NULL && pool->done_head == NULL && pool->running == 0;
+    pthread_mutex_unlock(&pool->mutex);
+    return idle;
+}
@@ -0,0 +1,44 @@
+// Syphax-Engine - Ougi Washi
+
+// Worker pool for background jobs. run() is called on a worker thread, finish() later on the thread
+// that calls se_worker_pool_finish (the GL context thread), within a time budget.
+
+#ifndef SE_WORKER_H
+#define SE_WORKER_H
+
+#include "se_types.h"
+#include <pthread.h>
+
+#define SE_MAX_WORKERS 8
+
+typedef struct se_job se_job;
+typedef void (*se_job_run)(se_job* job);
+typedef void (*se_job_finish)(se_job* job, const b8 cancelled); // owns the job, frees it
+
+// embed as the first member of the job data
+struct se_job {
+    se_job_run run;
+    se_job_finish finish;
+    se_job* next;
+};
+
+typedef struct {
+    pthread_t threads[SE_MAX_WORKERS];
+    u32 thread_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t has_jobs;
+    se_job* pending_head;
+    se_job* pending_tail;
+    se_job* done_head;
+    se_job* done_tail;
+    u32 running;
+    b8 stop;
+} se_worker_pool;
+
+extern se_worker_pool* se_worker_pool_create(const u32 thread_count); // 0 = one per core minus the main thread
+extern void se_worker_pool_destroy(se_worker_pool* pool); // cancels queued jobs, waits for running ones
+extern void se_worker_pool_submit(se_worker_pool* pool, se_job* job);
+extern u32 se_worker_pool_finish(se_worker_pool* pool, const f64 budget_seconds); // always finishes at least one job if any is done
+extern b8 se_worker_pool_is_idle(se_worker_pool* pool);
+
+#endif // SE_WORKER_H